@@ -0,0 +1,110 @@
+// Бенчмарк поиска через базу данных: пул потоков с блокирующим Database::search (как до сопрограмм)
+// против сопрограмм на io_context с неблокирующим AsyncDatabase::search
+//
+// В обоих случаях одновременно выполняется одинаковое число запросов. Выводятся запросы в секунду
+// и запросы на секунду процессорного времени процесса (пропускная способность на ядро).
+//
+// Использование: async_search_bench <config.ini> [запросов=5000] [одновременно=64] [потоков io_context=2]
+// Нужна база с проиндексированными страницами; пул потоков занимает по потоку на одновременный запрос,
+// размер пула соединений задаёт database.pool_size, число неблокирующих соединений — database.async_connections.
+
+#include "async_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+#include "logger.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <pqxx/pqxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    struct Measure {
+        std::chrono::steady_clock::time_point wall = std::chrono::steady_clock::now();
+        std::clock_t cpu = std::clock(); // Процессорное время всех потоков процесса
+
+        void report(const char* name, size_t queries) const {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall).count();
+            double cpuSeconds = static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC;
+            std::cout << name << ": " << queries / seconds << " queries/s, "
+                << (cpuSeconds > 0 ? queries / cpuSeconds : 0.0) << " queries per CPU-second\n";
+        }
+    };
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config.ini> [queries=5000] [concurrency=64] [io_threads=2]\n";
+        return 1;
+    }
+    size_t queries = argc > 2 ? std::stoul(argv[2]) : 5000;
+    size_t concurrency = std::max<size_t>(1, argc > 3 ? std::stoul(argv[3]) : 64);
+    int ioThreads = std::max(1, argc > 4 ? std::stoi(argv[4]) : 2);
+
+    Config config(argv[1]);
+    Logger logger(config);
+    Database db(config, logger);
+    db.init();
+
+    // Запросы из двух частых слов
+    std::vector<std::string> vocabulary;
+    {
+        pqxx::connection connection(config.getDbConnectionString());
+        pqxx::work txn(connection);
+        for (const auto& row : txn.exec("SELECT word FROM words ORDER BY doc_freq DESC LIMIT 200")) {
+            vocabulary.push_back(row[0].as<std::string>());
+        }
+    }
+    if (vocabulary.empty()) {
+        std::cerr << "The words table is empty: index some pages first\n";
+        return 1;
+    }
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+    std::vector<std::vector<std::string>> workload(queries);
+    for (auto& terms : workload) terms = { vocabulary[pick(rng)], vocabulary[pick(rng)] };
+
+    {
+        std::atomic<size_t> next{ 0 };
+        Measure measure;
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < concurrency; ++i) {
+            threads.emplace_back([&]() {
+                for (size_t q = next++; q < queries; q = next++) db.search(workload[q]);
+                });
+        }
+        for (auto& thread : threads) thread.join();
+        measure.report(("thread pool, " + std::to_string(concurrency) + " threads").c_str(), queries);
+    }
+
+    {
+        boost::asio::io_context ioc{ ioThreads };
+        AsyncDatabase asyncDb(ioc.get_executor(), config, logger);
+        std::atomic<size_t> next{ 0 };
+        for (size_t i = 0; i < concurrency; ++i) {
+            boost::asio::co_spawn(ioc, [&]() -> boost::asio::awaitable<void> {
+                for (size_t q = next++; q < queries; q = next++) co_await asyncDb.search(workload[q]);
+                }, boost::asio::detached);
+        }
+        Measure measure;
+        std::vector<std::thread> threads;
+        for (int i = 1; i < ioThreads; ++i) threads.emplace_back([&ioc]() { ioc.run(); });
+        ioc.run();
+        for (auto& thread : threads) thread.join();
+        measure.report(("coroutines, " + std::to_string(ioThreads) + " io threads").c_str(), queries);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Бенчмарк журнала состояния обхода: цена записи для потоков краулера, размер журнала и время продолжения
+// обхода (воспроизведение и сжатие журнала, восстановление очередей хостов и множества посещённых URL)
+//
+// Журнал пишется в файл crawler.state_file из конфигурации; если файл уже существует, бенчмарк не запускается.
+//
+// Использование: crawl_log_bench <config> [URL=10000000] [обработано %=0]
+
+#include "config.hpp"
+#include "crawl_log.hpp"
+#include "frontier.hpp"
+#include "logger.hpp"
+#include "seen_set.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    constexpr size_t kWriters = 4; // Потоки, добавляющие URL, как потоки обработки страниц краулера
+
+    std::string makeUrl(size_t i) {
+        return "https://www.site" + std::to_string(i % 5000) + ".example.com/articles/" + std::to_string(i) +
+            "/some-slug-text-" + std::to_string(i * 7 % 1000);
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: crawl_log_bench <config> [urls] [done percent]\n";
+        return 1;
+    }
+    Config config(argv[1]);
+    Logger logger(config);
+    size_t count = argc > 2 ? std::stoul(argv[2]) : 10000000;
+    size_t donePercent = argc > 3 ? std::stoul(argv[3]) : 0;
+
+    std::string path = config.getStateFile();
+    if (path.empty() || std::filesystem::exists(path)) {
+        std::cerr << "crawler.state_file must name a file that does not exist yet\n";
+        return 1;
+    }
+
+    // Журнал прерванного обхода: URL добавлены в очередь, часть из них обработана
+    {
+        CrawlLog log(path, std::chrono::milliseconds(config.getCheckpointIntervalMs()), logger);
+        log.open([](uint64_t) {}, [](std::string, int) {});
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> writers;
+        for (size_t writer = 0; writer < kWriters; ++writer) {
+            writers.emplace_back([&, writer]() {
+                for (size_t i = writer; i < count; i += kWriters) {
+                    std::string url = makeUrl(i);
+                    uint64_t fingerprint = SeenSet::fingerprint(url);
+                    log.added(url, 2, fingerprint);
+                    if (i % 100 < donePercent) log.done(fingerprint);
+                }
+                });
+        }
+        for (auto& thread : writers) thread.join();
+        double addSeconds = seconds(start);
+        log.close(false);
+        double closeSeconds = seconds(start);
+
+        std::cout << "Journal: " << count << " URLs (" << donePercent << "% done) from " << kWriters
+            << " threads in " << addSeconds << " s (" << addSeconds * 1e9 / count << " ns/URL), all on disk after "
+            << closeSeconds << " s, " << std::filesystem::file_size(path) / (1 << 20) << " MB\n";
+    }
+
+    // Продолжение обхода: журнал воспроизводится и сжимается, очереди хостов и множество посещённых заполняются
+    {
+        std::atomic<bool> running(true);
+        Frontier frontier(config, logger, running);
+        auto start = std::chrono::steady_clock::now();
+        size_t resumed = frontier.resume();
+        double resumeSeconds = seconds(start);
+        auto stats = frontier.stats();
+        std::cout << "Resume: " << resumed << " queued URLs in " << resumeSeconds << " s, hosts " << stats.hosts
+            << ", visited " << stats.visited << ", compacted journal "
+            << std::filesystem::file_size(path) / (1 << 20) << " MB\n";
+        frontier.finish();
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
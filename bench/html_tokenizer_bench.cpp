@@ -0,0 +1,91 @@
+// Бенчмарк разбора HTML: прежние регулярные выражения (удаление тегов и знаков двумя regex_replace
+// и поиск ссылок regex_search) против однопроходного HtmlTokenizer, мегабайт страниц в секунду
+//
+// Страницы читаются из каталога с сохранёнными страницами (все файлы каталога).
+//
+// Использование: html_tokenizer_bench <каталог> [проходов=3]
+
+#include "html_tokenizer.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Прежний разбор: регулярные выражения компилируются при каждом вызове, как в cleanHtml и extractLinks
+    size_t regexScan(const std::string& html, size_t& links) {
+        std::string text = std::regex_replace(html, std::regex("<[^>]*>"), " ");
+        text = std::regex_replace(text, std::regex(R"([\n\r\t.,!?:;"'(){}[\]\\/@#$%^&*+=<>`~|])"), " ");
+        std::istringstream words(text);
+        std::string word;
+        size_t count = 0;
+        while (words >> word) ++count;
+
+        std::regex hrefRegex(R"(<a\s+(?:[^>]*?\s+)?href=["'](.*?)["'])", std::regex::icase);
+        std::smatch match;
+        for (auto start = html.cbegin(); std::regex_search(start, html.cend(), match, hrefRegex);
+            start = match.suffix().first) {
+            ++links;
+        }
+        return count;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: html_tokenizer_bench <directory> [passes]\n";
+        return 1;
+    }
+    int passes = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    std::vector<std::string> pages;
+    size_t bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(argv[1])) {
+        if (!entry.is_regular_file()) continue;
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::ostringstream content;
+        content << in.rdbuf();
+        pages.push_back(content.str());
+        bytes += pages.back().size();
+    }
+    if (pages.empty()) {
+        std::cerr << "No pages in " << argv[1] << "\n";
+        return 1;
+    }
+    double megabytes = static_cast<double>(bytes) * passes / 1e6;
+
+    size_t regexWords = 0, regexLinks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const auto& page : pages) regexWords += regexScan(page, regexLinks);
+    }
+    double regexSeconds = seconds(start);
+
+    HtmlTokenizer tokenizer;
+    size_t words = 0, links = 0;
+    HtmlTokenizer::Callback onText = [&](std::string_view) { ++words; };
+    HtmlTokenizer::Callback onLink = [&](std::string_view) { ++links; };
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const auto& page : pages) tokenizer.scan(page, onText, onLink);
+    }
+    double tokenizerSeconds = seconds(start);
+
+    std::cout << "Pages: " << pages.size() << ", " << bytes / 1024 << " KB\n";
+    std::cout << "Regex: " << megabytes / regexSeconds << " MB/s (" << regexWords / passes << " words, "
+        << regexLinks / passes << " links)\n";
+    std::cout << "HtmlTokenizer: " << megabytes / tokenizerSeconds << " MB/s (" << words / passes << " words, "
+        << links / passes << " links)\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Нагрузочный тест поискового сервера: много одновременных соединений, каждое отправляет запросы подряд
+//
+// По умолчанию соединения держатся открытыми (keep-alive), с --close каждый запрос идёт по новому соединению,
+// как при прежней модели сервера с keep_alive(false). Выводятся запросы в секунду, ошибки и перцентили задержки.
+// Для тысяч соединений поднимите лимит открытых файлов (ulimit -n) и на клиенте, и на сервере.
+//
+// Использование: http_load_bench <хост> <порт> [соединений=1000] [секунд=10] [путь=/] [--close]
+
+#include "latency_histogram.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using boost::asio::ip::tcp;
+using boost::asio::use_awaitable;
+
+namespace {
+
+    struct Load {
+        tcp::resolver::results_type endpoints;
+        std::string host;
+        std::string target;
+        bool keepAlive = true;
+        std::chrono::steady_clock::time_point deadline;
+        LatencyHistogram latency;
+        std::atomic<uint64_t> errors{ 0 };
+    };
+
+    // Одно соединение клиента: запросы подряд до истечения времени теста
+    boost::asio::awaitable<void> client(Load& load) {
+        beast::flat_buffer buffer;
+        std::unique_ptr<beast::tcp_stream> stream;
+        while (std::chrono::steady_clock::now() < load.deadline) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                if (!stream) {
+                    stream = std::make_unique<beast::tcp_stream>(co_await boost::asio::this_coro::executor);
+                    stream->expires_after(std::chrono::seconds(30));
+                    co_await stream->async_connect(load.endpoints, use_awaitable);
+                    buffer.clear();
+                }
+
+                http::request<http::empty_body> request{ http::verb::get, load.target, 11 };
+                request.set(http::field::host, load.host);
+                request.keep_alive(load.keepAlive);
+                stream->expires_after(std::chrono::seconds(30));
+                co_await http::async_write(*stream, request, use_awaitable);
+
+                http::response<http::string_body> response;
+                co_await http::async_read(*stream, buffer, response, use_awaitable);
+                load.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start));
+                if (response.result() != http::status::ok) ++load.errors;
+                if (!response.keep_alive()) stream.reset();
+            }
+            catch (const boost::system::system_error&) {
+                ++load.errors;
+                stream.reset();
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: http_load_bench <host> <port> [connections=1000] [seconds=10] [target=/] [--close]\n";
+        return 1;
+    }
+    std::vector<std::string> args(argv + 1, argv + argc);
+    Load load;
+    auto close = std::find(args.begin(), args.end(), "--close");
+    if (close != args.end()) {
+        load.keepAlive = false;
+        args.erase(close);
+    }
+    size_t connections = args.size() > 2 ? std::stoul(args[2]) : 1000;
+    int seconds = args.size() > 3 ? std::stoi(args[3]) : 10;
+    load.host = args[0];
+    load.target = args.size() > 4 ? args[4] : "/";
+
+    boost::asio::io_context ioc;
+    load.endpoints = tcp::resolver(ioc).resolve(args[0], args[1]);
+    auto start = std::chrono::steady_clock::now();
+    load.deadline = start + std::chrono::seconds(seconds);
+    for (size_t i = 0; i < connections; ++i) {
+        boost::asio::co_spawn(ioc, client(load), boost::asio::detached);
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < std::max(1u, std::thread::hardware_concurrency()); ++i) {
+        threads.emplace_back([&ioc]() { ioc.run(); });
+    }
+    ioc.run();
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << (load.keepAlive ? "keep-alive" : "connection per request") << ", " << connections
+        << " connections, " << load.target << ": " << load.latency.count() / elapsed << " requests/s, errors "
+        << load.errors.load() << "\n" << load.latency.summary() << "\n";
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Бенчмарк записи страниц в PostgreSQL: страниц в секунду при записи по слову за раз (как до пакетной записи)
+// и через Database::saveDocuments (массивы unnest, пачка страниц в одной транзакции)
+//
+// Использование: ingest_bench <config.ini> [страниц=500] [слов на страницу=2000]
+// Пишет в базу данных из конфигурации: запускайте на отдельной базе.
+
+#include "config.hpp"
+#include "database.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    constexpr size_t vocabularySize = 200000;
+
+    // Страницы со словами из словаря с распределением, близким к закону Ципфа
+    std::vector<Document> makeDocuments(const std::string& prefix, size_t pages, size_t wordsPerPage) {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<Document> documents(pages);
+        for (size_t i = 0; i < pages; ++i) {
+            documents[i].url = prefix + std::to_string(i);
+            while (documents[i].words.size() < wordsPerPage) {
+                auto rank = static_cast<size_t>(std::pow(static_cast<double>(vocabularySize), uniform(rng)));
+                ++documents[i].words["w" + std::to_string(rank)];
+            }
+        }
+        return documents;
+    }
+
+    // Запись страницы так, как до пакетной записи: по три запроса на каждое слово
+    void savePerTerm(pqxx::connection& connection, const Document& document) {
+        pqxx::work txn(connection);
+        txn.exec_params("INSERT INTO pages (url) VALUES ($1) ON CONFLICT (url) DO NOTHING", document.url);
+        int pageId = txn.exec_params("SELECT id FROM pages WHERE url = $1", document.url)[0][0].as<int>();
+        for (const auto& [word, frequency] : document.words) {
+            txn.exec_params("INSERT INTO words (word) VALUES ($1) ON CONFLICT (word) DO NOTHING", word);
+            int wordId = txn.exec_params("SELECT id FROM words WHERE word = $1", word)[0][0].as<int>();
+            txn.exec_params("INSERT INTO index (page_id, word_id, frequency) VALUES ($1, $2, $3) "
+                "ON CONFLICT (page_id, word_id) DO UPDATE SET frequency = EXCLUDED.frequency",
+                pageId, wordId, frequency);
+        }
+        txn.commit();
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config.ini> [pages=500] [words_per_page=2000]\n";
+        return 1;
+    }
+    size_t pages = argc > 2 ? std::stoul(argv[2]) : 500;
+    size_t wordsPerPage = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    Config config(argv[1]);
+    Logger logger(config);
+    Database db(config, logger);
+    db.init();
+
+    std::string runId = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+
+    {
+        auto documents = makeDocuments("http://bench.local/per-term/" + runId + "/", pages, wordsPerPage);
+        pqxx::connection connection(config.getDbConnectionString());
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& document : documents) savePerTerm(connection, document);
+        double seconds = secondsSince(start);
+        std::cout << "per-term statements: " << pages / seconds << " pages/s (" << seconds << " s)\n";
+    }
+
+    {
+        auto documents = makeDocuments("http://bench.local/batched/" + runId + "/", pages, wordsPerPage);
+        auto batchSize = static_cast<size_t>(std::max(1, config.getIngestBatchSize()));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < documents.size(); first += batchSize) {
+            size_t last = std::min(documents.size(), first + batchSize);
+            db.saveDocuments(std::vector<Document>(documents.begin() + first, documents.begin() + last));
+        }
+        double seconds = secondsSince(start);
+        std::cout << "unnest batches of " << batchSize << ": " << pages / seconds << " pages/s (" << seconds << " s)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Бенчмарк формата списков словопозиций: размер и скорость распаковки блочного StreamVByte
+// против массива кортежей (документ, частота) без сжатия
+//
+// Словопозиции выгружаются из таблицы index базы данных (как при построении индекса в памяти); без файла
+// конфигурации используется синтетический корпус с распределением частот слов по закону Ципфа.
+//
+// Использование: posting_codec_bench [config] [проходов=5]
+
+#include "config.hpp"
+#include "database.hpp"
+#include "logger.hpp"
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Postings = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    // Корпус: списки словопозиций по словам и длины документов
+    struct Corpus {
+        std::vector<Postings> lists;
+        std::vector<uint32_t> lengths;
+        size_t postings = 0;
+    };
+
+    // Выгрузка словопозиций из базы данных: ID страниц заменяются плотными номерами в порядке выгрузки
+    Corpus loadCorpus(const std::string& configPath) {
+        Config config(configPath);
+        Logger logger(config);
+        Database db(config, logger);
+
+        Corpus corpus;
+        std::unordered_map<int, uint32_t> docs;
+        std::unordered_map<int, uint32_t> terms;
+        db.scanCorpus(
+            [&](int pageId, std::string_view) {
+                docs.emplace(pageId, static_cast<uint32_t>(docs.size()));
+            },
+            [&](int wordId, std::string_view) {
+                terms.emplace(wordId, static_cast<uint32_t>(terms.size()));
+            },
+            [&](int wordId, int pageId, int frequency) {
+                auto doc = docs.find(pageId);
+                auto term = terms.find(wordId);
+                if (doc == docs.end() || term == terms.end() || frequency <= 0) return;
+                if (corpus.lists.size() <= term->second) corpus.lists.resize(term->second + 1);
+                corpus.lists[term->second].emplace_back(doc->second, static_cast<uint32_t>(frequency));
+            });
+
+        corpus.lengths.assign(docs.size(), 0);
+        for (auto& list : corpus.lists) {
+            std::sort(list.begin(), list.end());
+            for (const auto& [doc, freq] : list) corpus.lengths[doc] += freq;
+            corpus.postings += list.size();
+        }
+        return corpus;
+    }
+
+    // Синтетический корпус: r-е по частоте слово встречается примерно в 2/r документов
+    Corpus syntheticCorpus(uint32_t documents, uint32_t terms) {
+        Corpus corpus;
+        corpus.lists.resize(terms);
+        corpus.lengths.assign(documents, 0);
+        std::mt19937 rng(42);
+        std::geometric_distribution<uint32_t> frequency(0.6);
+        for (uint32_t term = 0; term < terms; ++term) {
+            // Разности номеров документов распределены геометрически с долей документов, содержащих слово
+            std::geometric_distribution<uint32_t> gap(std::min(0.999, 2.0 / (term + 1)));
+            for (uint32_t doc = gap(rng); doc < documents; doc += 1 + gap(rng)) {
+                uint32_t freq = 1 + frequency(rng);
+                corpus.lists[term].emplace_back(doc, freq);
+                corpus.lengths[doc] += freq;
+            }
+            corpus.postings += corpus.lists[term].size();
+        }
+        return corpus;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Corpus corpus = argc > 1 ? loadCorpus(argv[1]) : syntheticCorpus(200000, 20000);
+    int passes = argc > 2 ? std::stoi(argv[2]) : 5;
+    if (corpus.postings == 0) {
+        std::cerr << "No postings\n";
+        return 1;
+    }
+
+    // Кодируем все списки в один буфер, как в сегменте индекса
+    std::vector<uint8_t> encoded;
+    std::vector<size_t> offsets;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& list : corpus.lists) {
+        offsets.push_back(encoded.size());
+        PostingCodec::encode(list, corpus.lengths, encoded);
+    }
+    double encodeSeconds = seconds(start);
+    encoded.resize(encoded.size() + PostingCodec::kPadding);
+
+    uint64_t sink = 0; // Не даёт компилятору выбросить работу
+
+    // Полный проход по несжатым спискам
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const auto& list : corpus.lists) {
+            for (const auto& [doc, freq] : list) sink += doc ^ freq;
+        }
+    }
+    double rawSeconds = seconds(start);
+
+    // Полная распаковка сжатых списков
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (size_t offset : offsets) {
+            for (PostingCodec::Cursor cursor(encoded.data() + offset); cursor.valid(); cursor.next()) {
+                sink += cursor.doc() ^ cursor.freq();
+            }
+        }
+    }
+    double decodeSeconds = seconds(start);
+
+    // Пересечение редкого и частого слова: частый список проходится через nextGEQ с пропуском блоков
+    size_t frequent = 0;
+    for (size_t term = 1; term < corpus.lists.size(); ++term) {
+        if (corpus.lists[term].size() > corpus.lists[frequent].size()) frequent = term;
+    }
+    size_t intersections = 0;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (size_t term = 0; term < offsets.size(); term += 97) {
+            PostingCodec::Cursor rare(encoded.data() + offsets[term]);
+            PostingCodec::Cursor common(encoded.data() + offsets[frequent]);
+            for (; rare.valid(); rare.next()) {
+                common.nextGEQ(rare.doc());
+                if (!common.valid()) break;
+                if (common.doc() == rare.doc()) ++sink;
+            }
+            ++intersections;
+        }
+    }
+    double intersectSeconds = seconds(start);
+
+    double total = static_cast<double>(corpus.postings) * passes;
+    std::cout << "Terms: " << corpus.lists.size() << ", documents: " << corpus.lengths.size()
+        << ", postings: " << corpus.postings << ", SIMD decode: " << (PostingCodec::simdAvailable() ? "yes" : "no")
+        << "\n";
+    std::cout << "Raw (doc, freq) pairs: " << sizeof(Postings::value_type) << " bytes/posting, "
+        << total / rawSeconds / 1e6 << " M postings/s\n";
+    std::cout << "Block StreamVByte: " << static_cast<double>(encoded.size()) / corpus.postings << " bytes/posting, "
+        << "encode " << corpus.postings / encodeSeconds / 1e6 << " M postings/s, "
+        << "decode " << total / decodeSeconds / 1e6 << " M postings/s\n";
+    std::cout << "Intersections with the most frequent term: " << intersections << ", "
+        << intersectSeconds * 1e6 / intersections << " us each\n";
+    std::cout << "(checksum " << sink << ")\n";
+    return 0;
+}
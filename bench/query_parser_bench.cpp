@@ -0,0 +1,76 @@
+// Бенчмарк разбора тела поисковой формы: прежний разбор через istringstream и std::stoi
+// против QueryParser (декодирование в один буфер и string_view на слова)
+//
+// Использование: query_parser_bench [повторов=1000000] [тело формы]
+
+#include "query_parser.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    // Прежнее декодирование: по символу из потока, "%XX" через std::stoi
+    std::string streamDecode(const std::string& text) {
+        std::string result;
+        std::istringstream in(text);
+        char ch;
+        while (in.get(ch)) {
+            if (ch == '%') {
+                std::string hex;
+                if (in.get(ch)) hex += ch;
+                if (in.get(ch)) hex += ch;
+                result += static_cast<char>(std::stoi(hex, nullptr, 16));
+            }
+            else if (ch == '+') {
+                result += ' ';
+            }
+            else {
+                result += ch;
+            }
+        }
+        return result;
+    }
+
+    double nanosecondsPerOp(std::chrono::steady_clock::time_point start, size_t repeats) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+            static_cast<double>(repeats);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t repeats = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::string body = argc > 2 ? argv[2]
+        : "query=%D0%BF%D1%80%D0%B8%D0%B2%D0%B5%D1%82+%D0%BC%D0%B8%D1%80+search+engine+test";
+    size_t sink = 0; // Не даёт компилятору выбросить работу
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+        std::istringstream in(body);
+        std::string key, value;
+        std::getline(in, key, '=');
+        std::getline(in, value);
+        std::istringstream words(streamDecode(value));
+        std::string word;
+        while (words >> word) sink += word.size();
+    }
+    std::cout << "istringstream + stoi: " << nanosecondsPerOp(start, repeats) << " ns/request\n";
+
+    QueryParser parser;
+    std::vector<std::string_view> words;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+        if (!parser.parse(body)) continue;
+        words.clear();
+        QueryParser::tokenize(parser.get("query").value_or(std::string_view()), words);
+        for (auto word : words) sink += word.size();
+    }
+    std::cout << "QueryParser: " << nanosecondsPerOp(start, repeats) << " ns/request\n";
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// Бенчмарк стоимости разбора и планирования поискового запроса
+//
+// Один и тот же текст Database::searchQuery выполняется двумя способами на одном соединении: как неименованный
+// запрос с параметрами (PostgreSQL разбирает и планирует его при каждом вызове, как было до подготовленных
+// запросов) и как именованный подготовленный запрос (план строится один раз на соединение). Для сравнения
+// выполняется и прежний запрос, собранный из слов через OR. Среднее время планирования берётся из EXPLAIN ANALYZE.
+//
+// Использование: search_plan_bench <config.ini> [запросов=2000] [слов в запросе=2]
+// Нужна база с проиндексированными страницами (слова запросов берутся из самых частых слов).
+
+#include "bm25.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Число с точкой в качестве разделителя независимо от локали
+    std::string formatNumber(float value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Прежний поиск: слова подставляются в текст запроса, поэтому каждый запрос — новый текст
+    std::string orQuery(pqxx::work& txn, const std::vector<std::string>& terms) {
+        std::string sql = "SELECT p.url, SUM(i.frequency) AS total FROM pages p "
+            "JOIN index i ON p.id = i.page_id JOIN words w ON w.id = i.word_id WHERE ";
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (i > 0) sql += " OR ";
+            sql += "w.word = " + txn.quote(terms[i]);
+        }
+        sql += " GROUP BY p.url HAVING COUNT(DISTINCT w.word) = " + std::to_string(terms.size()) +
+            " ORDER BY total DESC LIMIT 10";
+        return sql;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config.ini> [queries=2000] [terms_per_query=2]\n";
+        return 1;
+    }
+    size_t queries = argc > 2 ? std::stoul(argv[2]) : 2000;
+    size_t termsPerQuery = argc > 3 ? std::stoul(argv[3]) : 2;
+
+    Config config(argv[1]);
+    pqxx::connection connection(config.getDbConnectionString());
+    connection.prepare("search", Database::searchQuery);
+
+    std::vector<std::string> vocabulary;
+    {
+        pqxx::work txn(connection);
+        for (const auto& row : txn.exec("SELECT word FROM words ORDER BY doc_freq DESC LIMIT 500")) {
+            vocabulary.push_back(row[0].as<std::string>());
+        }
+    }
+    if (vocabulary.empty()) {
+        std::cerr << "The words table is empty: index some pages first\n";
+        return 1;
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+    std::vector<std::vector<std::string>> workload(queries);
+    for (auto& terms : workload) {
+        for (size_t i = 0; i < termsPerQuery; ++i) terms.push_back(vocabulary[pick(rng)]);
+    }
+
+    const std::optional<std::string> noCursor;
+    auto run = [&](const char* name, auto&& execute) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& terms : workload) {
+            pqxx::work txn(connection);
+            execute(txn, terms);
+            txn.commit();
+        }
+        double seconds = secondsSince(start);
+        std::cout << name << ": " << seconds * 1e6 / static_cast<double>(queries) << " us/query\n";
+    };
+
+    run("OR-concatenated text", [&](pqxx::work& txn, const std::vector<std::string>& terms) {
+        txn.exec(orQuery(txn, terms));
+        });
+    run("searchQuery, parsed and planned per call", [&](pqxx::work& txn, const std::vector<std::string>& terms) {
+        txn.exec_params(Database::searchQuery, terms, Bm25::kK1, Bm25::kB, 10LL, 0LL, noCursor, noCursor);
+        });
+    run("searchQuery, prepared", [&](pqxx::work& txn, const std::vector<std::string>& terms) {
+        txn.exec_prepared("search", terms, Bm25::kK1, Bm25::kB, 10LL, 0LL, noCursor, noCursor);
+        });
+
+    // Время планирования одного вызова по EXPLAIN ANALYZE (строка "Planning Time: X ms")
+    double planningMs = 0;
+    size_t samples = std::min<size_t>(queries, 200);
+    for (size_t i = 0; i < samples; ++i) {
+        pqxx::work txn(connection);
+        std::string quoted = "ARRAY[";
+        for (size_t t = 0; t < workload[i].size(); ++t) quoted += (t ? "," : "") + txn.quote(workload[i][t]);
+        quoted += "]::text[]";
+        std::string sql = std::string("EXPLAIN ANALYZE ") + Database::searchQuery;
+        auto replace = [&sql](const std::string& from, const std::string& to) {
+            for (size_t pos = sql.find(from); pos != std::string::npos; pos = sql.find(from, pos + to.size())) {
+                sql.replace(pos, from.size(), to);
+            }
+        };
+        replace("$1::text[]", quoted);
+        replace("$2", formatNumber(Bm25::kK1));
+        replace("$3", formatNumber(Bm25::kB));
+        replace("$4", "10");
+        replace("$5", "0");
+        replace("$6", "NULL");
+        replace("$7", "NULL");
+        for (const auto& row : txn.exec(sql)) {
+            std::string line = row[0].as<std::string>();
+            if (line.rfind("Planning Time: ", 0) == 0) planningMs += std::stod(line.substr(15));
+        }
+    }
+    std::cout << "planning time per call (EXPLAIN ANALYZE): " << planningMs * 1000 / static_cast<double>(samples)
+        << " us\n";
+    return 0;
+}
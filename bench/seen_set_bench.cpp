@@ -0,0 +1,102 @@
+// Бенчмарк множества посещённых URL: unordered_set<std::string> (прежнее множество краулера) против SeenSet,
+// байт на URL, вставки и поиски в секунду и доля ложных срабатываний
+//
+// Память unordered_set считается по выделениям operator new (строки, узлы и корзины); память SeenSet — по
+// размеру его таблицы.
+//
+// Использование: seen_set_bench [URL=1000000] [доля ложных срабатываний=1e-6] [бюджет МБ=1024]
+
+#include "seen_set.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+    std::atomic<size_t> allocated{ 0 };
+
+    // URL разной длины на нескольких тысячах хостов
+    std::string makeUrl(size_t i) {
+        return "https://www.site" + std::to_string(i % 5000) + ".example.com/articles/" + std::to_string(i) +
+            "/some-slug-text-" + std::to_string(i * 7 % 1000) + "?page=" + std::to_string(i % 13);
+    }
+
+    template<typename F>
+    double seconds(F&& work) {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+// Выделения памяти считаются, чтобы узнать объём unordered_set
+void* operator new(size_t size) {
+    allocated.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    double rate = argc > 2 ? std::stod(argv[2]) : 1e-6;
+    size_t budgetMb = argc > 3 ? std::stoul(argv[3]) : 1024;
+
+    // Посещённые URL и столько же новых
+    std::vector<std::string> seen, fresh;
+    seen.reserve(count);
+    fresh.reserve(count);
+    size_t urlBytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        seen.push_back(makeUrl(i));
+        fresh.push_back(makeUrl(i + count));
+        urlBytes += seen.back().size();
+    }
+    double millions = static_cast<double>(count) / 1e6;
+    std::cout << "URLs: " << count << ", average length " << urlBytes / count << " bytes\n";
+
+    {
+        std::unordered_set<std::string> set;
+        size_t hits = 0;
+        size_t before = allocated.load();
+        double insertSeconds = seconds([&]() { for (const auto& url : seen) set.insert(url); });
+        size_t bytes = allocated.load() - before;
+        double hitSeconds = seconds([&]() { for (const auto& url : seen) hits += set.count(url); });
+        double missSeconds = seconds([&]() { for (const auto& url : fresh) hits += set.count(url); });
+        std::cout << "unordered_set<string>: " << bytes / count << " bytes/URL, insert " << millions / insertSeconds
+            << " M/s, lookup (seen) " << millions / hitSeconds << " M/s, lookup (new) " << millions / missSeconds
+            << " M/s\n";
+    }
+
+    {
+        SeenSet set(budgetMb << 20, rate);
+        size_t added = 0, falsePositives = 0;
+        // Поиск в SeenSet — это вставка: посещённый отпечаток не добавляется повторно
+        double insertSeconds = seconds([&]() {
+            for (const auto& url : seen) added += set.insert(SeenSet::fingerprint(url));
+            });
+        double hitSeconds = seconds([&]() {
+            for (const auto& url : seen) added += set.insert(SeenSet::fingerprint(url));
+            });
+        uint64_t droppedBefore = set.dropped();
+        double missSeconds = seconds([&]() {
+            for (const auto& url : fresh) falsePositives += !set.insert(SeenSet::fingerprint(url));
+            });
+        falsePositives -= static_cast<size_t>(set.dropped() - droppedBefore);
+        std::cout << "SeenSet (" << budgetMb << " MB, " << set.width() << "-bit fingerprints): "
+            << set.bytes() / set.size() << " bytes/URL, insert " << millions / insertSeconds
+            << " M/s, lookup (seen) " << millions / hitSeconds << " M/s, lookup (new) " << millions / missSeconds
+            << " M/s, false positives " << falsePositives << " of " << count << ", dropped " << set.dropped()
+            << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Бенчмарк отбора лучших документов: BlockMax-WAND против полной оценки на одних и тех же запросах, в режимах
+// «все слова» и «любое слово»; перцентили задержки запроса и сверка результатов обоих алгоритмов
+//
+// Слова запросов выбираются случайно из тысячи самых частых слов сегмента, по 2–4 слова в запросе. Без файла
+// сегмента (или с «-» вместо него) используется синтетический корпус с распределением частот слов по закону Ципфа.
+//
+// Использование: top_k_bench [сегмент|-] [запросов=1000] [k=10]
+
+#include "bm25.hpp"
+#include "index_segment.hpp"
+#include "top_k_evaluator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    constexpr size_t kVocabulary = 1000;    // Слова запросов — из этого числа самых частых слов
+    constexpr float kScoreTolerance = 1e-4f; // Допустимое расхождение оценок (порядок сложения вкладов разный)
+
+    // Синтетический сегмент: r-е по частоте слово встречается примерно в 2/r документов
+    std::shared_ptr<IndexSegment> syntheticSegment(uint32_t documents, uint32_t terms) {
+        std::mt19937 rng(42);
+        std::geometric_distribution<uint32_t> frequency(0.6);
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> lists(terms);
+        std::vector<uint32_t> lengths(documents, 0);
+        for (uint32_t term = 0; term < terms; ++term) {
+            std::geometric_distribution<uint32_t> gap(std::min(0.999, 2.0 / (term + 1)));
+            for (uint32_t doc = gap(rng); doc < documents; doc += 1 + gap(rng)) {
+                uint32_t freq = 1 + frequency(rng);
+                lists[term].emplace_back(doc, freq);
+                lengths[doc] += freq;
+            }
+        }
+
+        SegmentBuilder builder;
+        for (uint32_t doc = 0; doc < documents; ++doc) {
+            builder.addDocument("https://example.com/" + std::to_string(doc), lengths[doc]);
+        }
+        for (uint32_t term = 0; term < terms; ++term) {
+            uint32_t id = builder.termId("w" + std::to_string(term));
+            for (const auto& [doc, freq] : lists[term]) builder.addPosting(id, doc, freq);
+        }
+        return IndexSegment::fromBuffer(builder.build(SegmentBuilder::newGeneration()));
+    }
+
+    // Задержки одного режима одного алгоритма
+    struct Timings {
+        std::vector<double> micros;
+
+        double percentile(double p) {
+            std::sort(micros.begin(), micros.end());
+            size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * micros.size()));
+            return micros[std::min(micros.size(), std::max<size_t>(rank, 1)) - 1];
+        }
+    };
+
+    // Совпадение результатов: те же документы в том же порядке; документы с почти равной оценкой могут
+    // поменяться местами, поэтому при расхождении номера сравниваются оценки
+    bool sameResults(const std::vector<TopKEvaluator::Hit>& a, const std::vector<TopKEvaluator::Hit>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            float tolerance = kScoreTolerance * std::max(1.0f, std::abs(b[i].score));
+            if (std::abs(a[i].score - b[i].score) > tolerance) return false;
+            if (a[i].doc != b[i].doc) {
+                bool tied = (i > 0 && std::abs(b[i - 1].score - b[i].score) <= tolerance) ||
+                    (i + 1 < b.size() && std::abs(b[i + 1].score - b[i].score) <= tolerance);
+                if (!tied) return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::shared_ptr<IndexSegment> segment = argc > 1 && std::string(argv[1]) != "-" ? IndexSegment::open(argv[1]) :
+        syntheticSegment(1000000, 50000);
+    size_t queries = argc > 2 ? std::stoul(argv[2]) : 1000;
+    size_t k = argc > 3 ? std::stoul(argv[3]) : 10;
+    if (segment->documentCount() == 0 || segment->termCount() == 0) {
+        std::cerr << "Empty segment\n";
+        return 1;
+    }
+
+    // Самые частые слова сегмента
+    std::vector<IndexSegment::Term> vocabulary;
+    for (uint32_t i = 0; i < segment->termCount(); ++i) vocabulary.push_back(segment->termAt(i));
+    std::sort(vocabulary.begin(), vocabulary.end(),
+        [](const IndexSegment::Term& a, const IndexSegment::Term& b) { return a.docFreq > b.docFreq; });
+    vocabulary.resize(std::min(vocabulary.size(), kVocabulary));
+
+    // Запросы: 2–4 разных слова
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+    std::uniform_int_distribution<size_t> length(2, std::min<size_t>(4, vocabulary.size()));
+    std::vector<std::vector<TopKEvaluator::Term>> queryTerms(queries);
+    for (auto& terms : queryTerms) {
+        std::vector<size_t> chosen;
+        for (size_t n = length(rng); chosen.size() < n;) {
+            size_t word = pick(rng);
+            if (std::find(chosen.begin(), chosen.end(), word) == chosen.end()) chosen.push_back(word);
+        }
+        for (size_t word : chosen) {
+            const auto& term = vocabulary[word];
+            terms.push_back({ term.postings, term.docFreq, term.maxFreq, term.minLength,
+                Bm25::idf(segment->documentCount(), term.docFreq) });
+        }
+    }
+
+    float averageLength = static_cast<float>(static_cast<double>(segment->totalLength()) / segment->documentCount());
+    std::cout << "Documents: " << segment->documentCount() << ", terms: " << segment->termCount()
+        << ", queries: " << queries << ", k = " << k << "\n";
+
+    bool allMatch = true;
+    for (auto mode : { TopKEvaluator::Mode::Conjunctive, TopKEvaluator::Mode::Disjunctive }) {
+        const char* modeName = mode == TopKEvaluator::Mode::Conjunctive ? "all words" : "any word";
+        Timings blockMax, exhaustive;
+        size_t mismatches = 0;
+        for (size_t q = 0; q < queries; ++q) {
+            const auto& terms = queryTerms[q];
+            std::vector<TopKEvaluator::Hit> results[2];
+            Timings* timings[2] = { &blockMax, &exhaustive };
+            TopKEvaluator::Strategy strategies[2] = { TopKEvaluator::Strategy::BlockMaxWand,
+                TopKEvaluator::Strategy::Exhaustive };
+            // Первым идёт то один, то другой алгоритм, чтобы прогрев кэша процессора не доставался одному из них
+            for (size_t i = 0; i < 2; ++i) {
+                size_t s = (q + i) % 2;
+                auto start = std::chrono::steady_clock::now();
+                TopKEvaluator evaluator(k, mode, strategies[s], averageLength);
+                results[s] = evaluator.run(terms, *segment, {}, TopKEvaluator::After{});
+                timings[s]->micros.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            if (!sameResults(results[0], results[1])) ++mismatches;
+        }
+        allMatch = allMatch && mismatches == 0;
+
+        for (auto [name, timing] : { std::pair<const char*, Timings*>{ "blockmax", &blockMax },
+            std::pair<const char*, Timings*>{ "exhaustive", &exhaustive } }) {
+            std::cout << modeName << ", " << name << ": p50 " << timing->percentile(50) << " us, p95 "
+                << timing->percentile(95) << " us, p99 " << timing->percentile(99) << " us\n";
+        }
+        std::cout << modeName << ": top-" << k << " differs in " << mismatches << " of " << queries << " queries\n";
+    }
+    return allMatch ? 0 : 1;
+}
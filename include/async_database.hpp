@@ -0,0 +1,87 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "search_page.hpp"
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
+
+#include <libpq-fe.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Асинхронный поиск в базе данных для сервера на сопрограммах
+//
+// Запросы идут через неблокирующий интерфейс libpq (PQsendQueryPrepared, PQconsumeInput), а готовности
+// сокета ждёт io_context сервера: пока PostgreSQL выполняет запрос, поток обслуживает другие соединения.
+// Небольшой набор соединений обслуживает все запросы; если свободных нет, сопрограмма ждёт освобождения,
+// не занимая поток. Запись страниц и фоновые задачи по-прежнему идут через Database и пул libpqxx.
+class AsyncDatabase {
+public:
+    // Конструктор, который берёт строку подключения и число соединений из конфигурации
+    AsyncDatabase(boost::asio::any_io_executor executor, const Config& config, Logger& logger);
+
+    // Деструктор закрывает соединения (io_context к этому моменту должен быть остановлен)
+    ~AsyncDatabase();
+
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+    // Метод для поиска страниц по запросу (тот же запрос, ранжирование и курсор, что и Database::search)
+    // При ошибке базы данных бросает std::runtime_error, при некорректном курсоре — std::invalid_argument
+    boost::asio::awaitable<SearchPage> search(std::vector<std::string> queryWords, size_t limit = 10, size_t offset = 0,
+        std::string cursor = {});
+
+private:
+    // Соединение libpq и обёртка Asio над его сокетом (сокетом владеет libpq)
+    struct Connection {
+        PGconn* conn = nullptr;
+        std::unique_ptr<boost::asio::generic::stream_protocol::socket> socket; // TCP (IPv4/IPv6) или Unix-сокет
+        bool prepared = false;
+
+        ~Connection();
+    };
+
+    // Сопрограмма, ожидающая соединения
+    struct Waiter;
+
+    // Результат запроса с освобождением через PQclear
+    struct ResultDeleter {
+        void operator()(PGresult* result) const { PQclear(result); }
+    };
+    using Result = std::unique_ptr<PGresult, ResultDeleter>;
+
+    // Выдача и возврат соединения; при нехватке соединений сопрограмма ждёт без блокировки потока
+    boost::asio::awaitable<std::unique_ptr<Connection>> acquire();
+    void release(std::unique_ptr<Connection> connection);
+
+    // Неблокирующее подключение и подготовка запроса
+    boost::asio::awaitable<void> connect(Connection& connection);
+
+    // Привязка сокета libpq к io_context (сокет может смениться при подключении)
+    void attachSocket(Connection& connection);
+
+    // Отправка накопленных данных и получение результата текущего запроса
+    boost::asio::awaitable<Result> finish(Connection& connection);
+
+    // Исключение с текстом ошибки libpq
+    static std::runtime_error error(const Connection& connection, const std::string& what);
+
+    boost::asio::any_io_executor executor;  // Исполнитель io_context сервера
+    std::string connectionString;           // Строка подключения
+    size_t capacity;                        // Максимальное количество соединений
+    Logger& logger;                         // Логер для записи логов
+
+    std::mutex mutex;                                               // Защищает поля ниже
+    std::vector<std::unique_ptr<Connection>> idle;                  // Свободные соединения
+    size_t created = 0;                                             // Открытые и открывающиеся соединения
+    std::deque<std::unique_ptr<Waiter>> waiters;                    // Сопрограммы, ждущие соединения
+};
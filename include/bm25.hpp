@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Формула ранжирования BM25, общая для поиска в базе данных и в индексе в памяти
+//
+// Вклад слова в оценку документа: idf * tf * (k1 + 1) / (tf + k1 * (1 - b + b * длина / средняя длина)),
+// где tf — частота слова в документе, длина — сумма частот всех слов документа.
+// Вклад растёт с частотой и убывает с длиной документа, поэтому пара (максимальная частота, минимальная длина)
+// блока даёт верхнюю границу вклада для досрочного отсечения.
+namespace Bm25 {
+
+    constexpr float kK1 = 1.2f;  // Насыщение по частоте слова
+    constexpr float kB = 0.75f;  // Степень нормализации по длине документа
+
+    // Обратная частота документов: редкие слова весят больше, слово из каждого документа — почти ничего
+    inline float idf(uint64_t documents, uint64_t docFreq) {
+        if (docFreq > documents) docFreq = documents;
+        double n = static_cast<double>(documents);
+        double df = static_cast<double>(docFreq);
+        return static_cast<float>(std::log(1.0 + (n - df + 0.5) / (df + 0.5)));
+    }
+
+    // Вклад слова в оценку документа
+    inline float weight(float idf, uint32_t freq, uint32_t length, float averageLength) {
+        float tf = static_cast<float>(freq);
+        float norm = averageLength > 0.0f ? static_cast<float>(length) / averageLength : 1.0f;
+        return idf * tf * (kK1 + 1.0f) / (tf + kK1 * (1.0f - kB + kB * norm));
+    }
+
+} // namespace Bm25
@@ -1,47 +1,137 @@
 #pragma once
 #include <string>
 
-//      
+// Класс для работы с конфигурацией программы
 class Config {
 public:
-    // ,     
+    // Конструктор, который принимает имя файла конфигурации
     Config(const std::string& filename);
 
-    //      
-    std::string getDbHost() const { return dbHost; }           //    
-    int getDbPort() const { return dbPort; }                   //    
-    std::string getDbName() const { return dbName; }           //    
-    std::string getDbUser() const { return dbUser; }           //      
-    std::string getDbPassword() const { return dbPassword; }   //     
-    std::string getDbConnectionString() const;                 //      
+    // Методы для получения значений параметров конфигурации
+    std::string getDbHost() const { return dbHost; }           // Получить хост базы данных
+    int getDbPort() const { return dbPort; }                   // Получить порт базы данных
+    std::string getDbName() const { return dbName; }           // Получить имя базы данных
+    std::string getDbUser() const { return dbUser; }           // Получить имя пользователя для базы данных
+    std::string getDbPassword() const { return dbPassword; }   // Получить пароль для базы данных
+    std::string getDbConnectionString() const;                 // Получить строку подключения для базы данных
+    int getDbPoolSize() const { return dbPoolSize; }           // Получить размер пула соединений
+    int getDbAsyncConnections() const { return dbAsyncConnections; } // Получить число асинхронных соединений сервера
 
-    std::string getStartUrl() const { return startUrl; }       //   URL  
-    int getMaxDepth() const { return maxDepth; }               //    
-    int getTimeout() const { return timeout; }                 //   
-    bool shouldFilterStopwords() const { return filterStopwords; }  // ,    -
+    std::string getStartUrl() const { return startUrl; }       // Получить начальный URL для сканирования
+    int getMaxDepth() const { return maxDepth; }               // Получить максимальную глубину сканирования
+    int getTimeout() const { return timeout; }                 // Получить таймаут запроса
+    bool shouldFilterStopwords() const { return filterStopwords; }  // Проверить, нужно ли фильтровать стоп-слова
+    int getMaxInFlight() const { return maxInFlight; }         // Получить наибольшее число одновременных загрузок
+    int getFetchThreads() const { return fetchThreads; }       // Получить количество потоков загрузки (0 — по числу ядер)
+    int getIndexThreads() const { return indexThreads; }       // Получить количество потоков обработки страниц (0 — по числу ядер)
+    int getKeepAliveSeconds() const { return keepAliveSeconds; } // Получить время простоя соединения краулера до закрытия
+    int getMaxIdlePerHost() const { return maxIdlePerHost; }   // Получить наибольшее число свободных соединений хоста
+    int getDispatchThreads() const { return dispatchThreads; } // Получить количество потоков, раздающих URL
+    int getFrontierShards() const { return frontierShards; }   // Получить количество шардов очередей хостов
+    int getMaxPerHost() const { return maxPerHost; }           // Получить наибольшее число одновременных загрузок хоста
+    int getHostDelayMs() const { return hostDelayMs; }         // Получить интервал между загрузками одного хоста
+    int getSeenMemoryMb() const { return seenMemoryMb; }       // Получить бюджет памяти множества посещённых URL
+    double getSeenFalsePositiveRate() const { return seenFalsePositiveRate; } // Получить допустимую долю ложных срабатываний
+    int getNearDuplicateDistance() const { return nearDuplicateDistance; } // Получить расстояние SimHash почти дубликатов (-1 — не искать)
+    std::string getStateFile() const { return stateFile; }     // Получить файл журнала состояния обхода (пусто — не ведётся)
+    int getCheckpointIntervalMs() const { return checkpointIntervalMs; } // Получить период записи журнала состояния
+    bool isIncrementalRecrawl() const { return incrementalRecrawl; } // Проверить, загружать ли сохранённые страницы условно
 
-    int getServerPort() const { return serverPort; }           //   
+    int getServerPort() const { return serverPort; }           // Получить порт сервера
+    int getServerThreads() const { return serverThreads; }     // Получить количество потоков сервера (0 — по числу ядер)
+    int getSessionTimeoutSeconds() const { return sessionTimeoutSeconds; } // Получить таймаут чтения и записи соединения
+    bool useInMemoryIndex() const { return inMemoryIndex; }    // Проверить, обслуживать ли поиск из индекса в памяти
+    std::string getQueryMode() const { return queryMode; }     // Получить режим запроса: all (все слова) или any (любое слово)
+    std::string getTopKAlgorithm() const { return topKAlgorithm; } // Получить алгоритм отбора лучших: blockmax или exhaustive
+    int getMaxResults() const { return maxResults; }           // Получить наибольшее число результатов на странице JSON API
+    int getMaxOffset() const { return maxOffset; }             // Получить наибольшее смещение JSON API
 
-    bool isConsoleLoggingEnabled() const { return logToConsole; } // ,     
-    bool isFileLoggingEnabled() const { return logToFile; }     // ,     
-    std::string getLogDir() const { return logDir; }           //    
+    int getIngestQueueSize() const { return ingestQueueSize; }         // Получить ёмкость очереди записи в БД
+    int getIngestBatchSize() const { return ingestBatchSize; }         // Получить число страниц в одной транзакции
+    int getIngestFlushIntervalMs() const { return ingestFlushIntervalMs; } // Получить интервал сброса неполной пачки
+    int getIngestWriters() const { return ingestWriters; }             // Получить количество потоков записи
+    bool shouldWriteDatabase() const { return writeDatabase; }         // Проверить, записывать ли страницы в базу данных
+
+    std::string getSegmentDir() const { return segmentDir; }           // Получить каталог сегментов индекса (пусто — сегменты не используются)
+    int getSegmentFlushDocs() const { return segmentFlushDocs; }       // Получить число документов в сегменте, записываемом краулером
+    int getMergeFactor() const { return mergeFactor; }                 // Получить число сегментов, сливаемых за раз
+    int getMergeIntervalMs() const { return mergeIntervalMs; }         // Получить интервал проверки необходимости слияния
+
+    int getCacheMemoryMb() const { return cacheMemoryMb; }             // Получить бюджет памяти кэша запросов (0 — кэш отключён)
+    int getCacheTtlSeconds() const { return cacheTtlSeconds; }         // Получить время жизни записи кэша
+    int getCacheShards() const { return cacheShards; }                 // Получить количество шардов кэша
+    int getCorpusVersionPollMs() const { return corpusVersionPollMs; } // Получить интервал проверки версии корпуса
+
+    bool isCompressionEnabled() const { return compressionEnabled; }   // Проверить, сжимать ли ответы сервера
+    int getCompressionMinSize() const { return compressionMinSize; }   // Получить минимальный размер сжимаемого ответа
+    int getGzipLevel() const { return gzipLevel; }                     // Получить уровень gzip для динамических ответов
+    int getBrotliQuality() const { return brotliQuality; }             // Получить качество brotli для динамических ответов
+
+    bool isConsoleLoggingEnabled() const { return logToConsole; } // Проверить, включен ли вывод в консоль
+    bool isFileLoggingEnabled() const { return logToFile; }     // Проверить, включен ли вывод в файл
+    std::string getLogDir() const { return logDir; }           // Получить директорию для логов
 
 private:
-    // ,   
-    std::string dbHost;        //   
-    int dbPort;                //   
-    std::string dbName;        //   
-    std::string dbUser;        //    
-    std::string dbPassword;    //   
-
-    std::string startUrl;      //  URL  
-    int maxDepth;              //   
-    int timeout;               //  
-    bool filterStopwords;      // ,     -
-
-    int serverPort;            //  
-
-    bool logToConsole;         // ,      
-    bool logToFile;            // ,      
-    std::string logDir;        //   
+    // Переменные, хранящие параметры конфигурации
+    std::string dbHost;        // Хост базы данных
+    int dbPort;                // Порт базы данных
+    std::string dbName;        // Имя базы данных
+    std::string dbUser;        // Имя пользователя базы данных
+    std::string dbPassword;    // Пароль базы данных
+    int dbPoolSize;            // Размер пула соединений
+    int dbAsyncConnections;    // Число асинхронных соединений поискового сервера
+
+    std::string startUrl;      // Начальный URL для сканирования
+    int maxDepth;              // Максимальная глубина сканирования
+    int timeout;               // Таймаут запроса
+    bool filterStopwords;      // Флаг, указывающий на необходимость фильтрации стоп-слов
+    int maxInFlight;           // Наибольшее число одновременных загрузок страниц
+    int fetchThreads;          // Количество потоков, выполняющих загрузки
+    int indexThreads;          // Количество потоков, обрабатывающих загруженные страницы
+    int keepAliveSeconds;      // Время простоя соединения краулера, после которого оно закрывается
+    int maxIdlePerHost;        // Наибольшее число свободных соединений одного хоста
+    int dispatchThreads;       // Количество потоков, раздающих URL движку загрузки
+    int frontierShards;        // Количество шардов очередей хостов
+    int maxPerHost;            // Наибольшее число одновременных загрузок одного хоста
+    int hostDelayMs;           // Наименьший интервал между началами загрузок одного хоста
+    int seenMemoryMb;          // Бюджет памяти множества посещённых URL в мегабайтах
+    double seenFalsePositiveRate; // Допустимая доля новых URL, ошибочно принятых за посещённые
+    int nearDuplicateDistance; // Наибольшее расстояние Хэмминга между отпечатками SimHash почти одинаковых страниц
+    std::string stateFile;     // Файл журнала состояния обхода
+    int checkpointIntervalMs;  // Период записи журнала состояния на диск
+    bool incrementalRecrawl;   // Флаг повторного обхода с условными запросами и сравнением содержимого
+
+    int serverPort;            // Порт сервера
+    int serverThreads;         // Количество потоков, обслуживающих соединения
+    int sessionTimeoutSeconds; // Таймаут чтения и записи соединения (и простоя keep-alive)
+    bool inMemoryIndex;        // Флаг, указывающий на поиск по индексу в памяти вместо запросов к базе данных
+    std::string queryMode;     // Режим запроса (all или any)
+    std::string topKAlgorithm; // Алгоритм отбора лучших документов (blockmax или exhaustive)
+    int maxResults;            // Наибольшее число результатов на странице JSON API
+    int maxOffset;             // Наибольшее смещение JSON API (дальше листают курсором)
+
+    int ingestQueueSize;       // Ёмкость очереди записи в БД (в страницах)
+    int ingestBatchSize;       // Количество страниц в одной транзакции
+    int ingestFlushIntervalMs; // Интервал сброса неполной пачки
+    int ingestWriters;         // Количество потоков записи
+    bool writeDatabase;        // Флаг записи страниц в базу данных
+
+    std::string segmentDir;    // Каталог сегментов индекса
+    int segmentFlushDocs;      // Число документов в сегменте, записываемом краулером
+    int mergeFactor;           // Число сегментов, сливаемых за раз
+    int mergeIntervalMs;       // Интервал проверки необходимости слияния
+
+    int cacheMemoryMb;         // Бюджет памяти кэша запросов в мегабайтах
+    int cacheTtlSeconds;       // Время жизни записи кэша
+    int cacheShards;           // Количество шардов кэша
+    int corpusVersionPollMs;   // Интервал проверки версии корпуса
+
+    bool compressionEnabled;   // Флаг сжатия ответов сервера
+    int compressionMinSize;    // Минимальный размер сжимаемого ответа в байтах
+    int gzipLevel;             // Уровень gzip для динамических ответов
+    int brotliQuality;         // Качество brotli для динамических ответов
+
+    bool logToConsole;         // Флаг, указывающий на вывод логов в консоль
+    bool logToFile;            // Флаг, указывающий на вывод логов в файл
+    std::string logDir;        // Директория для логов
 };
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "logger.hpp"
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Пул соединений с PostgreSQL: каждый поток берёт своё соединение на время транзакции
+class ConnectionPool {
+public:
+    // Функция, которая регистрирует подготовленные запросы на новом соединении
+    using Preparer = std::function<void(pqxx::connection&)>;
+
+    // Счётчики пула (время ожидания — в микросекундах)
+    struct Stats {
+        uint64_t acquisitions = 0;  // Сколько раз выдавалось соединение
+        uint64_t waits = 0;         // Сколько раз пул был исчерпан и пришлось ждать
+        uint64_t totalWaitUs = 0;   // Суммарное время ожидания
+        uint64_t maxWaitUs = 0;     // Максимальное время одного ожидания
+        uint64_t reconnects = 0;    // Сколько раз соединение пересоздавалось после обрыва
+    };
+
+    // Соединение пула вместе с признаком того, что на нём уже зарегистрированы подготовленные запросы
+    struct Slot {
+        std::unique_ptr<pqxx::connection> connection;
+        bool prepared = false;
+    };
+
+    // RAII-аренда соединения: при разрушении соединение возвращается в пул
+    class Lease {
+    public:
+        Lease(ConnectionPool& pool, Slot slot);
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() const { return *slot.connection; }
+        pqxx::connection* operator->() const { return slot.connection.get(); }
+
+        // Метод для отказа от оборванного соединения: слот вернётся в пул пустым и откроется заново при выдаче
+        // (is_open() у соединения, оборванного на стороне сервера, остаётся true до первой ошибки)
+        void discard() { slot.connection.reset(); }
+
+    private:
+        ConnectionPool* pool;
+        Slot slot;
+    };
+
+    // Конструктор, который сразу открывает size соединений
+    ConnectionPool(const std::string& connectionString, size_t size, Preparer preparer, Logger& logger);
+
+    // Метод для получения соединения; блокирует поток, пока все соединения заняты
+    // При первой выдаче соединения на нём регистрируются подготовленные запросы, если prepare == true
+    // (prepare == false нужен для создания схемы, пока таблиц, на которые ссылаются запросы, ещё нет)
+    Lease acquire(bool prepare = true);
+
+    // Метод для получения текущих значений счётчиков
+    Stats stats() const;
+
+    // Размер пула
+    size_t size() const { return poolSize; }
+
+private:
+    // Возвращает соединение в пул (вызывается из деструктора Lease)
+    void release(Slot slot);
+
+    std::string connectionString;  // Строка подключения к базе данных
+    size_t poolSize;               // Количество соединений в пуле
+    Preparer preparer;             // Регистрация подготовленных запросов
+    Logger& logger;                // Логер для записи логов
+
+    // Свободные соединения; пустой указатель означает оборванное соединение, которое нужно открыть заново
+    std::vector<Slot> idle;
+    std::mutex poolMutex;              // Мьютекс для доступа к списку свободных соединений
+    std::condition_variable available; // Сигнал о возврате соединения в пул
+
+    std::atomic<uint64_t> acquisitions{ 0 };
+    std::atomic<uint64_t> waits{ 0 };
+    std::atomic<uint64_t> totalWaitUs{ 0 };
+    std::atomic<uint64_t> maxWaitUs{ 0 };
+    std::atomic<uint64_t> reconnects{ 0 };
+};
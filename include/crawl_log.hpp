@@ -0,0 +1,74 @@
+#pragma once
+
+#include "logger.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Журнал состояния обхода для продолжения после остановки или сбоя
+//
+// Журнал — файл, в который только дописываются записи: «URL добавлен в очередь» (URL и глубина) и «страница
+// обработана» (отпечаток URL). Потоки краулера лишь кладут записи в буфер в памяти; отдельный поток раз в
+// checkpoint_interval_ms дописывает накопленное в файл, поэтому запись на диск не задерживает обход.
+// Запись «обработана» попадает в журнал после записей о ссылках страницы, поэтому любой сохранённый префикс
+// журнала согласован: обработанная страница не теряет найденных ссылок. Проиндексированная страница отмечается
+// обработанной только после записи в базу данных и сегмент индекса, поэтому после сбоя она загружается заново.
+//
+// При открытии журнал воспроизводится: отпечатки всех встречавшихся URL и необработанные URL с глубиной
+// передаются обработчикам, а файл переписывается в сжатом виде (обработанные URL — только отпечатками).
+// Недописанная при сбое последняя запись отбрасывается.
+class CrawlLog {
+public:
+    // Обработчик отпечатка уже встречавшегося (обработанного) URL
+    using SeenCallback = std::function<void(uint64_t fingerprint)>;
+
+    // Обработчик URL, который ещё не обработан
+    using PendingCallback = std::function<void(std::string url, int depth)>;
+
+    // path — файл журнала, interval — период записи буфера на диск
+    CrawlLog(std::string path, std::chrono::milliseconds interval, Logger& logger);
+
+    // Деструктор, который записывает оставшиеся записи
+    ~CrawlLog();
+
+    CrawlLog(const CrawlLog&) = delete;
+    CrawlLog& operator=(const CrawlLog&) = delete;
+
+    // Метод для воспроизведения и сжатия журнала и запуска потока записи
+    // Возвращает число необработанных URL
+    size_t open(const SeenCallback& onSeen, const PendingCallback& onPending);
+
+    // Методы для добавления записей (потокобезопасны, на диск попадают с очередной записью буфера)
+    void added(const std::string& url, int depth, uint64_t fingerprint);
+    void done(uint64_t fingerprint);
+
+    // Метод для остановки потока записи с записью оставшегося буфера
+    // discard — обход завершён полностью, журнал удаляется (следующий запуск начнёт обход заново)
+    void close(bool discard);
+
+private:
+    // Цикл потока записи
+    void flushLoop();
+
+    // Запись накопленного буфера в файл
+    void flush();
+
+    std::string path;                       // Файл журнала
+    std::chrono::milliseconds interval;     // Период записи буфера на диск
+    Logger& logger;                         // Логер для записи логов
+
+    std::ofstream out;                      // Открытый на дописывание журнал
+    std::mutex fileMutex;                   // Защищает out
+
+    std::mutex mutex;                       // Защищает буфер и флаг остановки
+    std::condition_variable stopCv;         // Оповещение потока записи об остановке
+    std::string buffer;                     // Записи, ещё не записанные в файл
+    bool stopping = false;
+    std::thread flusher;                    // Поток записи буфера
+};
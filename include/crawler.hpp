@@ -1,54 +1,92 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
-#include <queue>
-#include <mutex>
-#include <thread>
-#include <future>
 #include <atomic>
+#include <cstdint>
+#include <unordered_map>
 #include "config.hpp"
 #include "logger.hpp"
 #include "database.hpp"
+#include "ingest_queue.hpp"
+#include "indexer.hpp"
+#include "fetch_engine.hpp"
+#include "frontier.hpp"
+#include "simhash_index.hpp"
 
-//     ( ),      
+// Класс для реализации краулера (поискового робота), который будет собирать страницы с сайтов
 class Crawler {
 public:
-    // ,    , ,     
+    // Конструктор, инициализирует краулер с конфигурацией, логером, базой данных и флагом работы
     explicit Crawler(const Config& config, Logger& logger, Database& db, std::atomic<bool>& running);
 
-    //     
+    // Метод для запуска работы краулера
     void start();
 
 private:
-    //       URL
-    std::string fetchPage(const std::string& url);
+    // Метод потока-диспетчера: берёт URL из своих (или чужих) очередей хостов и передаёт движку загрузки
+    void dispatch(FetchEngine& engine, size_t worker);
 
-    //        
-    std::vector<std::string> extractLinks(const std::string& html, const std::string& baseUrl);
+    // Метод для обработки загруженной страницы: индексация и постановка найденных ссылок в очередь
+    // Возвращает true, если страница передана на запись (в журнал обхода она попадёт после сохранения)
+    bool processPage(const std::string& url, int depth, FetchEngine::Result& result);
 
-    //     (    )
-    void indexPage(const std::string& url, const std::string& content);
+    // Метод для загрузки состояния страниц, сохранённых прошлыми обходами (для условных запросов)
+    // enqueue — поставить страницы в очередь (новый обход, а не продолжение прерванного)
+    void loadPageStates(bool enqueue);
 
-    //    
+    // Метод для получения сохранённого состояния страницы (nullptr — страница не сохранялась)
+    const PageState* knownPage(const std::string& url) const;
+
+    // Метод для вывода в лог счётчиков соединений движка загрузки
+    void logFetchStats(const FetchEngine::Stats& stats) const;
+
+    // Метод для вывода в лог счётчиков очередей обхода
+    void logFrontierStats(const Frontier::Stats& stats) const;
+
+    // Метод для добавления ссылки со страницы в список (только http(s) и относительные от корня)
+    static void collectLink(std::string_view href, const std::string& baseUrl, std::vector<std::string>& links);
+
+    // Метод для индексации страницы (сохранение информации в базу данных)
+    // Возвращает ссылки страницы, если wantLinks: слова и ссылки извлекаются за один проход, ссылки
+    // разрешаются от URL после перенаправлений. Почти дубликаты уже сохранённых страниц не сохраняются,
+    // страница с тем же содержимым, что при прошлом обходе, не индексируется заново
+    // queued — страница передана очереди записи
+    std::vector<std::string> indexPage(const std::string& url, int depth, const FetchEngine::Result& result,
+        bool wantLinks, bool& queued);
+
+    // Ссылка на объект конфигурации
     const Config& config;
 
-    //       
+    // Ссылка на объект логера для записи логов
     Logger& logger;
 
-    //        
+    // Ссылка на объект базы данных для хранения данных
     Database& db;
 
-    //       URL
-    std::mutex queueMutex;
+    // Очередь отложенной записи проиндексированных страниц в базу данных
+    IngestQueue ingest;
+
+    // Индексатор, общий для всех потоков (стоп-слова загружаются один раз)
+    Indexer indexer;
+
+    // Отпечатки SimHash сохранённых страниц для пропуска почти дубликатов
+    SimHashIndex nearDuplicates;
+
+    // Число пропущенных почти дубликатов
+    std::atomic<uint64_t> nearDuplicatesSkipped{ 0 };
+
+    // Состояние страниц, сохранённых прошлыми обходами, по отпечатку URL (во время обхода только читается)
+    std::unordered_map<uint64_t, PageState> knownPages;
 
-    //    URL-    
-    std::queue<std::pair<std::string, int>> urlQueue;
+    // Число сохранённых страниц, которые не изменились: ответ 304 и тот же хэш содержимого
+    std::atomic<uint64_t> notModified{ 0 };
+    std::atomic<uint64_t> unchangedContent{ 0 };
 
-    //   ,     
+    // Ссылка на флаг, который управляет состоянием работы краулера
     std::atomic<bool>& running;
 
-    //   URL-    
-    std::unordered_set<std::string> visited;
+    // Очереди URL по хостам и множество посещённых URL-ов
+    Frontier frontier;
 };
@@ -2,12 +2,40 @@
 
 #include "config.hpp"
 #include "logger.hpp"
+#include "connection_pool.hpp"
+#include "search_page.hpp"
 
 #include <pqxx/pqxx>  // Библиотека для работы с PostgreSQL
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
+// Проиндексированная страница, подготовленная к записи в базу данных
+struct Document {
+    std::string url;                             // URL страницы
+    std::unordered_map<std::string, int> words;  // Частоты слов страницы
+    int depth = 0;                               // Глубина страницы при обходе
+    std::string etag;                            // Заголовок ETag ответа (пусто — не было)
+    std::string lastModified;                    // Заголовок Last-Modified ответа (пусто — не было)
+    uint64_t contentHash = 0;                    // Хэш тела страницы
+    uint64_t simhash = 0;                        // Отпечаток SimHash слов страницы (0 — не вычислялся)
+    std::vector<std::string> links;              // Ссылки страницы (для повторного обхода после ответа 304)
+};
+
+// Сохранённое состояние страницы для повторного обхода (условный запрос и сравнение содержимого)
+struct PageState {
+    int depth = 0;                // Глубина страницы при прошлом обходе (0 — неизвестна)
+    std::string etag;             // ETag прошлого ответа (пусто — не было)
+    std::string lastModified;     // Last-Modified прошлого ответа (пусто — не было)
+    uint64_t contentHash = 0;     // Хэш тела страницы при прошлом обходе
+    uint64_t simhash = 0;         // Отпечаток SimHash слов страницы (0 — нет)
+    bool linksStored = false;     // Ссылки страницы сохранены (иначе страница загружается без условного запроса)
+};
+
 // Класс для работы с базой данных, включая создание таблиц, сохранение документов и выполнение поиска
 class Database {
 public:
@@ -17,13 +45,78 @@ public:
     // Метод для создания таблиц в базе данных
     void init();
 
-    // Метод для сохранения документа в базе данных с URL и частотами слов
-    void saveDocument(const std::string& url, const std::unordered_map<std::string, int>& words);
+    // Метод для сохранения документа в базе данных: записываются только изменившиеся записи индекса
+    // Ошибка записи страницы записывается в лог; pqxx::broken_connection (база данных недоступна и после
+    // переподключения) передаётся вызывающему
+    void saveDocument(const Document& document);
+
+    // Метод для сохранения пачки документов в одной транзакции (групповая фиксация)
+    // Ошибки — как у saveDocument: недоступность базы данных передаётся вызывающему, который повторяет пачку
+    void saveDocuments(const std::vector<Document>& documents);
 
     // Метод для выполнения поиска по запросу (список слов) в базе данных
-    std::vector<std::pair<std::string, int>> search(const std::vector<std::string>& queryWords);
+    // Страницы ранжируются по BM25 и возвращаются с оценкой; cursor — nextCursor предыдущей страницы
+    // Некорректный курсор — std::invalid_argument
+    SearchPage search(const std::vector<std::string>& queryWords, size_t limit = 10, size_t offset = 0,
+        const std::string& cursor = {});
+
+    // Метод для потоковой выгрузки всего корпуса (используется при построении индекса в памяти)
+    // Страницы, слова и записи индекса читаются из одного снимка базы данных в указанном порядке
+    void scanCorpus(const std::function<void(int pageId, std::string_view url)>& onPage,
+        const std::function<void(int wordId, std::string_view word)>& onWord,
+        const std::function<void(int wordId, int pageId, int frequency)>& onPosting);
+
+    // Метод для потоковой выгрузки состояния сохранённых страниц (используется краулером при повторном обходе)
+    void scanPageStates(const std::function<void(std::string_view url, const PageState& state)>& onPage);
+
+    // Метод для получения сохранённых ссылок страницы (ссылки страницы, ответившей 304, снова ставятся в очередь)
+    std::vector<std::string> pageLinks(const std::string& url);
+
+    // Метод для обновления состояния страницы, содержимое которой не изменилось: новые ETag и Last-Modified
+    // и ссылки страницы; записи индекса и версия корпуса не меняются
+    void updatePageState(const std::string& url, const std::string& etag, const std::string& lastModified,
+        const std::vector<std::string>& links);
+
+    // Метод для получения версии корпуса: растёт с каждой зафиксированной записью страниц
+    long long corpusVersion();
+
+    // Метод для записи в лог счётчиков пула соединений
+    void logPoolStats();
+
+    // Текст поискового запроса: $1 — слова (text[]), $2 и $3 — параметры BM25 k1 и b,
+    // $4 и $5 — LIMIT и OFFSET, $6 и $7 — курсор (оценка текстом и URL) или NULL
+    static const char* const searchQuery;
+
+    // Методы для курсора постраничного поиска (общие с AsyncDatabase)
+    static std::string encodeCursor(const std::string& score, const std::string& url);
+    static bool decodeCursor(const std::string& cursor, std::string& score, std::string& url);
 
 private:
-    pqxx::connection connection;  // Соединение с базой данных PostgreSQL
+    // Изменения статистики BM25, накопленные за транзакцию
+    struct StatsDelta {
+        std::map<int, int> docFreq;   // ID слова -> изменение документной частоты (упорядочено для блокировок)
+        long long documents = 0;      // Изменение числа страниц
+        long long totalLength = 0;    // Изменение суммы длин страниц
+    };
+
+    // Регистрирует подготовленные запросы на соединении (вызывается пулом для каждого нового соединения)
+    static void prepareStatements(pqxx::connection& connection);
+
+    // Выполняет work в транзакции на соединении из пула и фиксирует её, если work вернул true. Оборванное
+    // соединение (pqxx::broken_connection, например после перезапуска PostgreSQL) отбрасывается, и транзакция
+    // один раз повторяется на новом; повторный обрыв передаётся вызывающему
+    void runTransaction(const std::function<bool(pqxx::work&)>& work);
+
+    // Вставляет новые слова всех страниц пачки одним запросом в едином порядке (вызывается до writeDocument)
+    void insertWords(pqxx::work& txn, const std::vector<const Document*>& documents);
+
+    // Записывает страницу и её слова в рамках уже открытой транзакции, возвращает false, если ID страницы не получен
+    // Изменения длины страницы и документных частот слов добавляются в stats
+    bool writeDocument(pqxx::work& txn, const Document& document, StatsDelta& stats);
+
+    // Применяет накопленные изменения статистики BM25 в рамках открытой транзакции
+    void applyStats(pqxx::work& txn, const StatsDelta& stats);
+
     Logger& logger;               // Логер для записи логов
+    ConnectionPool pool;          // Пул соединений с базой данных PostgreSQL
 };
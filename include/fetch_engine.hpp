@@ -0,0 +1,170 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Асинхронная загрузка страниц для краулера
+//
+// Все запросы выполняются сопрограммами на одном io_context с небольшим числом потоков: пока страница
+// скачивается, поток обслуживает другие запросы, поэтому одновременно в полёте могут быть тысячи загрузок.
+// Число одновременных загрузок ограничено max_in_flight; контекст TLS создаётся один раз на весь движок.
+//
+// Соединения не закрываются после ответа (HTTP/1.1 keep-alive), а возвращаются в пул своего хоста и
+// используются следующими запросами к нему; простаивающие дольше keep_alive_seconds закрываются.
+// Для хоста запоминаются адреса DNS и сессия TLS, поэтому новое соединение к нему обходится без
+// разрешения имени и с сокращённым рукопожатием.
+//
+// Если для страницы известны ETag или Last-Modified прошлого ответа, запрос делается условным
+// (If-None-Match, If-Modified-Since): неизменившаяся страница возвращается статусом 304 без тела.
+class FetchEngine {
+public:
+    // Валидаторы прошлого ответа для условного запроса (пустые — заголовок не отправляется)
+    struct Validators {
+        std::string etag;           // Значение ETag
+        std::string lastModified;   // Значение Last-Modified
+    };
+
+    // Результат загрузки страницы
+    struct Result {
+        std::string url;        // Итоговый URL (после перенаправлений)
+        unsigned status = 0;    // Код ответа HTTP (0 — ответ не получен, 304 — страница не изменилась)
+        std::string body;       // Тело ответа (только при статусе 200)
+        std::string error;      // Описание ошибки (пусто — страница загружена или не изменилась)
+        Validators validators;  // ETag и Last-Modified ответа (только при статусе 200)
+    };
+
+    // Обработчик завершения загрузки; вызывается в пуле обработчиков, а не в потоках io_context
+    using Callback = std::function<void(Result&)>;
+
+    // Счётчики соединений
+    struct Stats {
+        uint64_t requests = 0;          // HTTP-запросы (каждое перенаправление — отдельный запрос)
+        uint64_t reused = 0;            // Запросы по соединению из пула
+        uint64_t connections = 0;       // Открытые соединения
+        uint64_t tlsHandshakes = 0;     // Рукопожатия TLS
+        uint64_t tlsResumed = 0;        // Из них с возобновлением сессии
+        uint64_t connectMicros = 0;     // Суммарное время установки TCP-соединений
+        uint64_t handshakeMicros = 0;   // Суммарное время рукопожатий TLS
+    };
+
+    // Конструктор, который берёт таймаут, число потоков загрузки и обработки и ограничение загрузок из конфигурации
+    // и запускает потоки
+    FetchEngine(const Config& config, Logger& logger);
+
+    // Деструктор, который дожидается завершения всех начатых загрузок
+    ~FetchEngine();
+
+    FetchEngine(const FetchEngine&) = delete;
+    FetchEngine& operator=(const FetchEngine&) = delete;
+
+    // Метод для запуска загрузки страницы; блокирует вызывающий поток, пока в полёте max_in_flight загрузок
+    // validators — валидаторы прошлого ответа для условного запроса
+    void fetch(std::string url, Callback callback, Validators validators = {});
+
+    // Метод для остановки: дожидается завершения начатых загрузок, закрывает соединения и останавливает потоки
+    void stop();
+
+    // Метод для получения счётчиков соединений
+    Stats stats() const;
+
+private:
+    // Открытое соединение (TCP или TLS) со своим буфером чтения
+    struct Connection;
+
+    // Составные части URL, нужные для запроса
+    struct Target;
+
+    // Состояние хоста: свободные соединения, адреса и сессия TLS для новых соединений
+    struct Host {
+        std::vector<std::unique_ptr<Connection>> idle;       // Свободные соединения (последнее — самое свежее)
+        boost::asio::ip::tcp::resolver::results_type endpoints; // Адреса хоста (пусто — не разрешены)
+        std::chrono::steady_clock::time_point resolvedAt;    // Время разрешения имени
+        std::vector<std::shared_ptr<SSL_SESSION>> sessions;  // Сессии TLS для возобновления (каждая — одному соединению)
+    };
+
+    // Разбор URL на схему, хост, порт и путь
+    static Target parseUrl(const std::string& url);
+
+    // Загрузка страницы с переходом по перенаправлениям
+    boost::asio::awaitable<Result> get(std::string url, Validators validators);
+
+    // Один HTTP(S)-запрос без перенаправлений; заполняет статус, тело, валидаторы и адрес перенаправления
+    boost::asio::awaitable<void> request(const std::string& url, const Validators& validators, Result& result,
+        std::string& location, std::chrono::steady_clock::time_point deadline);
+
+    // Открытие нового соединения к хосту (с разрешением имени, если адреса не запомнены)
+    // Запускается на новом strand, к которому привязывается сокет соединения
+    boost::asio::awaitable<std::unique_ptr<Connection>> connect(const Target& target,
+        std::chrono::steady_clock::time_point deadline);
+
+    // Запрос и ответ по открытому соединению (запускается на strand соединения)
+    // Возвращает true, если соединение можно использовать для следующего запроса
+    boost::asio::awaitable<bool> transfer(Connection& connection, const Target& target, const Validators& validators,
+        Result& result, std::string& location, std::chrono::steady_clock::time_point deadline);
+
+    // Разрешение имени хоста с учётом запомненных адресов
+    boost::asio::awaitable<boost::asio::ip::tcp::resolver::results_type> resolve(const Target& target,
+        std::chrono::steady_clock::time_point deadline);
+
+    // Выдача свободного соединения из пула (nullptr — свободных нет) и возврат соединения в пул
+    std::unique_ptr<Connection> takeIdle(const std::string& key);
+    void release(const std::string& key, std::unique_ptr<Connection> connection);
+
+    // Закрытие соединений, простаивающих дольше keep_alive_seconds (вызывается под poolMutex)
+    void evictIdle(std::chrono::steady_clock::time_point now);
+
+    // Сопрограмма периодического закрытия простаивающих соединений
+    boost::asio::awaitable<void> sweep();
+
+    // Сопрограмма одной загрузки: выполняет запрос и передаёт результат обработчику в пул обработчиков,
+    // место освобождается после завершения обработчика
+    boost::asio::awaitable<void> run(std::string url, Validators validators, Callback callback);
+
+    Logger& logger;                             // Логер для записи логов
+    std::chrono::milliseconds timeout;          // Таймаут загрузки страницы целиком (с перенаправлениями)
+    size_t maxInFlight;                         // Максимальное число одновременных загрузок
+    std::chrono::seconds keepAlive;             // Время простоя, после которого соединение закрывается
+    size_t maxIdlePerHost;                      // Максимальное число свободных соединений одного хоста
+
+    boost::asio::io_context ioc;                // Общий io_context всех загрузок
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work; // Не даёт io_context завершиться
+    boost::asio::ssl::context sslContext;       // Общий контекст TLS (сертификаты читаются один раз)
+    boost::asio::steady_timer sweepTimer;       // Таймер закрытия простаивающих соединений (на своём strand)
+    std::vector<std::thread> threads;           // Потоки, выполняющие io_context
+    boost::asio::thread_pool handlers;          // Пул обработчиков: индексация и ожидание очереди записи не занимают io_context
+
+    std::mutex mutex;                           // Защищает счётчик ниже
+    std::condition_variable slotFreed;          // Оповещение об освободившемся месте
+    size_t inFlight = 0;                        // Число загрузок в полёте
+
+    std::mutex poolMutex;                       // Защищает состояние хостов
+    std::unordered_map<std::string, Host> hosts; // Состояние хостов по ключу схема://хост:порт
+    bool stopping = false;                      // Движок останавливается (под poolMutex)
+
+    std::atomic<uint64_t> requests{ 0 };
+    std::atomic<uint64_t> reused{ 0 };
+    std::atomic<uint64_t> connections{ 0 };
+    std::atomic<uint64_t> tlsHandshakes{ 0 };
+    std::atomic<uint64_t> tlsResumed{ 0 };
+    std::atomic<uint64_t> connectMicros{ 0 };
+    std::atomic<uint64_t> handshakeMicros{ 0 };
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "crawl_log.hpp"
+#include "seen_set.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Граница обхода краулера: очереди URL по хостам, планировщик с учётом вежливости и множество посещённых URL
+//
+// Хосты распределены по шардам со своими мьютексами: у каждого хоста своя очередь FIFO, а шард держит кучу
+// хостов, упорядоченную по времени, когда хост можно загружать снова. Хост не получает больше max_per_host
+// одновременных загрузок, и соседние загрузки одного хоста начинаются не чаще раза в host_delay_ms, поэтому
+// разные хосты обходятся параллельно, а один хост не перегружается.
+//
+// URL раздают несколько потоков-диспетчеров. У каждого свои шарды; если в них нет готовых хостов, диспетчер
+// забирает работу из чужих шардов. Посещённые URL хранятся отпечатками (SeenSet) в пределах seen_memory_mb;
+// множество разбито на полосы со своими мьютексами, поэтому проверка ссылок из разных потоков почти не
+// конкурирует. Захваты мьютексов считаются: stats() показывает,
+// какая их доля пришлась на занятый мьютекс.
+//
+// Если задан state_file, добавленные и обработанные URL записываются в журнал (CrawlLog), и resume()
+// восстанавливает по нему очереди и посещённые URL прерванного обхода.
+class Frontier {
+public:
+    // Задача загрузки: URL и его глубина
+    struct Task {
+        std::string url;
+        int depth = 0;
+    };
+
+    // Счётчики границы обхода
+    struct Stats {
+        size_t queued = 0;              // URL в очередях хостов
+        size_t maxQueued = 0;           // Наибольшая длина очередей за обход
+        size_t inFlight = 0;            // Выданные и ещё не завершённые задачи
+        size_t hosts = 0;               // Известные хосты
+        size_t visited = 0;             // Посещённые URL
+        size_t visitedBytes = 0;        // Память множества посещённых URL
+        uint64_t visitedDropped = 0;    // URL, пропущенные из-за исчерпания бюджета памяти множества
+        uint64_t dispatched = 0;        // Выданные задачи
+        uint64_t stolen = 0;            // Из них взятые из чужих шардов
+        uint64_t idleWaits = 0;         // Ожидания диспетчеров без готовых хостов
+        uint64_t lockAcquisitions = 0;  // Захваты мьютексов шардов и полос
+        uint64_t lockContended = 0;     // Из них пришлось ждать освобождения
+    };
+
+    // Конструктор, который берёт число шардов, диспетчеров, ограничения хоста и бюджет множества посещённых URL
+    // из конфигурации
+    Frontier(const Config& config, Logger& logger, std::atomic<bool>& running);
+
+    Frontier(const Frontier&) = delete;
+    Frontier& operator=(const Frontier&) = delete;
+
+    // Метод для восстановления состояния прерванного обхода из журнала; возвращает число URL в очередях
+    size_t resume();
+
+    // Метод для закрытия журнала по окончании обхода: журнал полностью завершённого обхода удаляется
+    void finish();
+
+    // Метод для добавления URL: отмечает его посещённым и ставит в очередь хоста
+    // Возвращает false, если URL уже встречался (или принят за встречавшийся, см. SeenSet)
+    bool add(std::string url, int depth);
+
+    // Метод для получения следующей задачи диспетчером worker (0..dispatchers()-1)
+    // Ждёт, пока какой-нибудь хост не станет готов; false — обход завершён или остановлен
+    bool next(size_t worker, Task& task);
+
+    // Метод для завершения задачи (после обработки страницы и добавления её ссылок)
+    // pendingWrite — страница передана на запись: в журнал она попадёт обработанной только после сохранения
+    // (stored), иначе после сбоя продолжение обхода не загрузило бы её заново
+    void done(const std::string& url, bool pendingWrite = false);
+
+    // Метод для отметки в журнале страницы, сохранённой в базе данных и сегменте индекса
+    void stored(const std::string& url);
+
+    // Метод для ожидания завершения обхода не дольше timeout; true — все задачи выполнены или обход остановлен
+    bool waitFinished(std::chrono::milliseconds timeout);
+
+    // Количество потоков-диспетчеров
+    size_t dispatchers() const { return workerCount; }
+
+    // Снимок счётчиков
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Состояние хоста: очередь URL, время следующей загрузки и число загрузок в полёте
+    struct Host {
+        std::deque<Task> queue;
+        Clock::time_point nextAllowed;
+        size_t inFlight = 0;
+        bool scheduled = false;     // Хост находится в куче готовности шарда
+    };
+
+    // Хост в куче готовности: раньше всех выходит тот, кого можно загружать раньше
+    struct Ready {
+        Clock::time_point at;
+        Host* host;                 // Узлы unordered_map не перемещаются
+        bool operator>(const Ready& other) const { return at > other.at; }
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Host> hosts;    // Хосты по ключу схема://хост:порт
+        std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready;
+        std::atomic<size_t> queued{ 0 };                // URL в очередях шарда (меняется под мьютексом)
+    };
+
+    struct alignas(64) Stripe {
+        Stripe(size_t memoryBudget, double falsePositiveRate) : urls(memoryBudget, falsePositiveRate) {}
+
+        mutable std::mutex mutex;
+        SeenSet urls;
+    };
+
+    // Постановка URL в очередь хоста (без проверки посещённых)
+    void enqueue(std::string url, int depth);
+
+    // Ключ хоста URL (схема://хост:порт в нижнем регистре)
+    static std::string hostKey(const std::string& url);
+
+    Shard& shardFor(const std::string& key);
+
+    // Захват мьютекса с подсчётом ожиданий
+    std::unique_lock<std::mutex> lockCounted(std::mutex& mutex);
+
+    // Постановка хоста в кучу готовности, если у него есть URL и свободное место (мьютекс шарда захвачен)
+    void schedule(Shard& shard, Host& host);
+
+    // Попытка взять задачу из шарда; wake уменьшается до времени, когда хост шарда станет готов
+    bool take(Shard& shard, Task& task, Clock::time_point now, Clock::time_point& wake);
+
+    // Оповещение ждущих диспетчеров об изменении очередей
+    void wakeUp(bool all);
+
+    std::atomic<bool>& running;     // Флаг работы краулера
+    size_t workerCount;             // Количество диспетчеров
+    size_t maxPerHost;              // Наибольшее число одновременных загрузок хоста
+    std::chrono::milliseconds hostDelay; // Интервал между началами загрузок одного хоста
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<std::unique_ptr<Stripe>> stripes;
+    std::unique_ptr<CrawlLog> log;          // Журнал состояния обхода (nullptr — не ведётся)
+
+    std::atomic<size_t> outstanding{ 0 };   // URL в очередях и в полёте (0 — обход завершён)
+    std::atomic<size_t> queued{ 0 };
+    std::atomic<size_t> maxQueued{ 0 };
+    std::atomic<uint64_t> version{ 0 };     // Меняется при каждом изменении очередей
+    std::atomic<size_t> sleepers{ 0 };      // Диспетчеры, ждущие на wakeCv
+    std::mutex waitMutex;
+    std::condition_variable wakeCv;         // Оповещение диспетчеров
+    std::condition_variable finishedCv;     // Оповещение о завершении обхода
+
+    std::atomic<uint64_t> dispatched{ 0 };
+    std::atomic<uint64_t> stolen{ 0 };
+    std::atomic<uint64_t> idleWaits{ 0 };
+    std::atomic<uint64_t> lockAcquisitions{ 0 };
+    std::atomic<uint64_t> lockContended{ 0 };
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Однопроходный разбор HTML: слова видимого текста и ссылки <a href> за один просмотр страницы
+//
+// Теги, комментарии и объявления (<!DOCTYPE>, <?xml?>) разделяют слова и в текст не попадают, содержимое
+// <script> и <style> пропускается целиком. Слова разделяются пробельными символами, знаками препинания ASCII
+// и типографскими знаками Юникода (неразрывный пробел, кавычки-ёлочки, тире, многоточие). Сущности
+// (&amp;, &nbsp;, &#1087;, &#x43F;) декодируются и в тексте, и в значениях href.
+//
+// Слова и ссылки передаются обработчикам как string_view: на саму страницу или, если внутри были сущности,
+// на буфер токенизатора. Они действительны только до возврата из обработчика. Буферы переиспользуются,
+// поэтому повторный разбор тем же объектом память не выделяет.
+class HtmlTokenizer {
+public:
+    // Обработчик слова или ссылки; пустой обработчик — слова (ссылки) не нужны
+    using Callback = std::function<void(std::string_view)>;
+
+    // Метод для разбора страницы: onText получает слова видимого текста, onLink — значения href ссылок <a>
+    void scan(std::string_view html, const Callback& onText, const Callback& onLink);
+
+    // Метод для декодирования сущности, начинающейся с '&' в позиции pos, с дописыванием UTF-8 в out
+    // Возвращает длину сущности (0 — не сущность, '&' остаётся обычным символом)
+    static size_t decodeEntity(std::string_view input, size_t pos, std::string& out);
+
+private:
+    // Разбор тега, начинающегося с '<' в позиции pos; возвращает позицию после тега
+    size_t scanTag(std::string_view html, size_t pos, const Callback& onLink);
+
+    // Передача накопленного слова обработчику
+    void flushWord(std::string_view html, size_t end, const Callback& onText);
+
+    size_t wordStart = std::string_view::npos; // Начало текущего слова в странице (npos — слова нет)
+    bool copying = false;       // Слово содержит сущности и собирается в word
+    std::string word;           // Слово с декодированными сущностями
+    std::string link;           // Значение href с декодированными сущностями
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "logger.hpp"
+#include "segmented_body.hpp"
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+// Асинхронная HTTP-сессия одного соединения
+//
+// Сессия — сопрограмма на strand соединения: чтение, обработка и запись идут последовательно через co_await,
+// а обработчик сам может ждать (например, ответа базы данных), не занимая поток сервера.
+// Запросы читаются и обрабатываются по одному: следующий читается только после отправки ответа на текущий,
+// поэтому конвейерные (pipelined) запросы клиента, уже лежащие в буфере, получают ответы в порядке поступления.
+// Соединение остаётся открытым, пока клиент просит keep-alive; на каждое чтение и запись действует таймаут,
+// так что медленный или молчащий клиент не держит ни поток, ни соединение дольше него.
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+public:
+    using Request = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<SegmentedBody>;
+
+    // Обработчик запроса: сопрограмма, получает запрос и адрес клиента, возвращает готовый ответ
+    using Handler = std::function<boost::asio::awaitable<Response>(const Request&, const boost::asio::ip::tcp::endpoint&)>;
+
+    // handler должен жить дольше сессии (принадлежит серверу)
+    HttpSession(boost::asio::ip::tcp::socket socket, const Handler& handler, std::chrono::seconds timeout, Logger& logger);
+
+    // Метод для запуска сопрограммы сессии на исполнителе сокета
+    void start();
+
+private:
+    // Цикл чтения запросов и отправки ответов; self держит сессию до выхода из сопрограммы
+    boost::asio::awaitable<void> run(std::shared_ptr<HttpSession> self);
+
+    // Ответ 500 на исключение в обработчике
+    Response internalError() const;
+
+    void close();
+
+    boost::beast::tcp_stream stream;       // Сокет с таймаутами
+    boost::beast::flat_buffer buffer;      // Буфер чтения (сохраняет данные следующих конвейерных запросов)
+    Request request;                       // Текущий запрос
+    const Handler& handler;                // Обработчик запросов сервера
+    std::chrono::seconds timeout;          // Таймаут чтения и записи
+    boost::asio::ip::tcp::endpoint remote; // Адрес клиента
+    Logger& logger;                        // Логер для записи ошибок
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Неизменяемый сегмент индекса: словарь, списки словопозиций (PostingCodec) и таблица документов
+//
+// Файл сегмента (порядок байт процессора, все смещения — от начала файла):
+//   Header
+//   таблица документов: DocEntry[docCount + 1] (последняя запись — конец данных URL)
+//   данные URL
+//   словарь: TermEntry[termCount], отсортирован по слову
+//   данные слов
+//   списки словопозиций + PostingCodec::kPadding нулевых байт
+// Сегмент открывается через mmap; при открытии проверяются таблицы и структура списков словопозиций (заголовки
+// и управляющие байты блоков), сами словопозиции подгружает кэш страниц ОС при поиске.
+class IndexSegment {
+public:
+    // Поколение сегмента: более новые сегменты перекрывают документы с тем же URL в более старых
+    struct Generation {
+        uint64_t value = 0;  // Время создания исходных данных (микросекунды)
+        uint32_t level = 0;  // Уровень слияния (0 — сегмент, записанный напрямую)
+        uint64_t first = 0;  // Наименьшее поколение среди слитых сегментов (для level 0 совпадает с value)
+
+        bool operator<(const Generation& other) const {
+            return value != other.value ? value < other.value : level < other.level;
+        }
+    };
+
+    // Открывает файл сегмента и отображает его в память; при повреждённом файле бросает std::runtime_error
+    static std::shared_ptr<IndexSegment> open(const std::string& path);
+
+    // Создаёт сегмент поверх байтов, собранных SegmentBuilder (без файла)
+    static std::shared_ptr<IndexSegment> fromBuffer(std::vector<uint8_t> bytes);
+
+    // Деструктор удаляет файл сегмента, если сегмент был заменён слиянием
+    ~IndexSegment();
+
+    IndexSegment(const IndexSegment&) = delete;
+    IndexSegment& operator=(const IndexSegment&) = delete;
+
+    uint32_t documentCount() const { return docCount; }
+    uint32_t termCount() const { return termsCount; }
+    const Generation& generation() const { return gen; }
+    const std::string& path() const { return filePath; }
+    size_t sizeBytes() const { return size; }
+
+    // Сумма длин всех документов сегмента (для средней длины документа в BM25)
+    uint64_t totalLength() const { return lengthSum; }
+
+    // URL и длина (сумма частот слов) документа; для номера вне таблицы документов — пустая строка и 0
+    std::string_view url(uint32_t doc) const;
+    uint32_t documentLength(uint32_t doc) const;
+
+    // Описание слова в словаре
+    struct Term {
+        std::string_view text;     // Слово
+        const uint8_t* postings;   // Начало списка словопозиций
+        uint32_t docFreq;          // Количество документов со словом
+        uint32_t maxFreq;          // Максимальная частота слова в одном документе
+        uint32_t minLength;        // Минимальная длина документа, содержащего слово
+    };
+
+    // Поиск слова двоичным поиском по словарю; возвращает false, если слова нет
+    bool find(std::string_view word, Term& term) const;
+
+    // Слово по номеру в словаре (для последовательного обхода при слиянии)
+    Term termAt(uint32_t i) const;
+
+    // Пометка сегмента как заменённого: файл будет удалён, когда сегмент перестанут использовать
+    void markObsolete() { obsolete = true; }
+
+private:
+    IndexSegment() = default;
+
+    // Проверяет заголовок и границы разделов, заполняет поля
+    void attach(const uint8_t* bytes, size_t length);
+
+    boost::interprocess::file_mapping mapping;  // Отображаемый файл
+    boost::interprocess::mapped_region region;  // Отображённая область
+    std::vector<uint8_t> buffer;                // Байты сегмента в памяти (если сегмент не из файла)
+
+    const uint8_t* base = nullptr;    // Начало данных сегмента
+    size_t size = 0;                  // Размер данных сегмента
+    std::string filePath;             // Путь к файлу (пустой для сегмента в памяти)
+    Generation gen;                   // Поколение сегмента
+    uint32_t docCount = 0;            // Количество документов
+    uint64_t lengthSum = 0;           // Сумма длин документов
+    uint32_t termsCount = 0;          // Количество слов
+    const uint8_t* docTable = nullptr;
+    const uint8_t* urlData = nullptr;
+    const uint8_t* termTable = nullptr;
+    const uint8_t* termData = nullptr;
+    const uint8_t* postingsData = nullptr;
+    std::atomic<bool> obsolete{ false };
+};
+
+// Построитель сегмента: накапливает документы и словопозиции и сериализует их в формат IndexSegment
+class SegmentBuilder {
+public:
+    // Добавляет документ и возвращает его номер в сегменте
+    uint32_t addDocument(std::string_view url, uint32_t length);
+
+    // Возвращает внутренний номер слова (добавляет слово при первом обращении)
+    uint32_t termId(std::string_view word);
+
+    // Добавляет словопозицию; порядок документов внутри слова может быть любым
+    void addPosting(uint32_t termId, uint32_t doc, uint32_t freq);
+
+    size_t documentCount() const { return urls.size(); }
+
+    // Сериализует сегмент с указанным поколением
+    std::vector<uint8_t> build(const IndexSegment::Generation& generation);
+
+    // Сериализует сегмент и атомарно записывает его в каталог (через временный файл); возвращает путь
+    std::string writeFile(const std::string& directory, const IndexSegment::Generation& generation);
+
+    // То же для нового сегмента уровня 0: поколение назначается непосредственно перед появлением файла,
+    // чтобы сегмент не оказался «старше» слияния, начавшегося, пока файл ещё записывался
+    std::string writeFile(const std::string& directory);
+
+    // Очищает построитель для следующего сегмента
+    void clear();
+
+    // Поколение для нового сегмента уровня 0 (текущее время в микросекундах)
+    static IndexSegment::Generation newGeneration();
+
+private:
+    // Записывает байты сегмента в каталог; если fresh == true, назначает поколение перед переименованием
+    std::string publishFile(const std::string& directory, std::vector<uint8_t> bytes,
+        IndexSegment::Generation generation, bool fresh);
+
+    std::vector<std::string> urls;                          // URL по номеру документа
+    std::vector<uint32_t> lengths;                          // Длины документов
+    std::unordered_map<std::string, uint32_t> termIds;      // Слово -> внутренний номер
+    std::vector<std::string> words;                         // Внутренний номер -> слово
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> lists; // Словопозиции по внутреннему номеру слова
+};
@@ -2,33 +2,41 @@
 
 #include "config.hpp"
 #include "logger.hpp"
+#include "html_tokenizer.hpp"
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 
-//    :     -
+// Класс для индексации документов: извлечение слов и обработка стоп-слов
+// Создаётся один раз на краулер: стоп-слова загружаются в конструкторе и дальше только читаются, поэтому
+// extractWords можно вызывать из нескольких потоков одновременно
 class Indexer {
 public:
-    // ,       
+    // Конструктор, который инициализирует индексатор с конфигурацией и логером
     Indexer(const Config& config, Logger& logger);
 
-    //      HTML     
-    std::unordered_map<std::string, int> extractWords(const std::string& html);
+    // Метод для извлечения слов из HTML контента и подсчета их частоты
+    // Если задан onLink, в том же проходе он получает значения href всех ссылок страницы
+    // Токенизатор и счётчик слов свои у каждого потока и переиспользуются между страницами
+    std::unordered_map<std::string, int> extractWords(const std::string& html,
+        const HtmlTokenizer::Callback& onLink = nullptr) const;
+
+    // Метод для приведения слова к нижнему регистру с записью в out
+    // ASCII и кириллица переводятся по таблице, остальные символы — через Boost.Locale (может бросить исключение)
+    static void toLower(std::string_view word, std::string& out);
 
 private:
-    //  -,      
+    // Множество стоп-слов, которые не будут учитываться при индексации
     std::unordered_set<std::string> stopwords;
 
-    // , ,    -
+    // Флаг, указывающий, нужно ли использовать стоп-слова
     bool useStopwords;
 
-    //       
+    // Ссылка на объект логера для записи логов
     Logger& logger;
 
-    //    - (,   )
+    // Метод для загрузки стоп-слов (например, из конфигурационного файла)
     void loadStopwords();
-
-    //    HTML      
-    std::string cleanHtml(const std::string& html);
 };
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "database.hpp"
+#include "index_segment.hpp"
+
+#include <chrono>
+#include <condition_variable>  // Для ожидания места/данных в очереди
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Очередь отложенной записи: краулер кладёт проиндексированные страницы, потоки записи сохраняют их пачками
+class IngestQueue {
+public:
+    // Функция, вызываемая для каждой страницы, когда она сохранена (в базе данных и в записанном сегменте)
+    using StoredCallback = std::function<void(const std::string& url)>;
+
+    // Конструктор, который берёт ёмкость очереди, размер пачки и интервал сброса из конфигурации
+    IngestQueue(const Config& config, Logger& logger, Database& db, StoredCallback onStored = nullptr);
+
+    // Деструктор, который дожидается записи всех оставшихся страниц
+    ~IngestQueue();
+
+    // Метод для запуска потоков записи
+    void start();
+
+    // Метод для постановки страницы в очередь; блокирует вызывающий поток, пока очередь заполнена
+    // Возвращает false, если очередь уже закрыта
+    bool push(Document document);
+
+    // Метод для закрытия очереди: потоки записи сохраняют всё оставшееся и завершаются
+    void stop();
+
+private:
+    // Цикл потока записи: набирает пачку и сохраняет её одной транзакцией
+    void writerLoop();
+
+    // Записывает пачку в базу данных с ограниченным числом повторов; false — пачка так и не сохранена
+    bool saveBatch(const std::vector<Document>& batch);
+
+    // Добавляет пачку в строящийся сегмент индекса и записывает сегмент, когда он набрал segmentFlushDocs документов
+    // saved — пачка сохранена в базе данных: о её страницах сообщается после записи сегмента
+    void appendToSegment(const std::vector<Document>& batch, bool saved);
+
+    // Записывает накопленный сегмент в каталог сегментов (вызывается под segmentMutex)
+    void flushSegment();
+
+    // Сообщает о сохранённых страницах функции onStored
+    void notifyStored(const std::vector<std::string>& urls);
+
+    // Ссылка на объект логера для записи логов
+    Logger& logger;
+
+    // Ссылка на объект базы данных для сохранения страниц
+    Database& db;
+
+    size_t capacity;                    // Максимальное число страниц в очереди
+    size_t batchSize;                   // Максимальное число страниц в одной транзакции
+    std::chrono::milliseconds flushInterval; // Максимальное время ожидания неполной пачки
+    int writersCount;                   // Количество потоков записи
+    bool writeDatabase;                 // Записывать ли страницы в базу данных
+    std::string segmentDir;             // Каталог сегментов (пустой — сегменты не пишутся)
+    size_t segmentFlushDocs;            // Число документов в одном сегменте
+
+    StoredCallback onStored;            // Функция, получающая сохранённые страницы
+
+    SegmentBuilder segment;             // Строящийся сегмент индекса
+    std::vector<std::string> segmentUrls; // Сохранённые в БД страницы строящегося сегмента
+    std::mutex segmentMutex;            // Мьютекс для доступа к строящемуся сегменту
+
+    std::deque<Document> queue;         // Страницы, ожидающие записи
+    std::mutex queueMutex;              // Мьютекс для доступа к очереди
+    std::condition_variable notFull;    // Сигнал производителям: в очереди появилось место
+    std::condition_variable notEmpty;   // Сигнал потокам записи: в очереди появились страницы
+    bool closed = false;                // Флаг закрытия очереди
+
+    std::vector<std::thread> writers;   // Потоки записи
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "database.hpp"
+#include "index_segment.hpp"
+#include "latency_histogram.hpp"
+#include "search_page.hpp"
+#include "top_k_evaluator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Инвертированный индекс в памяти: набор неизменяемых сегментов, отвечающий на запросы без обращения к базе данных
+class InvertedIndex {
+public:
+    // Результат загрузки: снимок подменён или загрузка не начата, потому что индекс занят
+    enum class LoadResult { Loaded, ReloadInProgress, MergeInProgress };
+
+    // Конструктор, который берёт каталог сегментов и параметры слияния из конфигурации
+    InvertedIndex(const Config& config, Logger& logger);
+
+    // Деструктор, который останавливает фоновое слияние
+    ~InvertedIndex();
+
+    // Метод для построения нового снимка индекса
+    // Если задан каталог сегментов, отображает в память все сегменты из него (уже открытые переиспользуются);
+    // если каталог не задан или пуст, строит сегмент из таблиц pages/words/index
+    // Готовый снимок подменяет текущий атомарно, запросы во время загрузки обслуживает старый снимок
+    // Если другая загрузка или слияние уже выполняется, ничего не делает и сообщает, что именно занимает индекс
+    LoadResult load(Database& db);
+
+    // Метод для поиска страниц по убыванию оценки BM25
+    // В режиме query_mode = all страница должна содержать все слова (как Database::search), в режиме any — хотя бы одно
+    // offset пропускает первые документы после курсора; cursor — nextCursor предыдущей страницы (пусто — с начала)
+    // Некорректный курсор — std::invalid_argument; курсор от прежнего снимка индекса продолжает выдачу по оценке
+    SearchPage search(const std::vector<std::string>& queryWords, size_t limit = 10, size_t offset = 0,
+        const std::string& cursor = {}) const;
+
+    // Количество документов и сегментов в текущем снимке
+    size_t documentCount() const;
+    size_t segmentCount() const;
+
+    // Метод для вывода в лог перцентилей задержки поиска
+    void logSearchStats() const;
+
+    // Методы для запуска и остановки фонового слияния мелких сегментов
+    void startMerging();
+    void stopMerging();
+
+private:
+    // Неизменяемый снимок индекса: сегменты от старых к новым
+    struct Snapshot {
+        std::vector<std::shared_ptr<IndexSegment>> segments;
+        // Для каждого сегмента — документы, перекрытые более новой версией того же URL в более новом сегменте
+        // (пусто, если перекрытых документов в сегменте нет)
+        std::vector<std::vector<bool>> shadowed;
+
+        uint64_t generation = 0;   // Номер снимка (курсор привязан к номерам сегментов конкретного снимка)
+        uint64_t documents = 0;    // Количество актуальных документов
+        uint64_t totalLength = 0;  // Сумма длин актуальных документов
+
+        // IDF слов, уже встречавшихся в запросах: снимок неизменяем, поэтому значение вычисляется один раз
+        mutable std::unordered_map<std::string, float> idfCache;
+        mutable std::mutex idfMutex;
+
+        // Средняя длина документа
+        float averageLength() const;
+    };
+
+    // Собирает снимок из сегментов и вычисляет перекрытые документы
+    static std::shared_ptr<const Snapshot> makeSnapshot(std::vector<std::shared_ptr<IndexSegment>> segments);
+
+    // Строит сегмент из базы данных (в память или в файл каталога сегментов)
+    std::shared_ptr<IndexSegment> buildFromDatabase(Database& db);
+
+    // Открывает сегменты каталога, переиспользуя уже открытые
+    std::vector<std::shared_ptr<IndexSegment>> openDirectory(const Snapshot& previous);
+
+    // Сливает самую дешёвую последовательность из mergeFactor соседних сегментов; возвращает true, если слияние было
+    bool mergeOnce();
+
+    // Метод для получения текущего снимка
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    // Метод для подмены текущего снимка
+    void publish(std::shared_ptr<const Snapshot> next);
+
+    // Ссылка на объект логера для записи логов
+    Logger& logger;
+
+    std::string segmentDir;                   // Каталог сегментов (пустой — индекс только в памяти)
+    size_t mergeFactor;                       // Число сегментов, сливаемых за раз
+    std::chrono::milliseconds mergeInterval;  // Интервал проверки необходимости слияния
+    TopKEvaluator::Mode queryMode;            // Режим запроса: все слова или любое
+    TopKEvaluator::Strategy topKStrategy;     // Алгоритм отбора лучших документов
+    mutable LatencyHistogram latency;         // Задержки обработки запросов
+
+    std::shared_ptr<const Snapshot> current; // Текущий снимок индекса
+    mutable std::mutex snapshotMutex;        // Мьютекс для подмены снимка
+    std::mutex loadMutex;                    // Мьютекс, допускающий только одну загрузку или слияние одновременно
+    std::atomic<bool> merging{ false };      // loadMutex удерживает слияние, а не загрузка
+
+    std::thread mergeThread;                 // Поток фонового слияния
+    std::mutex mergeMutex;                   // Мьютекс для остановки слияния
+    std::condition_variable mergeCv;         // Сигнал остановки слияния
+    bool mergeStopping = false;              // Флаг остановки слияния
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Потоковая запись JSON прямо в строку ответа, без промежуточного дерева объектов
+//
+// Запятые между элементами расставляются автоматически; вызывающий код отвечает только за порядок
+// вызовов (key перед значением внутри объекта).
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out(out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    // Имя поля объекта
+    JsonWriter& key(std::string_view name);
+
+    // Значения; нечисловые double (NaN, бесконечность) записываются как null
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(double number);
+    JsonWriter& value(uint64_t number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+private:
+    // Запятая перед очередным элементом контейнера
+    void separate();
+
+    // Строка в кавычках с экранированием
+    void writeString(std::string_view text);
+
+    std::string& out;          // Буфер ответа
+    std::vector<bool> empty;   // Для открытых контейнеров: ещё нет ни одного элемента
+    bool afterKey = false;     // Следующее значение идёт после имени поля
+};
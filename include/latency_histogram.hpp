@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Гистограмма задержек для оценки перцентилей без хранения отдельных замеров
+// Корзины логарифмические (по 4 на каждую степень двойки микросекунд), погрешность перцентиля не больше 25%
+class LatencyHistogram {
+public:
+    // Метод для добавления замера; безопасен при вызове из нескольких потоков
+    void record(std::chrono::microseconds elapsed);
+
+    // Количество замеров
+    uint64_t count() const;
+
+    // Верхняя граница корзины, в которую попадает заданный перцентиль (0..100), в микросекундах
+    uint64_t percentile(double p) const;
+
+    // Строка вида "запросов N, p50 X мкс, p95 Y мкс, p99 Z мкс, максимум W мкс"
+    std::string summary() const;
+
+private:
+    static constexpr size_t kSubBuckets = 4;
+    static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+    static size_t bucketOf(uint64_t micros);
+    static uint64_t upperBound(size_t bucket);
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+    std::atomic<uint64_t> total{ 0 };
+    std::atomic<uint64_t> maximum{ 0 };
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "http_session.hpp"
+#include "response_encoder.hpp"
+
+#include <memory>
+#include <string>
+
+// Статический файл, прочитанный при запуске и отдаваемый из памяти
+//
+// ETag — хэш содержимого, Last-Modified — время изменения файла; по ним браузер переспрашивает
+// страницу условным запросом и получает 304 без тела. Сжатые варианты готовятся при чтении
+// с максимальным уровнем и отдаются по Accept-Encoding; у каждого варианта свой ETag.
+struct StaticAsset {
+    std::shared_ptr<const std::string> body;   // Содержимое файла (nullptr, если файл не прочитан)
+    std::shared_ptr<const std::string> gzip;   // Вариант gzip (nullptr, если сжатие не уменьшает файл)
+    std::shared_ptr<const std::string> brotli; // Вариант brotli (только при сборке с HAVE_BROTLI)
+    std::string contentType;                 // Заголовок Content-Type
+    std::string etag;                        // Хэш содержимого в кавычках
+    std::string lastModified;                // Время изменения файла в формате HTTP-даты
+
+    // Метод для чтения файла; при ошибке body остаётся пустым
+    static StaticAsset load(const std::string& path, std::string contentType);
+
+    // Метод для проверки условного запроса: true, если у клиента актуальная копия варианта с меткой tag
+    bool notModified(const HttpSession::Request& req, const std::string& tag) const;
+
+    // Метод для формирования ответа: 200 с подходящим вариантом или 304 на условный запрос
+    HttpSession::Response respond(const HttpSession::Request& req, const ResponseEncoder& encoder) const;
+};
+
+// Шаблон страницы, разрезанный по метке вставки на две неизменяемые части
+//
+// Части собираются в ответ вместе со вставкой через SegmentedBody, поэтому статический текст шаблона
+// не копируется ни при подстановке, ни при отправке.
+class PageTemplate {
+public:
+    // Метод для чтения шаблона; если метки нет, вставка добавляется в конец страницы
+    static PageTemplate load(const std::string& path, const std::string& marker);
+
+    bool loaded() const { return prefix != nullptr; }
+
+    // Метод для сборки тела страницы со вставкой
+    SegmentedBody::value_type render(std::shared_ptr<const std::string> insert) const;
+
+private:
+    std::shared_ptr<const std::string> prefix; // Текст до метки
+    std::shared_ptr<const std::string> suffix; // Текст после метки
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Блочный формат списков словопозиций (номер документа, частота)
+//
+// Список: [docFreq:u32][blockCount:u32][заголовки блоков][данные блоков]
+// Заголовок блока: [lastDoc:u32][offset:u32][maxFreq:u32][minLength:u32], offset отсчитывается от начала данных блоков.
+// Блок до kBlockSize словопозиций: разности номеров документов (относительно lastDoc предыдущего блока),
+// затем частоты; обе последовательности упакованы в StreamVByte (управляющие байты по 2 бита на число,
+// затем 1-4 байта на число). Заголовки позволяют пересечению перепрыгивать целые блоки без распаковки.
+namespace PostingCodec {
+
+    // Количество словопозиций в полном блоке
+    constexpr size_t kBlockSize = 128;
+
+    // Сколько байт после последнего списка должно быть доступно для чтения (SIMD-распаковка читает по 16 байт)
+    constexpr size_t kPadding = 16;
+
+    // Заголовок блока
+    struct BlockHeader {
+        uint32_t lastDoc;   // Номер последнего документа в блоке
+        uint32_t offset;    // Смещение данных блока от начала области данных
+        uint32_t maxFreq;   // Максимальная частота в блоке (верхняя граница для досрочного отсечения)
+        uint32_t minLength; // Минимальная длина документа в блоке (вместе с maxFreq ограничивает оценку BM25)
+    };
+
+    // Кодирует список, отсортированный по возрастанию номеров документов, и дописывает его в out
+    // lengths — длины документов по номеру документа (для minLength блоков)
+    void encode(const std::vector<std::pair<uint32_t, uint32_t>>& postings, const std::vector<uint32_t>& lengths,
+        std::vector<uint8_t>& out);
+
+    // Проверяет, доступна ли SIMD-распаковка на текущем процессоре
+    bool simdAvailable();
+
+    // Проверяет структуру списка, занимающего не больше available байт: количество блоков по docFreq, таблицу
+    // заголовков и размеры данных блоков по управляющим байтам (сами данные не читаются); lastDoc блоков должны
+    // возрастать и быть меньше docCount. Возвращает false, если курсор по такому списку вышел бы за его границы
+    bool validate(const uint8_t* list, size_t available, uint32_t docCount);
+
+    // Курсор по закодированному списку: распаковывает по одному блоку и умеет пропускать блоки по заголовкам
+    class Cursor {
+    public:
+        // list указывает на начало закодированного списка
+        explicit Cursor(const uint8_t* list);
+
+        bool valid() const { return isValid; }
+        uint32_t doc() const { return docs[pos]; }
+        uint32_t freq() const { return freqs[pos]; }
+        uint32_t docFreq() const { return totalDocs; }
+
+        // Переход к следующему документу списка
+        void next();
+
+        // Переход к первому документу с номером не меньше target
+        void nextGEQ(uint32_t target);
+
+        // Поиск по заголовкам блока, который может содержать target, без распаковки и без сдвига курсора
+        // Возвращает false, если все документы списка меньше target. Цели должны не убывать между вызовами
+        bool shallowSeek(uint32_t target, BlockHeader& out);
+
+    private:
+        // Первый блок не раньше from, у которого lastDoc >= target (blockCount, если такого нет)
+        uint32_t findBlock(uint32_t from, uint32_t target) const;
+
+        // Читает заголовок блока b
+        BlockHeader header(uint32_t b) const;
+
+        // Распаковывает блок b в буферы docs/freqs
+        void loadBlock(uint32_t b);
+
+        const uint8_t* headers = nullptr;  // Начало массива заголовков
+        const uint8_t* data = nullptr;     // Начало области данных блоков
+        uint32_t totalDocs = 0;            // Количество документов в списке
+        uint32_t blockCount = 0;           // Количество блоков
+        uint32_t block = 0;                // Номер текущего блока
+        uint32_t count = 0;                // Количество словопозиций в текущем блоке
+        uint32_t pos = 0;                  // Позиция внутри текущего блока
+        uint32_t shallowBlock = 0;         // Блок, найденный последним вызовом shallowSeek
+        bool isValid = false;              // Не вышел ли курсор за конец списка
+
+        uint32_t docs[kBlockSize];         // Номера документов текущего блока
+        uint32_t freqs[kBlockSize];        // Частоты текущего блока
+    };
+
+} // namespace PostingCodec
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Кэш ответов на поисковые запросы: ключ — нормализованный список слов, значение — готовая страница результатов
+//
+// Кэш разбит на шарды со своими мьютексами и LRU-списками, чтобы параллельные запросы не ждали друг друга.
+// Объём ограничен бюджетом памяти (делится между шардами поровну), записи устаревают по TTL и целиком
+// сбрасываются при смене версии корпуса (invalidate). Запись, посчитанная до сброса, в кэш уже не попадёт:
+// put принимает эпоху, полученную до выполнения поиска.
+class QueryCache {
+public:
+    // Счётчики кэша
+    struct Stats {
+        uint64_t hits = 0;        // Попадания
+        uint64_t misses = 0;      // Промахи (включая устаревшие записи)
+        uint64_t expired = 0;     // Записи, отброшенные по TTL
+        uint64_t evictions = 0;   // Записи, вытесненные из-за бюджета памяти
+        uint64_t invalidations = 0; // Сбросы по смене версии корпуса
+        size_t entries = 0;       // Текущее количество записей
+        size_t bytes = 0;         // Текущий объём записей
+    };
+
+    // memoryBudget — бюджет в байтах (0 отключает кэш), ttl — время жизни записи
+    QueryCache(size_t memoryBudget, std::chrono::milliseconds ttl, size_t shardCount);
+
+    // Проверка, включён ли кэш
+    bool enabled() const { return shardBudget > 0; }
+
+    // Ключ кэша: уникальные слова запроса в порядке сортировки (порядок слов на результат не влияет)
+    static std::string makeKey(std::vector<std::string> words);
+
+    // Поиск записи; nullptr при промахе
+    std::shared_ptr<const std::string> get(const std::string& key);
+
+    // Текущая эпоха: берётся до поиска и передаётся в put
+    uint64_t epoch() const { return currentEpoch.load(std::memory_order_acquire); }
+
+    // Добавление записи; отбрасывается, если с момента получения epoch кэш был сброшен
+    void put(const std::string& key, std::shared_ptr<const std::string> value, uint64_t epoch);
+
+    // Сброс всех записей (корпус изменился)
+    void invalidate();
+
+    // Снимок счётчиков
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> value;
+        uint64_t epoch;
+        std::chrono::steady_clock::time_point expires;
+        size_t bytes;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru; // В начале — последние использованные
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> entries; // Ключи указывают в lru
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(const std::string& key);
+
+    // Удаление записи из шарда (мьютекс шарда захвачен)
+    static void erase(Shard& shard, std::list<Entry>::iterator it);
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardBudget;               // Бюджет памяти одного шарда
+    std::chrono::milliseconds ttl;    // Время жизни записи
+    std::atomic<uint64_t> currentEpoch{ 0 };
+
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+    std::atomic<uint64_t> expired{ 0 };
+    std::atomic<uint64_t> evictions{ 0 };
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Разбор строки запроса URL и тела формы application/x-www-form-urlencoded
+//
+// Все параметры декодируются в один буфер парсера, а имена и значения возвращаются как string_view на него:
+// буфер резервируется под длину входа (декодированный текст не длиннее), поэтому разбор выделяет память
+// не больше одного раза, а повторное использование парсера — ни разу. Некорректная %-последовательность
+// не бросает исключение: parse возвращает false.
+class QueryParser {
+public:
+    // Метод для разбора строки вида "a=1&b=2" (ранее разобранные параметры сбрасываются)
+    // Возвращает false при некорректной %-последовательности; параметров после этого нет
+    bool parse(std::string_view encoded);
+
+    // Значение первого параметра с именем name (nullopt — параметра нет)
+    // string_view действительны до следующего parse
+    std::optional<std::string_view> get(std::string_view name) const;
+
+    // Количество разобранных параметров
+    size_t size() const { return params.size(); }
+
+    // Метод для декодирования одной строки ("+" — пробел, "%XX" — байт) с дописыванием в out
+    // Возвращает false при некорректной %-последовательности
+    static bool decode(std::string_view encoded, std::string& out);
+
+    // Метод для разбиения текста на слова по пробельным символам (как operator>> потока)
+    static void tokenize(std::string_view text, std::vector<std::string_view>& tokens);
+
+private:
+    // Положение имени и значения параметра в буфере
+    struct Param {
+        size_t keyBegin, keyEnd;
+        size_t valueBegin, valueEnd;
+    };
+
+    std::string buffer;         // Декодированные имена и значения
+    std::vector<Param> params;  // Параметры в порядке следования
+};
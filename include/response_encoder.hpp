@@ -0,0 +1,67 @@
+#pragma once
+
+#include "http_session.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Кодировки сжатия ответа
+enum class ContentEncoding { Identity, Gzip, Brotli };
+
+// Класс для сжатия HTTP-ответов по Accept-Encoding
+//
+// Кодировка выбирается по весам q из Accept-Encoding клиента; при равных весах brotli предпочтительнее gzip.
+// Brotli доступен, если проект собран с библиотекой brotli (HAVE_BROTLI). Статические файлы сжимаются
+// один раз при запуске (StaticAsset), динамические ответы — при отправке: каждый поток держит свой
+// контекст zlib и переиспользует его через deflateReset. Тела меньше порога не сжимаются: выигрыш
+// в байтах не окупает заголовков и времени процессора.
+class ResponseEncoder {
+public:
+    // Счётчики сжатия динамических ответов
+    struct Stats {
+        uint64_t compressed = 0;     // Сжатые ответы
+        uint64_t skipped = 0;        // Ответы меньше порога
+        uint64_t bytesIn = 0;        // Байты до сжатия
+        uint64_t bytesOut = 0;       // Байты после сжатия
+        uint64_t microseconds = 0;   // Время сжатия (без ожиданий, то есть время процессора)
+    };
+
+    // Конструктор: minSize — порог в байтах, уровни сжатия для динамических ответов
+    ResponseEncoder(bool enabled, size_t minSize, int gzipLevel, int brotliQuality);
+
+    bool enabled() const { return enabled_; }
+
+    // Метод для выбора кодировки по заголовку Accept-Encoding
+    ContentEncoding negotiate(std::string_view acceptEncoding) const;
+
+    // Метод для сжатия тела из фрагментов без их склейки; level — уровень gzip или качество brotli
+    static std::string compress(ContentEncoding encoding, const std::vector<std::shared_ptr<const std::string>>& segments,
+        int level);
+
+    // Метод для сжатия готового динамического ответа на месте (Content-Encoding, Vary)
+    void encode(const HttpSession::Request& req, HttpSession::Response& res);
+
+    // Имя кодировки для заголовка Content-Encoding
+    static const char* name(ContentEncoding encoding);
+
+    // Максимальный уровень сжатия (для статических файлов, которые сжимаются один раз)
+    static int maxLevel(ContentEncoding encoding);
+
+    Stats stats() const;
+
+private:
+    bool enabled_;      // Сжатие включено в конфигурации
+    size_t minSize;     // Порог размера тела
+    int gzipLevel;      // Уровень gzip для динамических ответов
+    int brotliQuality;  // Качество brotli для динамических ответов
+
+    std::atomic<uint64_t> compressed{ 0 };
+    std::atomic<uint64_t> skipped{ 0 };
+    std::atomic<uint64_t> bytesIn{ 0 };
+    std::atomic<uint64_t> bytesOut{ 0 };
+    std::atomic<uint64_t> microseconds{ 0 };
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Страница результатов поиска
+//
+// Следующая страница запрашивается по курсору (search-after): он указывает позицию последнего показанного
+// документа в порядке результата, поэтому глубокая страница стоит столько же, сколько первая, а не растёт
+// со смещением. Формат курсора непрозрачен и зависит от источника (индекс в памяти или база данных).
+struct SearchPage {
+    std::vector<std::pair<std::string, float>> results; // URL и оценка BM25 по убыванию оценки
+    uint64_t total = 0;         // Число подходящих документов
+    bool exactTotal = false;    // false — total оценён по документным частотам слов
+    std::string nextCursor;     // Курсор следующей страницы (пусто, если страниц больше нет)
+};
@@ -1,38 +1,107 @@
 #pragma once
 
+#include "async_database.hpp"
 #include "config.hpp"
 #include "logger.hpp"
 #include "database.hpp"
+#include "inverted_index.hpp"
+#include "query_cache.hpp"
+#include "response_encoder.hpp"
+#include "http_session.hpp"
+#include "page_templates.hpp"
 
-#include <atomic>                  //   
-#include <boost/asio/ip/tcp.hpp>   //    TCP-  Boost.Asio
-#include <memory>                  //   
+#include <atomic>                  // Для атомарных переменных
+#include <boost/asio/ip/tcp.hpp>   // Для работы с TCP-сокетами через Boost.Asio
+#include <boost/asio/thread_pool.hpp>
+#include <condition_variable>
+#include <memory>                  // Для умных указателей
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-//     
+// Класс для реализации поискового сервера
 class SearchServer {
 public:
-    // ,     , ,     
+    // Конструктор, который инициализирует сервер с конфигурацией, логером, базой данных и флагом работы
     SearchServer(const Config& config, Logger& logger, Database& db, std::atomic<bool>& running);
 
-    //    
+    // Метод для запуска сервера
     void run();
 
 private:
-    //    
+    // Ссылка на объект конфигурации
     const Config& config;
 
-    //       
+    // Ссылка на объект логера для записи логов
     Logger& logger;
 
-    //        
+    // Ссылка на объект базы данных для хранения данных
     Database& db;
 
-    //   ,     
+    // Неблокирующий доступ к базе данных для поисковых запросов (создаётся на io_context сервера)
+    std::unique_ptr<AsyncDatabase> asyncDb;
+
+    // Ссылка на флаг, который управляет состоянием работы сервера
     std::atomic<bool>& running;
 
-    //      TCP-
+    // Инвертированный индекс в памяти (используется, если включён в конфигурации)
+    InvertedIndex index;
+
+    // Отдельный поток для перезагрузки индекса по /admin/reload: загрузка не занимает потоки io_context
+    boost::asio::thread_pool reloadPool{ 1 };
+    std::atomic<bool> reloadQueued{ false }; // Перезагрузка уже поставлена в reloadPool
+
+    // Кэш готовых страниц результатов
+    QueryCache cache;
+
+    // Сжатие ответов по Accept-Encoding
+    ResponseEncoder encoder;
+
+    // Страницы и шаблоны, прочитанные с диска один раз при запуске
+    StaticAsset searchForm;
+    StaticAsset styleSheet;
+    PageTemplate resultsPage;
+
+    // Поток, следящий за версией корпуса, и его остановка
+    std::thread versionThread;
+    std::mutex versionMutex;
+    std::condition_variable versionCv;
+    bool versionStopping = false;
+
+    // Методы для запуска и остановки слежения за версией корпуса
+    // (смена версии перезагружает индекс в памяти и сбрасывает кэш)
+    void startVersionWatch();
+    void stopVersionWatch();
+
+    // Метод для формирования блока результатов (вставляется в шаблон страницы и хранится в кэше)
+    static std::string renderResults(const std::vector<std::pair<std::string, float>>& results);
+
+    // Метод для записи в лог счётчиков кэша
+    void logCacheStats() const;
+
+    // Метод для записи в лог счётчиков сжатия
+    void logCompressionStats() const;
+
+    // Метод для инициализации и старта TCP-сервера
     void startServer();
 
-    //      (    TCP-)
-    void handleSession(boost::asio::ip::tcp::socket socket);
+    // Метод для обработки одного HTTP-запроса (сопрограмма, вызывается асинхронной сессией соединения)
+    boost::asio::awaitable<HttpSession::Response> handleRequest(const HttpSession::Request& req,
+        const boost::asio::ip::tcp::endpoint& remote);
+
+    // Метод для поиска по индексу в памяти или по базе данных (в зависимости от конфигурации)
+    boost::asio::awaitable<SearchPage> runSearch(const std::vector<std::string>& words, size_t limit, size_t offset,
+        const std::string& cursor);
+
+    // Метод для обработки запроса к JSON API поиска
+    boost::asio::awaitable<HttpSession::Response> handleApiSearch(const HttpSession::Request& req);
+
+    // Ограничения постраничной выдачи JSON API
+    size_t maxResults;  // Наибольший limit
+    size_t maxOffset;   // Наибольший offset (глубже — по курсору)
+
+    // Обработчик запросов, передаваемый сессиям
+    HttpSession::Handler requestHandler;
 };
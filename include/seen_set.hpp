@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Множество посещённых URL в виде отпечатков фиксированной длины
+//
+// Вместо строк хранятся отпечатки URL (старшие 32 или 64 бита 64-битного хэша) в таблице с открытой адресацией
+// и линейным пробированием: номер слота — старшие биты отпечатка, поэтому при расширении таблицы отпечатки
+// переносятся без исходных URL, а соседние слоты читаются из одной линии кэша. Ширина отпечатка выбирается
+// по бюджету памяти и допустимой доле ложных срабатываний: 32 бита, если даже заполненная до предела таблица
+// укладывается в эту долю, иначе 64 бита. Ложное срабатывание — новый URL, принятый за посещённый.
+//
+// Таблица растёт вдвое, пока укладывается в бюджет; когда бюджет исчерпан и таблица заполнена, новые
+// отпечатки не добавляются и считаются в dropped() (такие URL краулер пропускает).
+// Класс не потокобезопасен: вызывающий разбивает множество на полосы со своими мьютексами.
+class SeenSet {
+public:
+    // memoryBudget — наибольший объём таблицы в байтах, falsePositiveRate — допустимая доля ложных срабатываний
+    SeenSet(size_t memoryBudget, double falsePositiveRate);
+
+    // Отпечаток URL (64-битный хэш); младшие биты можно использовать для выбора полосы
+    static uint64_t fingerprint(std::string_view url);
+
+    // Метод для добавления отпечатка; true — отпечаток новый и добавлен, false — уже был или бюджет исчерпан
+    bool insert(uint64_t fingerprint);
+
+    // Количество отпечатков
+    size_t size() const { return count; }
+
+    // Объём таблицы в байтах
+    size_t bytes() const;
+
+    // Ширина отпечатка в битах (32 или 64)
+    int width() const { return wide ? 64 : 32; }
+
+    // Отпечатки, не добавленные из-за исчерпания бюджета
+    uint64_t dropped() const { return droppedCount; }
+
+private:
+    template<typename Slot>
+    bool insertInto(std::vector<Slot>& slots, uint64_t fingerprint);
+
+    template<typename Slot>
+    void grow(std::vector<Slot>& slots);
+
+    bool wide;                  // Отпечатки по 64 бита (иначе по 32)
+    size_t maxSlots;            // Наибольшее число слотов в пределах бюджета (степень двойки)
+    size_t count = 0;
+    uint64_t droppedCount = 0;
+    std::vector<uint32_t> narrowSlots;  // Слоты 32-битных отпечатков (0 — пустой слот)
+    std::vector<uint64_t> wideSlots;    // Слоты 64-битных отпечатков (0 — пустой слот)
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Тело HTTP-ответа из неизменяемых общих фрагментов
+//
+// Фрагменты (статические части шаблона, готовый блок результатов из кэша) не копируются в ответ:
+// тело хранит на них shared_ptr, а при отправке отдаёт Beast список буферов, и все части уходят
+// одной записью с разбросом (scatter-gather). Присваивание строки даёт тело из одного фрагмента.
+struct SegmentedBody {
+    class value_type {
+    public:
+        value_type() = default;
+
+        // Тело из одной строки (текстовые ответы, ошибки)
+        value_type& operator=(std::string text) {
+            segments_.clear();
+            bytes = 0;
+            append(std::move(text));
+            return *this;
+        }
+
+        // Добавление общего фрагмента без копирования
+        void append(std::shared_ptr<const std::string> segment) {
+            if (!segment || segment->empty()) return;
+            bytes += segment->size();
+            segments_.push_back(std::move(segment));
+        }
+
+        // Добавление собственной строки
+        void append(std::string text) {
+            append(std::make_shared<const std::string>(std::move(text)));
+        }
+
+        // Общий размер тела
+        std::size_t size() const { return bytes; }
+        bool empty() const { return bytes == 0; }
+
+        const std::vector<std::shared_ptr<const std::string>>& segments() const { return segments_; }
+
+        // Склейка тела в одну строку (для преобразований всего тела)
+        std::string str() const {
+            std::string result;
+            result.reserve(bytes);
+            for (const auto& segment : segments_) result += *segment;
+            return result;
+        }
+
+    private:
+        std::vector<std::shared_ptr<const std::string>> segments_;
+        std::size_t bytes = 0;
+    };
+
+    static std::uint64_t size(const value_type& body) { return body.size(); }
+
+    // Запись тела: все фрагменты отдаются одним списком буферов
+    class writer {
+    public:
+        using const_buffers_type = std::vector<boost::asio::const_buffer>;
+
+        template<bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>& /*header*/, const value_type& body) : body(body) {}
+
+        void init(boost::beast::error_code& ec) { ec = {}; }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec) {
+            ec = {};
+            if (done || body.empty()) return boost::none;
+            done = true;
+
+            const_buffers_type buffers;
+            buffers.reserve(body.segments().size());
+            for (const auto& segment : body.segments()) {
+                buffers.emplace_back(segment->data(), segment->size());
+            }
+            return std::make_pair(std::move(buffers), false);
+        }
+
+    private:
+        const value_type& body;
+        bool done = false;
+    };
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Поиск почти одинаковых страниц (зеркал, версий для печати, страниц с разной обвязкой) по SimHash
+//
+// Отпечаток страницы — 64-битный SimHash её слов с весами-частотами: у похожих страниц отпечатки отличаются
+// в немногих битах. Страница считается почти дубликатом, если уже есть отпечаток на расстоянии Хэмминга не
+// больше maxDistance. Для поиска отпечаток делится на maxDistance + 1 блоков: у отпечатков на таком расстоянии
+// хотя бы один блок совпадает, поэтому сравниваются только отпечатки из таблиц блоков с тем же значением.
+// Короткие страницы (меньше 16 различных слов) не проверяются: их отпечатки слишком неустойчивы.
+// Класс потокобезопасен.
+class SimHashIndex {
+public:
+    // maxDistance — наибольшее расстояние (0..7); отрицательное значение отключает проверку
+    explicit SimHashIndex(int maxDistance);
+
+    // Отпечаток SimHash по частотам слов
+    static uint64_t fingerprint(const std::unordered_map<std::string, int>& words);
+
+    // Метод для проверки страницы: true — почти дубликат уже встречавшейся страницы,
+    // иначе отпечаток страницы запоминается, записывается в *remembered (если задан) и возвращается false
+    // previous — отпечаток этой же страницы из прошлого обхода (0 — нет): совпадение с ним дубликатом не считается
+    bool isNearDuplicate(const std::unordered_map<std::string, int>& words, uint64_t previous = 0,
+        uint64_t* remembered = nullptr);
+
+    // Метод для добавления отпечатка, запомненного прошлым обходом (без проверки)
+    void remember(uint64_t fingerprint);
+
+    // Количество запомненных отпечатков
+    size_t size() const;
+
+private:
+    // Добавление отпечатка в таблицы блоков (вызывается под mutex)
+    void insert(uint64_t fingerprint);
+
+    int maxDistance;
+    std::vector<int> blockStart;    // Начальные биты блоков (последний элемент — 64)
+
+    mutable std::mutex mutex;
+    std::vector<std::unordered_map<uint64_t, std::vector<uint64_t>>> tables; // Отпечатки по значению каждого блока
+    size_t count = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Подсчёт частот слов страницы без выделения памяти на каждое слово
+//
+// Открытая адресация с линейным пробированием по степени двойки: слоты хранят номера записей, записи —
+// смещение слова в общем буфере (арене), его длину, хэш и счётчик. Новое слово дописывается в арену,
+// повторное только увеличивает счётчик. clear() сбрасывает размеры, но сохраняет выделенную память,
+// поэтому после нескольких страниц подсчёт не выделяет память вовсе.
+class TermCounter {
+public:
+    // Запись о слове; count < 0 — слово исключено (например, стоп-слово) и при выгрузке пропускается
+    struct Entry {
+        uint32_t offset;    // Смещение слова в арене
+        uint32_t length;    // Длина слова в байтах
+        uint32_t hash;      // Хэш слова (для быстрого сравнения и перестройки таблицы)
+        int count;          // Число вхождений
+    };
+
+    // Метод для сброса перед следующей страницей (память остаётся за счётчиком)
+    void clear();
+
+    // Метод для поиска записи слова; новое слово добавляется с нулевым счётчиком и inserted = true
+    // Ссылка действительна до следующего вызова find
+    Entry& find(std::string_view term, bool& inserted);
+
+    // Записи в порядке первого появления слов
+    const std::vector<Entry>& entries() const { return items; }
+
+    // Текст слова записи (действителен до следующего find или clear)
+    std::string_view term(const Entry& entry) const { return std::string_view(arena).substr(entry.offset, entry.length); }
+
+    // Количество различных слов
+    size_t size() const { return items.size(); }
+
+private:
+    // Перестройка таблицы слотов вдвое большего размера
+    void grow();
+
+    static uint32_t hashOf(std::string_view term);
+
+    std::vector<uint32_t> slots;    // Номер записи + 1 (0 — пустой слот)
+    std::vector<Entry> items;       // Записи слов
+    std::string arena;              // Тексты слов подряд
+};
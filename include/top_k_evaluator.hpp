@@ -0,0 +1,82 @@
+#pragma once
+
+#include "index_segment.hpp"
+#include "posting_codec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Отбор лучших k документов одного сегмента по оценке BM25
+//
+// Стратегия BlockMaxWand не оценивает документы, которые заведомо не попадут в k лучших: верхняя граница
+// вклада слова берётся по всему списку (WAND) и по блоку, содержащему кандидата (BlockMax-WAND), по паре
+// (максимальная частота, минимальная длина документа), так что целые блоки пропускаются без распаковки. Exhaustive оценивает все подходящие документы и служит эталоном.
+class TopKEvaluator {
+public:
+    // Семантика запроса: все слова (как HAVING в Database::search) или хотя бы одно
+    enum class Mode { Conjunctive, Disjunctive };
+
+    // Алгоритм отбора
+    enum class Strategy { BlockMaxWand, Exhaustive };
+
+    // Слово запроса в сегменте
+    struct Term {
+        const uint8_t* postings;  // Начало списка словопозиций
+        uint32_t docFreq;         // Количество документов со словом
+        uint32_t maxFreq;         // Максимальная частота слова в документе
+        uint32_t minLength;       // Минимальная длина документа со словом
+        float idf;                // Обратная частота документов по всему индексу
+    };
+
+    // Найденный документ
+    struct Hit {
+        float score;
+        uint32_t doc;
+    };
+
+    // Позиция курсора постраничного поиска: подходят документы, идущие в порядке результата после него,
+    // то есть с оценкой меньше score или равной ей при номере не меньше firstTiedDoc
+    struct After {
+        float score = std::numeric_limits<float>::infinity();
+        uint64_t firstTiedDoc = 0;
+    };
+
+    // averageLength — средняя длина документа по всему индексу
+    TopKEvaluator(size_t k, Mode mode, Strategy strategy, float averageLength);
+
+    // Возвращает до k лучших документов сегмента по убыванию оценки (при равенстве — по возрастанию номера)
+    // excluded — документы, которые нельзя возвращать (пустой вектор, если таких нет)
+    // after — курсор: документы до него (уже показанные страницы) не возвращаются и не занимают место в куче
+    // (After{} — без курсора)
+    std::vector<Hit> run(const std::vector<Term>& terms, const IndexSegment& segment, const std::vector<bool>& excluded,
+        const After& after);
+
+private:
+    // Вклад слова в оценку документа и его верхняя граница по максимальной частоте и минимальной длине
+    float termScore(size_t term, uint32_t freq, uint32_t doc) const;
+    float termBound(size_t term, uint32_t maxFreq, uint32_t minLength) const;
+
+    // Порог входа в кучу: документ с оценкой (или границей) не больше порога в k лучших не попадёт
+    bool competitive(float bound) const;
+
+    // Предлагает документ в кучу лучших
+    void offer(float score, uint32_t doc, const std::vector<bool>& excluded);
+
+    void runConjunctive(const std::vector<bool>& excluded);
+    void runDisjunctive(const std::vector<bool>& excluded);
+    void runDisjunctiveExhaustive(const std::vector<bool>& excluded);
+
+    size_t k;
+    Mode mode;
+    Strategy strategy;
+    float averageLength;
+    const IndexSegment* segment = nullptr;       // Сегмент текущего запуска (длины документов)
+    After after;                                 // Курсор текущего запуска
+
+    std::vector<Term> terms;                     // Слова запроса
+    std::vector<PostingCodec::Cursor> cursors;   // Курсоры по спискам (в том же порядке, что terms)
+    std::vector<float> listBounds;               // Верхние границы вклада слов по всему списку
+    std::vector<Hit> heap;                       // Куча лучших: в начале худший из отобранных
+};
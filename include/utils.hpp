@@ -4,19 +4,16 @@
 
 namespace Utils {
 
-    //  HTTP(S) GET-   URL   (  5000 )
-    std::string httpGet(const std::string& url, int timeoutMs = 5000);
-
-    // ,   URL  (http://  https://)
-    bool isHttpUrl(const std::string& url);
-
-    // ,   URL  (  '/')
-    bool isRelativeUrl(const std::string& url);
-
-    //   URL       URL
+    // Разрешает ссылку (абсолютную, //хост/..., /путь, путь, ../путь, ?запрос) относительно базового URL
+    // по RFC 3986 и нормализует результат; пустая строка — ссылка не на http(s)
     std::string resolveRelativeUrl(const std::string& base, const std::string& relative);
 
-    //  HTML-   ( &, <, >, ", '   )
+    // Нормализует абсолютный URL: схема и хост в нижнем регистре, без порта по умолчанию, фрагмента и
+    // сегментов "." и "..", единообразное процентное кодирование, параметры запроса по порядку имён
+    // Пустая строка — не http(s)-URL
+    std::string normalizeUrl(const std::string& url);
+
+    // Экранирует HTML-символы в строке (заменяет &, <, >, ", ' на соответствующие сущности)
     std::string escapeHtml(const std::string& input);
 
 } // namespace Utils
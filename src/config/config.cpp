@@ -2,38 +2,87 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 
-//   Config,     
+// Конструктор класса Config, загружает параметры из конфигурационного файла
 Config::Config(const std::string& filename) {
-    //     INI-
+    // Создаём объект для парсинга INI-файла
     boost::property_tree::ptree pt;
-    //        
+    // Читаем конфигурацию из файла и заполняем дерево свойств
     boost::property_tree::ini_parser::read_ini(filename, pt);
 
-    //    
-    dbHost = pt.get<std::string>("database.host");      //   
-    dbPort = pt.get<int>("database.port");              //   
-    dbName = pt.get<std::string>("database.name");      //   
-    dbUser = pt.get<std::string>("database.user");      //     
-    dbPassword = pt.get<std::string>("database.password"); //   
-
-    //    
-    startUrl = pt.get<std::string>("crawler.start_url"); //  URL  
-    maxDepth = pt.get<int>("crawler.depth");             //   
-    timeout = pt.get<int>("crawler.timeout");            //   
-    filterStopwords = pt.get<bool>("crawler.filter_stopwords"); //    -
-
-    //    
-    serverPort = pt.get<int>("server.port");             //  
-
-    //    
-    logToConsole = pt.get<bool>("logging.console");      //      
-    logToFile = pt.get<bool>("logging.file");            //      
-    logDir = pt.get<std::string>("logging.log_dir");     //    
+    // Загружаем параметры базы данных
+    dbHost = pt.get<std::string>("database.host");      // Хост базы данных
+    dbPort = pt.get<int>("database.port");              // Порт базы данных
+    dbName = pt.get<std::string>("database.name");      // Имя базы данных
+    dbUser = pt.get<std::string>("database.user");      // Имя пользователя для базы данных
+    dbPassword = pt.get<std::string>("database.password"); // Пароль базы данных
+    dbPoolSize = pt.get<int>("database.pool_size", 4);  // Размер пула соединений
+    dbAsyncConnections = pt.get<int>("database.async_connections", 8);  // Асинхронные соединения сервера
+
+    // Загружаем параметры для краулера
+    startUrl = pt.get<std::string>("crawler.start_url"); // Начальный URL для сканирования
+    maxDepth = pt.get<int>("crawler.depth");             // Максимальная глубина сканирования
+    timeout = pt.get<int>("crawler.timeout");            // Таймаут для запросов
+    filterStopwords = pt.get<bool>("crawler.filter_stopwords"); // Флаг для фильтрации стоп-слов
+    maxInFlight = pt.get<int>("crawler.max_in_flight", 256);   // Наибольшее число одновременных загрузок
+    fetchThreads = pt.get<int>("crawler.fetch_threads", 0);    // Количество потоков загрузки
+    indexThreads = pt.get<int>("crawler.index_threads", 0);    // Количество потоков обработки страниц
+    keepAliveSeconds = pt.get<int>("crawler.keep_alive_seconds", 30); // Время простоя соединения до закрытия
+    maxIdlePerHost = pt.get<int>("crawler.max_idle_per_host", 256);    // Свободных соединений на хост
+    dispatchThreads = pt.get<int>("crawler.dispatch_threads", 2);     // Потоков, раздающих URL
+    frontierShards = pt.get<int>("crawler.frontier_shards", 64);      // Шардов очередей хостов
+    maxPerHost = pt.get<int>("crawler.max_per_host", 8);              // Одновременных загрузок на хост
+    hostDelayMs = pt.get<int>("crawler.host_delay_ms", 0);            // Интервал между загрузками хоста
+    seenMemoryMb = pt.get<int>("crawler.seen_memory_mb", 256);        // Бюджет множества посещённых URL
+    seenFalsePositiveRate = pt.get<double>("crawler.seen_fp_rate", 1e-6); // Доля ложных срабатываний
+    nearDuplicateDistance = pt.get<int>("crawler.near_duplicate_distance", 3); // Расстояние почти дубликатов
+    stateFile = pt.get<std::string>("crawler.state_file", "crawl_state.log");  // Журнал состояния обхода
+    checkpointIntervalMs = pt.get<int>("crawler.checkpoint_interval_ms", 1000); // Период записи журнала
+    incrementalRecrawl = pt.get<bool>("crawler.incremental", true);   // Повторный обход изменившихся страниц
+
+    // Загружаем параметры для сервера
+    serverPort = pt.get<int>("server.port");             // Порт сервера
+    serverThreads = pt.get<int>("server.threads", 0);    // Количество потоков сервера
+    sessionTimeoutSeconds = pt.get<int>("server.timeout_seconds", 30); // Таймаут соединения
+    inMemoryIndex = pt.get<bool>("server.in_memory_index", true); // Флаг поиска по индексу в памяти
+    queryMode = pt.get<std::string>("server.query_mode", "all");  // Режим запроса
+    topKAlgorithm = pt.get<std::string>("server.top_k", "blockmax"); // Алгоритм отбора лучших документов
+    maxResults = pt.get<int>("server.max_results", 100);          // Наибольший limit JSON API
+    maxOffset = pt.get<int>("server.max_offset", 1000);           // Наибольший offset JSON API
+
+    // Загружаем параметры отложенной записи в базу данных
+    ingestQueueSize = pt.get<int>("ingest.queue_size", 256);             // Ёмкость очереди
+    ingestBatchSize = pt.get<int>("ingest.batch_size", 32);              // Страниц в одной транзакции
+    ingestFlushIntervalMs = pt.get<int>("ingest.flush_interval_ms", 500); // Интервал сброса неполной пачки
+    ingestWriters = pt.get<int>("ingest.writers", 1);                    // Количество потоков записи
+    writeDatabase = pt.get<bool>("ingest.write_database", true);         // Запись страниц в базу данных
+
+    // Загружаем параметры сегментов индекса
+    segmentDir = pt.get<std::string>("index.segment_dir", "");           // Каталог сегментов
+    segmentFlushDocs = pt.get<int>("index.segment_flush_docs", 5000);    // Документов в сегменте краулера
+    mergeFactor = pt.get<int>("index.merge_factor", 4);                  // Сегментов за одно слияние
+    mergeIntervalMs = pt.get<int>("index.merge_interval_ms", 60000);     // Интервал проверки слияния
+
+    // Загружаем параметры кэша запросов
+    cacheMemoryMb = pt.get<int>("cache.memory_mb", 64);                  // Бюджет памяти
+    cacheTtlSeconds = pt.get<int>("cache.ttl_seconds", 300);             // Время жизни записи
+    cacheShards = pt.get<int>("cache.shards", 16);                       // Количество шардов
+    corpusVersionPollMs = pt.get<int>("cache.version_poll_ms", 2000);    // Интервал проверки версии корпуса
+
+    // Загружаем параметры сжатия ответов
+    compressionEnabled = pt.get<bool>("compression.enabled", true);      // Флаг сжатия
+    compressionMinSize = pt.get<int>("compression.min_size", 1024);      // Порог размера ответа
+    gzipLevel = pt.get<int>("compression.gzip_level", 6);                // Уровень gzip
+    brotliQuality = pt.get<int>("compression.brotli_quality", 4);        // Качество brotli
+
+    // Загружаем параметры для логирования
+    logToConsole = pt.get<bool>("logging.console");      // Флаг для вывода логов в консоль
+    logToFile = pt.get<bool>("logging.file");            // Флаг для записи логов в файл
+    logDir = pt.get<std::string>("logging.log_dir");     // Директория для файлов логов
 }
 
-//        
+// Метод для формирования строки подключения к базе данных
 std::string Config::getDbConnectionString() const {
-    //      "host=..., port=..., dbname=..., user=..., password=..."
+    // Строим строку подключения в формате "host=..., port=..., dbname=..., user=..., password=..."
     return "host=" + dbHost + " port=" + std::to_string(dbPort) +
         " dbname=" + dbName + " user=" + dbUser + " password=" + dbPassword;
 }
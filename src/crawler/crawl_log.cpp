@@ -0,0 +1,222 @@
+#include "crawl_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    // Типы записей журнала
+    constexpr char addedRecord = 'A';   // URL добавлен: отпечаток, глубина, длина URL, URL
+    constexpr char doneRecord = 'D';    // Страница обработана: отпечаток
+    constexpr char seenRecord = 'S';    // URL обработан (в сжатом журнале): отпечаток
+
+    constexpr size_t readChunk = 1 << 20;   // Размер блока чтения журнала
+
+    template<typename T>
+    void appendValue(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Последовательное чтение журнала блоками
+    class Reader {
+    public:
+        explicit Reader(const std::string& path) : in(path, std::ios::binary) {}
+
+        // Чтение n байт; false — файл закончился раньше (недописанная запись)
+        bool read(void* out, size_t n) {
+            auto* dst = static_cast<char*>(out);
+            while (n > 0) {
+                if (pos == end && !fill()) return false;
+                size_t take = std::min(n, end - pos);
+                std::memcpy(dst, buffer.data() + pos, take);
+                pos += take;
+                dst += take;
+                n -= take;
+            }
+            return true;
+        }
+
+        template<typename T>
+        bool read(T& value) { return read(&value, sizeof(value)); }
+
+        // Позиция в файле после последнего прочитанного байта
+        uint64_t offset() const { return consumed - (end - pos); }
+
+    private:
+        bool fill() {
+            buffer.resize(readChunk);
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            end = static_cast<size_t>(in.gcount());
+            pos = 0;
+            consumed += end;
+            return end > 0;
+        }
+
+        std::ifstream in;
+        std::vector<char> buffer;
+        size_t pos = 0;
+        size_t end = 0;
+        uint64_t consumed = 0;
+    };
+
+} // namespace
+
+CrawlLog::CrawlLog(std::string path, std::chrono::milliseconds interval, Logger& logger)
+    : path(std::move(path)), interval(interval), logger(logger) {
+}
+
+CrawlLog::~CrawlLog() {
+    if (flusher.joinable()) close(false);
+}
+
+// Метод для воспроизведения журнала в два прохода: первый собирает отпечатки обработанных страниц, второй
+// передаёт URL обработчикам и пишет сжатый журнал рядом с исходным, который затем заменяется
+size_t CrawlLog::open(const SeenCallback& onSeen, const PendingCallback& onPending) {
+    auto started = std::chrono::steady_clock::now();
+    size_t pending = 0;
+    size_t seen = 0;
+    std::string tmp = path + ".tmp";
+
+    if (std::filesystem::exists(path)) {
+        // Первый проход: отпечатки обработанных страниц и длина целых записей
+        std::vector<uint64_t> done;
+        uint64_t validBytes = 0;
+        {
+            Reader reader(path);
+            char type;
+            while (reader.read(type)) {
+                uint64_t fingerprint;
+                if (type == addedRecord) {
+                    int32_t depth;
+                    uint32_t length;
+                    std::string url;
+                    if (!reader.read(fingerprint) || !reader.read(depth) || !reader.read(length)) break;
+                    url.resize(length);
+                    if (!reader.read(url.data(), length)) break;
+                }
+                else if (type == doneRecord || type == seenRecord) {
+                    if (!reader.read(fingerprint)) break;
+                    if (type == doneRecord) done.push_back(fingerprint);
+                }
+                else {
+                    break; // Повреждённая запись: дальше журнал не читается
+                }
+                validBytes = reader.offset();
+            }
+        }
+        std::sort(done.begin(), done.end());
+
+        // Второй проход: обработчики и сжатый журнал
+        std::ofstream compacted(tmp, std::ios::binary | std::ios::trunc);
+        std::string record;
+        Reader reader(path);
+        char type;
+        while (reader.offset() < validBytes && reader.read(type)) {
+            uint64_t fingerprint;
+            reader.read(fingerprint);
+            record.clear();
+            if (type == addedRecord) {
+                int32_t depth;
+                uint32_t length;
+                std::string url;
+                reader.read(depth);
+                reader.read(length);
+                url.resize(length);
+                reader.read(url.data(), length);
+
+                if (!std::binary_search(done.begin(), done.end(), fingerprint)) {
+                    record += addedRecord;
+                    appendValue(record, fingerprint);
+                    appendValue(record, depth);
+                    appendValue(record, length);
+                    record += url;
+                    onPending(std::move(url), depth);
+                    ++pending;
+                    compacted.write(record.data(), static_cast<std::streamsize>(record.size()));
+                    continue;
+                }
+            }
+            else if (type == doneRecord) {
+                continue; // Отпечаток уже учтён вместе с записью о добавлении
+            }
+
+            record += seenRecord;
+            appendValue(record, fingerprint);
+            onSeen(fingerprint);
+            ++seen;
+            compacted.write(record.data(), static_cast<std::streamsize>(record.size()));
+        }
+        compacted.close();
+        if (!compacted) throw std::runtime_error("Failed to write crawl state: " + tmp);
+        std::filesystem::rename(tmp, path);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        logger.info("Crawl state restored from " + path + ": " + std::to_string(pending) + " pending URLs, " +
+            std::to_string(seen) + " processed, in " + std::to_string(elapsed.count()) + " ms");
+    }
+
+    out.open(path, std::ios::binary | std::ios::app);
+    if (!out) throw std::runtime_error("Failed to open crawl state: " + path);
+    flusher = std::thread(&CrawlLog::flushLoop, this);
+    return pending;
+}
+
+void CrawlLog::added(const std::string& url, int depth, uint64_t fingerprint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer += addedRecord;
+    appendValue(buffer, fingerprint);
+    appendValue(buffer, static_cast<int32_t>(depth));
+    appendValue(buffer, static_cast<uint32_t>(url.size()));
+    buffer += url;
+}
+
+void CrawlLog::done(uint64_t fingerprint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer += doneRecord;
+    appendValue(buffer, fingerprint);
+}
+
+void CrawlLog::close(bool discard) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+
+    flush();
+    std::lock_guard<std::mutex> lock(fileMutex);
+    out.close();
+    if (discard) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+}
+
+void CrawlLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        stopCv.wait_for(lock, interval, [this]() { return stopping; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+// Буфер забирается под мьютексом целиком, а запись в файл идёт уже без него
+void CrawlLog::flush() {
+    std::string chunk;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunk.swap(buffer);
+    }
+    if (chunk.empty()) return;
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    out.flush();
+    if (!out) logger.error("Failed to write crawl state: " + path);
+}
@@ -1,168 +1,254 @@
 #include "crawler.hpp"
-#include "indexer.hpp"
 #include "utils.hpp"
 
-#include <boost/beast/core.hpp>        //    core  Boost.Beast
-#include <boost/beast/http.hpp>        //    HTTP 
-#include <boost/beast/version.hpp>     //      Boost.Beast
-#include <boost/asio/connect.hpp>      //     Boost.Asio
-#include <boost/asio/ip/tcp.hpp>       //    TCP-  Boost.Asio
-#include <regex>                       //     
-#include <unordered_set>               //   unordered_set
-#include <condition_variable>          //   condition_variable
-#include <atomic>                      //   
+#include <atomic>                      // Для атомарных переменных
+#include <chrono>
+#include <thread>
 
-using tcp = boost::asio::ip::tcp;    //     TCP
-namespace http = boost::beast::http; //    HTTP 
+namespace {
 
-//   Crawler    , ,     
+    constexpr std::chrono::seconds statsInterval(10); // Период вывода счётчиков очередей во время обхода
+
+} // namespace
+
+// Конструктор класса Crawler инициализирует его с конфигурацией, логером, базой данных и флагом работы
 Crawler::Crawler(const Config& config, Logger& logger, Database& db, std::atomic<bool>& running)
-    : config(config), logger(logger), db(db), running(running) {
+    : config(config), logger(logger), db(db),
+    ingest(config, logger, db, [this](const std::string& url) { frontier.stored(url); }), indexer(config, logger),
+    nearDuplicates(config.getNearDuplicateDistance()), running(running), frontier(config, logger, running) {
 }
 
-//   
+// Метод запуска краулера
+// Потоки-диспетчеры раздают URL из очередей хостов движку загрузки; страницы обрабатываются в потоках движка
+// по мере получения, поэтому медленный сайт занимает место в max_in_flight, но не поток
 void Crawler::start() {
-    while (running)
-    {
-        //   URL       
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            urlQueue.push({ config.getStartUrl(), 1 });
-            visited.insert(config.getStartUrl());
-        }
+    ingest.start(); // Запускаем потоки записи в базу данных
 
-        logger.info("Starting crawl from: " + config.getStartUrl());
-        logger.info("Timeout set to: " + std::to_string(config.getTimeout()) + "ms");
-
-        std::condition_variable queueCv;       //   
-        std::mutex queueCvMutex;               //    
-
-        std::vector<std::thread> workers;      //     
-        int numThreads = std::thread::hardware_concurrency(); //    
-        for (int i = 0; i < numThreads; ++i) {
-            //   
-            workers.emplace_back([this, &queueCv, &queueCvMutex]() {
-                while (true) {
-                    std::pair<std::string, int> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queueMutex);
-                        // ,         
-                        queueCv.wait(lock, [this]() { return !urlQueue.empty() || !running; });
-
-                        if (!running && urlQueue.empty())
-                            return; // ,   
-
-                        task = urlQueue.front(); //    
-                        urlQueue.pop();
-                    }
-
-                    //  ,   ,   
-                    if (task.second > config.getMaxDepth()) continue;
-
-                    try {
-                        logger.info("Fetching page: " + task.first);
-                        std::string html = fetchPage(task.first); //  
-                        if (html.empty()) {
-                            logger.error("Failed to fetch page: " + task.first);
-                            continue; //    ,   
-                        }
-
-                        indexPage(task.first, html); //  
-
-                        //     
-                        for (const auto& link : extractLinks(html, task.first)) {
-                            int nextDepth = task.second + 1;
-                            if (nextDepth > config.getMaxDepth()) continue;
-
-                            {
-                                std::lock_guard<std::mutex> lock(queueMutex);
-                                if (visited.contains(link)) continue; //    
-                                visited.insert(link);
-                                urlQueue.emplace(link, nextDepth); //     
-                            }
-                            queueCv.notify_one(); //   
-                            logger.info("Extracted link: " + link); //   
-                        }
-                    }
-                    catch (const std::exception& ex) {
-                        logger.error("Error crawling " + task.first + ": " + ex.what()); //  
-                    }
-                }
-                });
-        }
+    // Продолжаем прерванный обход или добавляем начальный URL в очередь (он же отмечается как посещённый)
+    size_t resumed = frontier.resume();
+    if (resumed > 0) {
+        logger.info("Resuming crawl: " + std::to_string(resumed) + " URLs in queue");
+    }
+    else if (config.getMaxDepth() >= 1) {
+        std::string startUrl = Utils::normalizeUrl(config.getStartUrl());
+        frontier.add(startUrl.empty() ? config.getStartUrl() : startUrl, 1);
+    }
 
-        //       
-        while (true) {
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                if (urlQueue.empty()) break; // ,   
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 
-        }
+    // Состояние страниц хранится в таблице pages, поэтому без записи в базу данных повторный обход не ведётся
+    if (config.isIncrementalRecrawl() && config.shouldWriteDatabase()) {
+        loadPageStates(resumed == 0);
+    }
 
-        running = false; //  
-        queueCv.notify_all(); //      
+    logger.info("Starting crawl from: " + config.getStartUrl());
+    logger.info("Timeout set to: " + std::to_string(config.getTimeout()) + "ms");
 
-        //     
-        for (auto& worker : workers) {
-            if (worker.joinable())
-                worker.join();
-        }
-        if (!running) {
-            break; //  ,  running == false
+    FetchEngine engine(config, logger); // Общий io_context и контекст TLS для всех загрузок
+
+    std::vector<std::thread> dispatchers;
+    for (size_t worker = 0; worker < frontier.dispatchers(); ++worker) {
+        dispatchers.emplace_back(&Crawler::dispatch, this, std::ref(engine), worker);
+    }
+
+    // Пока идёт обход, периодически выводим длину очередей
+    while (!frontier.waitFinished(statsInterval)) {
+        logFrontierStats(frontier.stats());
+    }
+    for (auto& thread : dispatchers) thread.join();
+
+    engine.stop(); // Дожидаемся завершения начатых загрузок
+    logFetchStats(engine.stats());
+    logFrontierStats(frontier.stats());
+    ingest.stop(); // Дожидаемся записи всех проиндексированных страниц (и их отметок в журнале состояния)
+    frontier.finish(); // Записываем журнал состояния (удаляем, если обход завершён)
+    logger.info("Near-duplicate pages skipped: " + std::to_string(nearDuplicatesSkipped.load()));
+    logger.info("Unchanged pages skipped: not modified " + std::to_string(notModified.load()) +
+        ", same content " + std::to_string(unchangedContent.load()));
+    running = false; // Останавливаем краулер
+    logger.info("Crawling finished."); // Логируем завершение работы
+}
+
+// Метод потока-диспетчера: задачи берутся, пока обход не завершён и не остановлен
+void Crawler::dispatch(FetchEngine& engine, size_t worker) {
+    Frontier::Task task;
+    while (frontier.next(worker, task)) {
+        logger.info("Fetching page: " + task.url);
+
+        // Сохранённая страница загружается условным запросом; страница без сохранённых ссылок (записана до
+        // появления столбца links) загружается целиком, чтобы ссылки было откуда взять при следующем ответе 304
+        FetchEngine::Validators validators;
+        const PageState* known = knownPage(task.url);
+        if (known && known->linksStored) {
+            validators.etag = known->etag;
+            validators.lastModified = known->lastModified;
         }
+
+        // Ждёт свободного места, если в полёте уже max_in_flight загрузок
+        engine.fetch(task.url, [this, url = task.url, depth = task.depth](FetchEngine::Result& result) {
+            bool queued = false;
+            try {
+                queued = processPage(url, depth, result);
+            }
+            catch (const std::exception& ex) {
+                logger.error("Error crawling " + url + ": " + ex.what()); // Логируем ошибку
+            }
+            frontier.done(url, queued); // Освобождаем место хоста (ссылки страницы уже в очереди)
+            }, std::move(validators));
+    }
+}
+
+// Метод для загрузки состояния сохранённых страниц: отпечатки SimHash возвращаются в индекс почти дубликатов,
+// а страницы ставятся в очередь со своей глубиной, поэтому проверяются и страницы за неизменившимися
+void Crawler::loadPageStates(bool enqueue) {
+    size_t queued = 0;
+    try {
+        db.scanPageStates([&](std::string_view url, const PageState& state) {
+            std::string page(url);
+            if (state.simhash != 0) nearDuplicates.remember(state.simhash);
+
+            // Глубина неизвестна (страница сохранена до появления столбца depth): ссылки страницы не разбираются
+            int depth = state.depth > 0 ? state.depth : config.getMaxDepth();
+            if (enqueue && depth <= config.getMaxDepth() && frontier.add(page, depth)) ++queued;
+            knownPages.emplace(SeenSet::fingerprint(page), state);
+            });
+    }
+    catch (const std::exception& ex) {
+        logger.error("Failed to load page states: " + std::string(ex.what()));
     }
-    logger.info("Crawling finished."); //   
+    logger.info("Known pages: " + std::to_string(knownPages.size()) +
+        ", queued for recrawl: " + std::to_string(queued));
+}
+
+const PageState* Crawler::knownPage(const std::string& url) const {
+    auto it = knownPages.find(SeenSet::fingerprint(url));
+    return it == knownPages.end() ? nullptr : &it->second;
 }
 
-//    HTML-    
-std::string Crawler::fetchPage(const std::string& url) {
-    auto future = std::async(std::launch::async, [&]() {
-        return Utils::httpGet(url, config.getTimeout()); //  HTTP GET-
-        });
+// Метод для вывода в лог счётчиков соединений: доля запросов по уже открытым соединениям и цена новых
+void Crawler::logFetchStats(const FetchEngine::Stats& stats) const {
+    auto percent = [](uint64_t part, uint64_t total) {
+        return std::to_string(total ? part * 100 / total : 0) + "%";
+    };
+    auto average = [](uint64_t micros, uint64_t count) {
+        return std::to_string(count ? micros / count : 0) + " us";
+    };
+    logger.info("Fetch stats: requests " + std::to_string(stats.requests) +
+        ", reused connections " + std::to_string(stats.reused) + " (" + percent(stats.reused, stats.requests) + ")" +
+        ", new connections " + std::to_string(stats.connections) +
+        ", average connect " + average(stats.connectMicros, stats.connections) +
+        ", TLS handshakes " + std::to_string(stats.tlsHandshakes) +
+        " (resumed " + percent(stats.tlsResumed, stats.tlsHandshakes) + ")" +
+        ", average handshake " + average(stats.handshakeMicros, stats.tlsHandshakes));
+}
+
+// Метод для вывода в лог счётчиков очередей: длина очередей, хосты и доля захватов блокировок с ожиданием
+void Crawler::logFrontierStats(const Frontier::Stats& stats) const {
+    uint64_t contendedPercent = stats.lockAcquisitions ? stats.lockContended * 100 / stats.lockAcquisitions : 0;
+    logger.info("Frontier stats: queued " + std::to_string(stats.queued) +
+        " (max " + std::to_string(stats.maxQueued) + ")" +
+        ", in flight " + std::to_string(stats.inFlight) +
+        ", hosts " + std::to_string(stats.hosts) +
+        ", visited " + std::to_string(stats.visited) +
+        " (" + std::to_string(stats.visited ? stats.visitedBytes / stats.visited : 0) + " bytes/URL" +
+        ", dropped " + std::to_string(stats.visitedDropped) + ")" +
+        ", dispatched " + std::to_string(stats.dispatched) +
+        " (stolen " + std::to_string(stats.stolen) + ")" +
+        ", idle waits " + std::to_string(stats.idleWaits) +
+        ", lock acquisitions " + std::to_string(stats.lockAcquisitions) +
+        " (contended " + std::to_string(stats.lockContended) + ", " + std::to_string(contendedPercent) + "%)");
+}
 
-    //      
-    if (future.wait_for(std::chrono::milliseconds(config.getTimeout())) == std::future_status::ready) {
-        return future.get(); //   
+// Метод для обработки загруженной страницы (вызывается в потоке движка загрузки)
+bool Crawler::processPage(const std::string& url, int depth, FetchEngine::Result& result) {
+    int nextDepth = depth + 1;
+    bool wantLinks = nextDepth <= config.getMaxDepth(); // Ссылки не глубже максимальной глубины
+    std::vector<std::string> links;
+    bool queued = false;
+
+    if (result.status == 304) {
+        ++notModified;
+        logger.info("Page not modified: " + url);
+        // Записи индекса страницы не меняются; её ссылки берутся из базы данных, поэтому снова загружаются
+        // и страницы, которые в прошлый раз не загрузились, оказались без слов или почти дубликатами
+        if (wantLinks) links = db.pageLinks(url);
+    }
+    else if (!result.error.empty() || result.body.empty()) {
+        logger.error("Failed to fetch page: " + url + (result.error.empty() ? "" : " (" + result.error + ")"));
+        return false; // Если страница не загружена, переходим к следующей
     }
     else {
-        logger.warn("Timeout occurred while fetching: " + url); //  
-        return ""; //      
+        // Индексируем страницу и в том же проходе извлекаем ссылки
+        links = indexPage(url, depth, result, wantLinks, queued);
     }
+
+    for (auto& link : links) {
+        if (!frontier.add(link, nextDepth)) continue; // Пропускаем уже посещённые ссылки
+        logger.info("Extracted link: " + link); // Логируем извлечённую ссылку
+    }
+    return queued;
 }
 
-//      HTML- 
-std::vector<std::string> Crawler::extractLinks(const std::string& html, const std::string& baseUrl) {
+// Метод для добавления ссылки со страницы: ссылка разрешается от URL страницы и нормализуется, поэтому одна
+// страница, найденная по разным написаниям URL, загружается один раз
+void Crawler::collectLink(std::string_view href, const std::string& baseUrl, std::vector<std::string>& links) {
+    std::string link = Utils::resolveRelativeUrl(baseUrl, std::string(href));
+    if (!link.empty()) links.push_back(std::move(link)); // Ссылки не на http(s) (mailto:, javascript:) пропускаются
+}
+
+// Метод для индексации страницы и сохранения её в базе данных
+// Возвращает ссылки страницы, найденные в том же проходе по HTML (если wantLinks)
+std::vector<std::string> Crawler::indexPage(const std::string& url, int depth, const FetchEngine::Result& result,
+    bool wantLinks, bool& queued) {
     std::vector<std::string> links;
-    std::regex hrefRegex(R"(<a\s+(?:[^>]*?\s+)?href=["'](.*?)["'])", std::regex::icase); //     
-    std::smatch match;
-    std::string::const_iterator searchStart(html.cbegin());
-
-    //     
-    while (std::regex_search(searchStart, html.cend(), match, hrefRegex)) {
-        std::string link = match[1]; //  
-        if (Utils::isHttpUrl(link)) {
-            links.push_back(link); //  
+    auto onLink = wantLinks
+        ? HtmlTokenizer::Callback([&](std::string_view href) { collectLink(href, result.url, links); })
+        : HtmlTokenizer::Callback();
+
+    // Содержимое не изменилось с прошлого обхода (сервер не поддерживает условные запросы): слова не считаются
+    const PageState* known = knownPage(url);
+    uint64_t contentHash = SeenSet::fingerprint(result.body);
+    if (known && known->contentHash == contentHash) {
+        ++unchangedContent;
+        logger.info("Page content unchanged: " + url);
+        if (wantLinks) {
+            thread_local HtmlTokenizer tokenizer;
+            tokenizer.scan(result.body, HtmlTokenizer::Callback(), onLink); // Только ссылки
         }
-        else if (Utils::isRelativeUrl(link)) {
-            links.push_back(Utils::resolveRelativeUrl(baseUrl, link)); //     
+        // Сервер мог сменить ETag или Last-Modified без изменения содержимого: сохраняем новые, иначе следующий
+        // обход снова загрузит страницу целиком
+        if (!known->linksStored || known->etag != result.validators.etag ||
+            known->lastModified != result.validators.lastModified) {
+            try {
+                db.updatePageState(url, result.validators.etag, result.validators.lastModified, links);
+            }
+            catch (const std::exception& ex) {
+                logger.error("Failed to update page state " + url + ": " + ex.what()); // Ссылки всё равно обходим
+            }
         }
-        searchStart = match.suffix().first;
+        return links;
     }
-    return links; //    
-}
 
-//          
-void Crawler::indexPage(const std::string& url, const std::string& content) {
     logger.info("Indexing: " + url);
-    Indexer indexer(config, logger); //  
-    auto words = indexer.extractWords(content); //    
+    auto words = indexer.extractWords(result.body, onLink); // Извлекаем слова и ссылки из контента
 
     if (words.empty()) {
-        logger.error("No words extracted from: " + url); //    ,  
-        return;
+        logger.error("No words extracted from: " + url); // Если слов не извлечено, логируем ошибку
+        return links;
+    }
+
+    logger.info("Extracted words count: " + std::to_string(words.size())); // Логируем количество извлечённых слов
+
+    // Почти дубликат уже сохранённой страницы (зеркало, другая обвязка) в индекс не попадает;
+    // прошлый отпечаток этой же страницы дубликатом не считается
+    uint64_t simhash = 0;
+    if (nearDuplicates.isNearDuplicate(words, known ? known->simhash : 0, &simhash)) {
+        ++nearDuplicatesSkipped;
+        logger.info("Near-duplicate page skipped: " + url);
+        return links;
     }
 
-    logger.info("Extracted words count: " + std::to_string(words.size())); //    
-    db.saveDocument(url, words); //    
+    // Передаём страницу потокам записи (ждём, если очередь заполнена)
+    // Ссылки сохраняются вместе со страницей: при ответе 304 они снова ставятся в очередь
+    queued = ingest.push({ url, std::move(words), depth, result.validators.etag, result.validators.lastModified,
+        contentHash, simhash, links });
+    return links;
 }
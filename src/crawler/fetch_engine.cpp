@@ -0,0 +1,498 @@
+#include "fetch_engine.hpp"
+#include "utils.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/version.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+namespace http = beast::http;
+
+using net::awaitable;
+using net::use_awaitable;
+using tcp = net::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    constexpr int maxRedirects = 10;                       // Наибольшее число перенаправлений
+    constexpr uint64_t maxBodySize = 8 * 1024 * 1024;      // Наибольший размер тела страницы
+    constexpr std::chrono::minutes dnsTtl(5);              // Время жизни запомненных адресов хоста
+    constexpr std::chrono::seconds sweepInterval(1);       // Период проверки простаивающих соединений
+    constexpr size_t maxSessionsPerHost = 16;              // Наибольшее число запомненных сессий TLS хоста
+
+    bool isRedirect(http::status status) {
+        return status == http::status::moved_permanently || status == http::status::found ||
+            status == http::status::see_other || status == http::status::temporary_redirect ||
+            status == http::status::permanent_redirect;
+    }
+
+    // Число потоков по значению из конфигурации (0 — по числу ядер)
+    int threadsOrCores(int configured) {
+        return configured > 0 ? configured : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Ошибки, которыми заканчивается запрос по соединению, закрытому сервером за время простоя:
+    // сервер закрыл соединение до ответа (конец потока или сброс), запись в уже закрытый сокет
+    bool isStaleConnection(const boost::system::error_code& ec) {
+        return ec == http::error::end_of_stream || ec == net::error::connection_reset || ec == net::error::broken_pipe;
+    }
+
+    uint64_t microsSince(Clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+    }
+
+} // namespace
+
+// Соединение: ровно один из потоков задан; буфер хранит данные, прочитанные сверх ответа
+// Сокет привязан к своему strand, и все операции с ним (подключение, рукопожатие, запрос и ответ) выполняют
+// сопрограммы, запущенные на этом strand, поэтому таймер таймаута и операции чтения не выполняются параллельно
+struct FetchEngine::Connection {
+    std::unique_ptr<beast::tcp_stream> plain;
+    std::unique_ptr<ssl::stream<beast::tcp_stream>> tls;
+    beast::flat_buffer buffer;
+    Clock::time_point idleSince;
+    bool sessionSaved = false;   // Сессия TLS этого соединения уже передана хосту
+
+    beast::tcp_stream& lowest() { return tls ? beast::get_lowest_layer(*tls) : *plain; }
+};
+
+struct FetchEngine::Target {
+    bool https = false;
+    std::string host;       // Имя хоста (для DNS и SNI)
+    std::string port;       // Порт (по умолчанию 80 или 443)
+    std::string authority;  // Значение заголовка Host
+    std::string path;       // Путь и строка запроса без фрагмента
+    std::string key;        // Ключ пула: схема://хост:порт
+};
+
+namespace {
+
+    // Отправка запроса и чтение ответа через открытое соединение (TCP или TLS)
+    // Возвращает true, если соединение можно использовать для следующего запроса
+    template<typename Stream>
+    awaitable<bool> exchange(Stream& stream, beast::flat_buffer& buffer, const std::string& authority,
+        const std::string& path, const FetchEngine::Validators& validators, FetchEngine::Result& result,
+        std::string& location) {
+        http::request<http::empty_body> req{ http::verb::get, path, 11 };
+        req.set(http::field::host, authority);                       // Устанавливаем заголовок Host
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING); // Устанавливаем заголовок User-Agent
+        // Условный запрос: валидаторы относятся к итоговой странице, поэтому отправляются и при перенаправлениях
+        if (!validators.etag.empty()) req.set(http::field::if_none_match, validators.etag);
+        if (!validators.lastModified.empty()) req.set(http::field::if_modified_since, validators.lastModified);
+        co_await http::async_write(stream, req, use_awaitable);
+
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(maxBodySize);
+        co_await http::async_read(stream, buffer, parser, use_awaitable);
+
+        auto& res = parser.get();
+        result.status = res.result_int();
+        if (isRedirect(res.result())) {
+            if (!res.base().count(http::field::location)) {
+                throw std::runtime_error("Redirect without Location header"); // Ошибка, если нет заголовка Location
+            }
+            location = std::string(res[http::field::location]);
+        }
+        else if (res.result() == http::status::ok) {
+            result.body = std::move(res.body());
+            result.validators.etag = std::string(res[http::field::etag]);
+            result.validators.lastModified = std::string(res[http::field::last_modified]);
+        }
+        co_return res.keep_alive();
+    }
+
+} // namespace
+
+// Конструктор: создаёт общий контекст TLS, запускает потоки io_context и закрытие простаивающих соединений
+FetchEngine::FetchEngine(const Config& config, Logger& logger)
+    : logger(logger),
+    timeout(std::max(1, config.getTimeout())),
+    maxInFlight(static_cast<size_t>(std::max(1, config.getMaxInFlight()))),
+    keepAlive(std::max(0, config.getKeepAliveSeconds())),
+    maxIdlePerHost(static_cast<size_t>(std::max(0, config.getMaxIdlePerHost()))),
+    work(boost::asio::make_work_guard(ioc)),
+    sslContext(ssl::context::sslv23_client),
+    sweepTimer(net::make_strand(ioc)),
+    handlers(static_cast<size_t>(threadsOrCores(config.getIndexThreads()))) {
+    sslContext.set_default_verify_paths(); // Пути к сертификатам читаются один раз на все загрузки
+    // Сессии возобновляются вручную (SSL_set_session), внутренний кэш клиенту не нужен
+    SSL_CTX_set_session_cache_mode(sslContext.native_handle(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+
+    net::co_spawn(sweepTimer.get_executor(), sweep(), net::detached);
+
+    int threadCount = threadsOrCores(config.getFetchThreads());
+    threads.reserve(static_cast<size_t>(threadCount));
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([this]() { ioc.run(); });
+    }
+    logger.info("Fetch engine started: threads " + std::to_string(threadCount) +
+        ", handler threads " + std::to_string(threadsOrCores(config.getIndexThreads())) +
+        ", max in flight " + std::to_string(maxInFlight));
+}
+
+FetchEngine::~FetchEngine() {
+    stop();
+}
+
+// Метод для запуска загрузки: ждёт свободного места и запускает сопрограмму на io_context
+void FetchEngine::fetch(std::string url, Callback callback, Validators validators) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [this]() { return inFlight < maxInFlight; });
+        ++inFlight;
+    }
+    net::co_spawn(ioc, run(std::move(url), std::move(validators), std::move(callback)), net::detached);
+}
+
+// Метод для остановки движка: начатые загрузки завершаются (не позже таймаута), затем потоки выходят
+void FetchEngine::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [this]() { return inFlight == 0; });
+    }
+    net::post(sweepTimer.get_executor(), [this]() {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stopping = true;
+        }
+        sweepTimer.cancel();
+        });
+    work.reset();
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
+    }
+    threads.clear();
+    handlers.join(); // Обработчики завершены (inFlight == 0), потоки пула просто выходят
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    hosts.clear(); // Закрываем свободные соединения
+}
+
+FetchEngine::Stats FetchEngine::stats() const {
+    Stats stats;
+    stats.requests = requests.load(std::memory_order_relaxed);
+    stats.reused = reused.load(std::memory_order_relaxed);
+    stats.connections = connections.load(std::memory_order_relaxed);
+    stats.tlsHandshakes = tlsHandshakes.load(std::memory_order_relaxed);
+    stats.tlsResumed = tlsResumed.load(std::memory_order_relaxed);
+    stats.connectMicros = connectMicros.load(std::memory_order_relaxed);
+    stats.handshakeMicros = handshakeMicros.load(std::memory_order_relaxed);
+    return stats;
+}
+
+awaitable<void> FetchEngine::run(std::string url, Validators validators, Callback callback) {
+    Result result = co_await get(std::move(url), std::move(validators));
+
+    // Обработчик разбирает страницу и может ждать места в очереди записи: выполняем его вне io_context
+    net::post(handlers, [this, result = std::move(result), callback = std::move(callback)]() mutable {
+        try {
+            callback(result);
+        }
+        catch (const std::exception& ex) {
+            logger.error("Error processing " + result.url + ": " + ex.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --inFlight;
+        }
+        slotFreed.notify_all();
+        });
+}
+
+FetchEngine::Target FetchEngine::parseUrl(const std::string& url) {
+    auto pos = url.find("://");
+    if (pos == std::string::npos) throw std::runtime_error("Invalid URL: " + url);
+
+    Target target;
+    std::string scheme = url.substr(0, pos);
+    if (scheme == "https") target.https = true;
+    else if (scheme != "http") throw std::runtime_error("Unsupported scheme: " + url);
+
+    auto end = url.find_first_of("/?#", pos + 3);
+    target.authority = url.substr(pos + 3, end == std::string::npos ? std::string::npos : end - pos - 3);
+    if (target.authority.empty()) throw std::runtime_error("Invalid URL: " + url);
+
+    target.path = end == std::string::npos ? "/" : url.substr(end);
+    target.path.erase(std::min(target.path.find('#'), target.path.size())); // Фрагмент серверу не передаётся
+    if (target.path.empty() || target.path[0] != '/') target.path.insert(0, "/");
+
+    // Явно указанный порт: host:port
+    auto colon = target.authority.rfind(':');
+    if (colon != std::string::npos && colon + 1 < target.authority.size() &&
+        target.authority.find_first_not_of("0123456789", colon + 1) == std::string::npos) {
+        target.host = target.authority.substr(0, colon);
+        target.port = target.authority.substr(colon + 1);
+    }
+    else {
+        target.host = target.authority;
+        target.port = target.https ? "443" : "80";
+    }
+    target.key = scheme + "://" + target.host + ":" + target.port;
+    return target;
+}
+
+// Загрузка с перенаправлениями; таймаут отсчитывается от начала первой попытки
+awaitable<FetchEngine::Result> FetchEngine::get(std::string url, Validators validators) {
+    Result result;
+    result.url = std::move(url);
+    auto deadline = Clock::now() + timeout;
+
+    try {
+        for (int redirects = 0;; ++redirects) {
+            std::string location;
+            co_await request(result.url, validators, result, location, deadline);
+            if (location.empty()) break;
+
+            if (redirects == maxRedirects) {
+                throw std::runtime_error("Too many redirects"); // Предотвращение зацикливания редиректов
+            }
+            std::string next = Utils::resolveRelativeUrl(result.url, location);
+            if (next.empty()) throw std::runtime_error("Invalid redirect location: " + location);
+            result.url = std::move(next);
+            result.status = 0;
+        }
+        if (result.status != 200 && result.status != 304) {
+            result.error = "Received non-200 response: " + std::to_string(result.status);
+        }
+    }
+    catch (const std::exception& ex) {
+        result.error = ex.what();
+        result.body.clear();
+    }
+    co_return result;
+}
+
+// Запрос через соединение из пула или новое соединение
+// Сервер мог закрыть простаивавшее соединение: тогда запрос один раз повторяется через новое
+// Повторяются только ошибки закрытого соединения: таймаут или ошибка TLS повторный запрос не исправит
+awaitable<void> FetchEngine::request(const std::string& url, const Validators& validators, Result& result,
+    std::string& location, Clock::time_point deadline) {
+    Target target = parseUrl(url);
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    for (bool retried = false;; retried = true) {
+        std::unique_ptr<Connection> connection = retried ? nullptr : takeIdle(target.key);
+        bool pooled = connection != nullptr;
+        if (pooled) {
+            reused.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            connection = co_await net::co_spawn(net::make_strand(ioc), connect(target, deadline), use_awaitable);
+        }
+
+        bool keepAlive = false;
+        bool stale = false;
+        try {
+            keepAlive = co_await net::co_spawn(connection->lowest().get_executor(),
+                transfer(*connection, target, validators, result, location, deadline), use_awaitable);
+        }
+        catch (const boost::system::system_error& ex) {
+            if (!pooled || !isStaleConnection(ex.code()) || Clock::now() >= deadline) throw;
+            stale = true;
+        }
+        if (stale) {
+            reused.fetch_sub(1, std::memory_order_relaxed);
+            result.status = 0;
+            location.clear();
+            continue;
+        }
+
+        // Билет TLS 1.3 приходит после рукопожатия, поэтому сессию запоминаем после первого ответа
+        if (connection->tls && !connection->sessionSaved) {
+            connection->sessionSaved = true;
+            SSL_SESSION* session = SSL_get1_session(connection->tls->native_handle());
+            if (session && SSL_SESSION_is_resumable(session)) {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                auto& sessions = hosts[target.key].sessions;
+                if (sessions.size() == maxSessionsPerHost) sessions.erase(sessions.begin()); // Вытесняем самую старую
+                sessions.emplace_back(session, SSL_SESSION_free);
+            }
+            else if (session) {
+                SSL_SESSION_free(session);
+            }
+        }
+
+        if (keepAlive) release(target.key, std::move(connection));
+        co_return;
+    }
+}
+
+// Запрос и ответ по соединению; выполняется на strand соединения
+awaitable<bool> FetchEngine::transfer(Connection& connection, const Target& target, const Validators& validators,
+    Result& result, std::string& location, Clock::time_point deadline) {
+    connection.lowest().expires_at(deadline);
+    if (connection.tls) {
+        co_return co_await exchange(*connection.tls, connection.buffer, target.authority, target.path, validators,
+            result, location);
+    }
+    co_return co_await exchange(*connection.plain, connection.buffer, target.authority, target.path, validators,
+        result, location);
+}
+
+// Новое соединение создаётся на strand сопрограммы, которая его открывает
+awaitable<std::unique_ptr<FetchEngine::Connection>> FetchEngine::connect(const Target& target,
+    Clock::time_point deadline) {
+    auto endpoints = co_await resolve(target, deadline);
+
+    auto connection = std::make_unique<Connection>();
+    auto strand = co_await net::this_coro::executor;
+    if (target.https) {
+        connection->tls = std::make_unique<ssl::stream<beast::tcp_stream>>(strand, sslContext);
+    }
+    else {
+        connection->plain = std::make_unique<beast::tcp_stream>(strand);
+    }
+    auto& stream = connection->lowest();
+    stream.expires_at(deadline);
+
+    auto started = Clock::now();
+    try {
+        co_await stream.async_connect(endpoints, use_awaitable);
+    }
+    catch (const boost::system::system_error&) {
+        // Адреса могли устареть: при следующем подключении имя разрешается заново
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = hosts.find(target.key);
+        if (it != hosts.end()) it->second.endpoints = {};
+        throw;
+    }
+    connectMicros.fetch_add(microsSince(started), std::memory_order_relaxed);
+    connections.fetch_add(1, std::memory_order_relaxed);
+
+    if (target.https) {
+        SSL* ssl = connection->tls->native_handle();
+        // Имя сервера для TLS (SNI): без него многие хосты отдают чужой сертификат или рвут соединение
+        if (!SSL_set_tlsext_host_name(ssl, target.host.c_str())) {
+            throw std::runtime_error("Failed to set SNI host name: " + target.host);
+        }
+        // Билеты TLS 1.3 одноразовые: сессия отдаётся одному соединению, а оно после ответа вернёт новую
+        std::shared_ptr<SSL_SESSION> session;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            auto it = hosts.find(target.key);
+            if (it != hosts.end() && !it->second.sessions.empty()) {
+                session = std::move(it->second.sessions.back());
+                it->second.sessions.pop_back();
+            }
+        }
+        if (session) SSL_set_session(ssl, session.get());
+
+        started = Clock::now();
+        co_await connection->tls->async_handshake(ssl::stream_base::client, use_awaitable);
+        handshakeMicros.fetch_add(microsSince(started), std::memory_order_relaxed);
+        tlsHandshakes.fetch_add(1, std::memory_order_relaxed);
+        if (SSL_session_reused(ssl)) {
+            tlsResumed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    co_return connection;
+}
+
+awaitable<tcp::resolver::results_type> FetchEngine::resolve(const Target& target, Clock::time_point deadline) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = hosts.find(target.key);
+        if (it != hosts.end() && !it->second.endpoints.empty() && Clock::now() - it->second.resolvedAt < dnsTtl) {
+            co_return it->second.endpoints;
+        }
+    }
+
+    // Резолвер не знает таймаутов: по истечении срока его отменяет таймер
+    auto executor = co_await net::this_coro::executor;
+    auto resolver = std::make_shared<tcp::resolver>(executor);
+    net::steady_timer guard(executor);
+    guard.expires_at(deadline);
+    guard.async_wait([resolver](boost::system::error_code ec) {
+        if (!ec) resolver->cancel();
+        });
+
+    tcp::resolver::results_type endpoints;
+    try {
+        endpoints = co_await resolver->async_resolve(target.host, target.port, use_awaitable);
+    }
+    catch (const boost::system::system_error& ex) {
+        if (ex.code() == net::error::operation_aborted) {
+            throw std::runtime_error("Timeout resolving " + target.host);
+        }
+        throw;
+    }
+    guard.cancel();
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto& host = hosts[target.key];
+    host.endpoints = endpoints;
+    host.resolvedAt = Clock::now();
+    co_return endpoints;
+}
+
+// Выдаёт самое свежее свободное соединение хоста; простаивавшие дольше keep_alive_seconds закрываются
+std::unique_ptr<FetchEngine::Connection> FetchEngine::takeIdle(const std::string& key) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = hosts.find(key);
+    if (it == hosts.end()) return nullptr;
+
+    auto& idle = it->second.idle;
+    auto now = Clock::now();
+    while (!idle.empty()) {
+        auto connection = std::move(idle.back());
+        idle.pop_back();
+        if (now - connection->idleSince < keepAlive) return connection;
+        idle.clear(); // Остальные простаивают ещё дольше
+    }
+    return nullptr;
+}
+
+void FetchEngine::release(const std::string& key, std::unique_ptr<Connection> connection) {
+    connection->idleSince = Clock::now();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto& idle = hosts[key].idle;
+    if (!stopping && idle.size() < maxIdlePerHost) {
+        idle.push_back(std::move(connection));
+    }
+}
+
+void FetchEngine::evictIdle(Clock::time_point now) {
+    for (auto it = hosts.begin(); it != hosts.end();) {
+        auto& host = it->second;
+        auto fresh = std::find_if(host.idle.begin(), host.idle.end(),
+            [&](const auto& connection) { return now - connection->idleSince < keepAlive; });
+        host.idle.erase(host.idle.begin(), fresh);
+
+        // Хост без соединений и с устаревшими адресами больше не нужен
+        if (host.idle.empty() && now - host.resolvedAt >= dnsTtl) {
+            it = hosts.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+awaitable<void> FetchEngine::sweep() {
+    while (true) {
+        sweepTimer.expires_after(sweepInterval);
+        boost::system::error_code ec;
+        co_await sweepTimer.async_wait(net::redirect_error(use_awaitable, ec));
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (stopping) co_return;
+        evictIdle(Clock::now());
+    }
+}
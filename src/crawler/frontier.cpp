@@ -0,0 +1,259 @@
+#include "frontier.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+    constexpr size_t stripeCount = 64;                      // Полосы множества посещённых URL
+    constexpr std::chrono::milliseconds maxIdleWait(100);   // Наибольшее ожидание без проверки флага работы
+
+} // namespace
+
+// Конструктор класса Frontier: шарды хостов и полосы множества посещённых URL создаются сразу
+Frontier::Frontier(const Config& config, Logger& logger, std::atomic<bool>& running)
+    : running(running),
+    workerCount(static_cast<size_t>(std::max(1, config.getDispatchThreads()))),
+    maxPerHost(static_cast<size_t>(std::max(1, config.getMaxPerHost()))),
+    hostDelay(std::max(0, config.getHostDelayMs())) {
+    // Шардов не меньше, чем диспетчеров: у каждого диспетчера есть свои
+    size_t shardCount = std::max(workerCount, static_cast<size_t>(std::max(1, config.getFrontierShards())));
+    for (size_t i = 0; i < shardCount; ++i) shards.push_back(std::make_unique<Shard>());
+
+    // Бюджет множества посещённых URL делится между полосами поровну
+    size_t stripeBudget = static_cast<size_t>(std::max(1, config.getSeenMemoryMb())) * 1024 * 1024 / stripeCount;
+    for (size_t i = 0; i < stripeCount; ++i) {
+        stripes.push_back(std::make_unique<Stripe>(stripeBudget, config.getSeenFalsePositiveRate()));
+    }
+
+    if (!config.getStateFile().empty()) {
+        log = std::make_unique<CrawlLog>(config.getStateFile(),
+            std::chrono::milliseconds(std::max(1, config.getCheckpointIntervalMs())), logger);
+    }
+}
+
+size_t Frontier::resume() {
+    if (!log) return 0;
+    return log->open(
+        [this](uint64_t fingerprint) {
+            stripes[fingerprint % stripes.size()]->urls.insert(fingerprint);
+        },
+        [this](std::string url, int depth) {
+            uint64_t fingerprint = SeenSet::fingerprint(url);
+            stripes[fingerprint % stripes.size()]->urls.insert(fingerprint);
+            enqueue(std::move(url), depth);
+        });
+}
+
+// Обход завершён полностью, если после остановки загрузок не осталось URL в очередях
+void Frontier::finish() {
+    if (log) log->close(outstanding.load() == 0);
+}
+
+bool Frontier::add(std::string url, int depth) {
+    {
+        // Полосу выбирают младшие биты отпечатка, слот внутри полосы — старшие
+        uint64_t fingerprint = SeenSet::fingerprint(url);
+        Stripe& stripe = *stripes[fingerprint % stripes.size()];
+        auto lock = lockCounted(stripe.mutex);
+        if (!stripe.urls.insert(fingerprint)) return false; // URL уже встречался
+        if (log) log->added(url, depth, fingerprint);       // До записи об обработке страницы, где найден URL
+    }
+
+    enqueue(std::move(url), depth);
+    wakeUp(false);
+    return true;
+}
+
+void Frontier::enqueue(std::string url, int depth) {
+    // Задача учитывается до постановки в очередь: диспетчер не увидит обход завершённым, пока она не выполнена
+    outstanding.fetch_add(1);
+    size_t depthNow = queued.fetch_add(1) + 1;
+    size_t peak = maxQueued.load(std::memory_order_relaxed);
+    while (depthNow > peak && !maxQueued.compare_exchange_weak(peak, depthNow, std::memory_order_relaxed)) {
+    }
+
+    std::string key = hostKey(url);
+    {
+        Shard& shard = shardFor(key);
+        auto lock = lockCounted(shard.mutex);
+        Host& host = shard.hosts[key];
+        host.queue.push_back({ std::move(url), depth });
+        shard.queued.fetch_add(1, std::memory_order_relaxed);
+        schedule(shard, host);
+    }
+}
+
+// Метод для получения задачи: сначала свои шарды диспетчера, затем чужие (начиная с соседнего);
+// если готовых хостов нет, диспетчер спит до ближайшего времени готовности или до изменения очередей
+bool Frontier::next(size_t worker, Task& task) {
+    while (true) {
+        if (!running || outstanding.load() == 0) return false;
+
+        uint64_t seen = version.load();
+        auto now = Clock::now();
+        auto wake = now + maxIdleWait;
+
+        for (size_t i = worker; i < shards.size(); i += workerCount) {
+            if (take(*shards[i], task, now, wake)) {
+                dispatched.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t step = 1; step < shards.size(); ++step) {
+            size_t i = (worker + step) % shards.size();
+            if (i % workerCount == worker) continue; // Свои шарды уже проверены
+            if (take(*shards[i], task, now, wake)) {
+                dispatched.fetch_add(1, std::memory_order_relaxed);
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        idleWaits.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(waitMutex);
+        sleepers.fetch_add(1);
+        wakeCv.wait_until(lock, wake, [&]() {
+            return version.load() != seen || !running || outstanding.load() == 0;
+            });
+        sleepers.fetch_sub(1);
+    }
+}
+
+void Frontier::done(const std::string& url, bool pendingWrite) {
+    std::string key = hostKey(url);
+    {
+        Shard& shard = shardFor(key);
+        auto lock = lockCounted(shard.mutex);
+        auto it = shard.hosts.find(key);
+        if (it != shard.hosts.end()) {
+            --it->second.inFlight;
+            schedule(shard, it->second); // У хоста освободилось место
+        }
+    }
+    if (log && !pendingWrite) log->done(SeenSet::fingerprint(url));
+    wakeUp(outstanding.fetch_sub(1) == 1); // Последняя задача — будим всех
+}
+
+void Frontier::stored(const std::string& url) {
+    if (log) log->done(SeenSet::fingerprint(url));
+}
+
+bool Frontier::waitFinished(std::chrono::milliseconds timeout) {
+    auto deadline = Clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(waitMutex);
+    while (true) {
+        if (!running || outstanding.load() == 0) return true;
+        auto now = Clock::now();
+        if (now >= deadline) return false;
+        finishedCv.wait_until(lock, std::min(deadline, now + maxIdleWait));
+    }
+}
+
+Frontier::Stats Frontier::stats() const {
+    Stats result;
+    result.queued = queued.load(std::memory_order_relaxed);
+    result.maxQueued = maxQueued.load(std::memory_order_relaxed);
+    size_t total = outstanding.load(std::memory_order_relaxed);
+    result.inFlight = total > result.queued ? total - result.queued : 0;
+    result.dispatched = dispatched.load(std::memory_order_relaxed);
+    result.stolen = stolen.load(std::memory_order_relaxed);
+    result.idleWaits = idleWaits.load(std::memory_order_relaxed);
+    result.lockAcquisitions = lockAcquisitions.load(std::memory_order_relaxed);
+    result.lockContended = lockContended.load(std::memory_order_relaxed);
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result.hosts += shard->hosts.size();
+    }
+    for (const auto& stripe : stripes) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        result.visited += stripe->urls.size();
+        result.visitedBytes += stripe->urls.bytes();
+        result.visitedDropped += stripe->urls.dropped();
+    }
+    return result;
+}
+
+// Ключ хоста: схема и хост в нижнем регистре и порт (явный или по умолчанию), как в пуле соединений
+std::string Frontier::hostKey(const std::string& url) {
+    auto pos = url.find("://");
+    if (pos == std::string::npos) return {};
+
+    auto start = pos + 3;
+    auto end = url.find_first_of("/?#", start);
+    std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    auto at = authority.rfind('@');
+    if (at != std::string::npos) authority.erase(0, at + 1); // Данные пользователя на хост не влияют
+
+    std::string key = url.substr(0, pos) + "://" + authority;
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+    // Порт по умолчанию (двоеточие внутри [IPv6] портом не считается)
+    auto colon = authority.rfind(':');
+    auto bracket = authority.rfind(']');
+    if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket)) {
+        key += key.compare(0, 8, "https://") == 0 ? ":443" : ":80";
+    }
+    return key;
+}
+
+Frontier::Shard& Frontier::shardFor(const std::string& key) {
+    return *shards[std::hash<std::string>{}(key) % shards.size()];
+}
+
+std::unique_lock<std::mutex> Frontier::lockCounted(std::mutex& mutex) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        lockContended.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+    lockAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    return lock;
+}
+
+void Frontier::schedule(Shard& shard, Host& host) {
+    if (host.scheduled || host.queue.empty() || host.inFlight >= maxPerHost) return;
+    shard.ready.push({ host.nextAllowed, &host });
+    host.scheduled = true;
+}
+
+bool Frontier::take(Shard& shard, Task& task, Clock::time_point now, Clock::time_point& wake) {
+    if (shard.queued.load(std::memory_order_relaxed) == 0) return false; // Пустой шард не захватываем
+
+    auto lock = lockCounted(shard.mutex);
+    if (shard.ready.empty()) return false;
+    Ready top = shard.ready.top();
+    if (top.at > now) {
+        wake = std::min(wake, top.at); // Хост ещё выдерживает паузу
+        return false;
+    }
+    shard.ready.pop();
+
+    Host& host = *top.host;
+    host.scheduled = false;
+    task = std::move(host.queue.front());
+    host.queue.pop_front();
+    shard.queued.fetch_sub(1, std::memory_order_relaxed);
+    queued.fetch_sub(1);
+    ++host.inFlight;
+    host.nextAllowed = now + hostDelay;
+    schedule(shard, host); // Хост возвращается в кучу, если у него остались URL и место
+    return true;
+}
+
+// Диспетчер проверяет version перед сном под waitMutex, а оповещающий меняет version до проверки sleepers,
+// поэтому оповещение не теряется
+void Frontier::wakeUp(bool all) {
+    version.fetch_add(1);
+    if (!all && sleepers.load() == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+    }
+    if (all) {
+        wakeCv.notify_all();
+        finishedCv.notify_all();
+    }
+    else {
+        wakeCv.notify_one();
+    }
+}
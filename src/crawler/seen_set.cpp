@@ -0,0 +1,112 @@
+#include "seen_set.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+    constexpr size_t initialSlots = 1024;   // Начальный размер таблицы
+    constexpr size_t minSlots = 64;         // Наименьший размер таблицы при крошечном бюджете
+    constexpr double growLoad = 0.75;       // Заполненность, при которой таблица расширяется
+    constexpr double maxLoad = 0.85;        // Предельная заполненность таблицы, упёршейся в бюджет
+
+    // Наибольшая степень двойки, не превосходящая value (value > 0)
+    size_t floorPow2(size_t value) {
+        return size_t(1) << (std::bit_width(value) - 1);
+    }
+
+} // namespace
+
+SeenSet::SeenSet(size_t memoryBudget, double falsePositiveRate) {
+    // Вероятность ложного срабатывания 32-битного отпечатка при n отпечатках в таблице — n / 2^32
+    size_t narrowMax = std::clamp(floorPow2(std::max<size_t>(memoryBudget / sizeof(uint32_t), 1)), minSlots, size_t(1) << 31);
+    wide = static_cast<double>(narrowMax) * maxLoad / 4294967296.0 > falsePositiveRate;
+    maxSlots = wide ? std::max(floorPow2(std::max<size_t>(memoryBudget / sizeof(uint64_t), 1)), minSlots) : narrowMax;
+}
+
+// MurmurHash64A: по 8 байт за шаг, старшие биты результата хорошо перемешаны
+uint64_t SeenSet::fingerprint(std::string_view url) {
+    constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+    constexpr int r = 47;
+
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ (url.size() * m);
+    const char* data = url.data();
+    size_t blocks = url.size() / 8;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k;
+        std::memcpy(&k, data + i * 8, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        hash ^= k;
+        hash *= m;
+    }
+
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(data + blocks * 8);
+    switch (url.size() & 7) {
+    case 7: hash ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+    case 6: hash ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+    case 5: hash ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+    case 4: hash ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+    case 3: hash ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+    case 2: hash ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+    case 1: hash ^= uint64_t(tail[0]);
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+    return hash;
+}
+
+bool SeenSet::insert(uint64_t fingerprint) {
+    return wide ? insertInto(wideSlots, fingerprint) : insertInto(narrowSlots, fingerprint);
+}
+
+size_t SeenSet::bytes() const {
+    return narrowSlots.capacity() * sizeof(uint32_t) + wideSlots.capacity() * sizeof(uint64_t);
+}
+
+template<typename Slot>
+bool SeenSet::insertInto(std::vector<Slot>& slots, uint64_t fingerprint) {
+    constexpr int bits = sizeof(Slot) * 8;
+    if (slots.empty()) slots.assign(std::min(initialSlots, maxSlots), 0);
+    if (static_cast<double>(count + 1) > slots.size() * growLoad && slots.size() < maxSlots) grow(slots);
+
+    Slot value = static_cast<Slot>(fingerprint >> (64 - bits));
+    if (value == 0) value = 1; // 0 обозначает пустой слот
+
+    // Номер слота — старшие биты отпечатка
+    int shift = bits - std::countr_zero(slots.size());
+    size_t mask = slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(value >> shift);; slot = (slot + 1) & mask) {
+        if (slots[slot] == value) return false; // Отпечаток уже есть
+        if (slots[slot] == 0) {
+            if (static_cast<double>(count + 1) > slots.size() * maxLoad) {
+                ++droppedCount; // Бюджет исчерпан
+                return false;
+            }
+            slots[slot] = value;
+            ++count;
+            return true;
+        }
+    }
+}
+
+// Расширение вдвое: номер слота заново берётся из старших битов каждого отпечатка
+template<typename Slot>
+void SeenSet::grow(std::vector<Slot>& slots) {
+    constexpr int bits = sizeof(Slot) * 8;
+    std::vector<Slot> larger(slots.size() * 2, 0);
+    int shift = bits - std::countr_zero(larger.size());
+    size_t mask = larger.size() - 1;
+    for (Slot value : slots) {
+        if (value == 0) continue;
+        size_t slot = static_cast<size_t>(value >> shift);
+        while (larger[slot] != 0) slot = (slot + 1) & mask;
+        larger[slot] = value;
+    }
+    slots.swap(larger);
+}
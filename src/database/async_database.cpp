@@ -0,0 +1,277 @@
+#include "async_database.hpp"
+#include "bm25.hpp"
+#include "database.hpp"
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+
+using boost::asio::awaitable;
+using boost::asio::use_awaitable;
+using stream_protocol = boost::asio::generic::stream_protocol;
+
+namespace {
+
+    // Литерал массива PostgreSQL для параметра text[]: {"a","b"} с экранированием кавычек и обратной косой черты
+    std::string toArrayLiteral(const std::vector<std::string>& values) {
+        std::string literal = "{";
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) literal += ',';
+            literal += '"';
+            for (char ch : values[i]) {
+                if (ch == '"' || ch == '\\') literal += '\\';
+                literal += ch;
+            }
+            literal += '"';
+        }
+        literal += '}';
+        return literal;
+    }
+
+    // Число с точкой в качестве разделителя: std::to_string зависит от локали, а сервер ставит ru_RU
+    std::string formatFloat(float value) {
+        char buffer[32];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, ec == std::errc() ? end : buffer);
+    }
+
+} // namespace
+
+// Ожидающая сопрограмма: обработчик завершения, которому передаётся соединение
+// (nullptr — свободное место в пуле, соединение нужно открыть самому)
+struct AsyncDatabase::Waiter {
+    virtual ~Waiter() = default;
+    virtual void complete(std::unique_ptr<Connection> connection) = 0;
+};
+
+AsyncDatabase::Connection::~Connection() {
+    // Сокетом владеет libpq: отвязываем его от Asio, чтобы он не был закрыт дважды
+    if (socket) {
+        boost::system::error_code ec;
+        socket->release(ec);
+    }
+    if (conn) PQfinish(conn);
+}
+
+// Конструктор класса AsyncDatabase
+AsyncDatabase::AsyncDatabase(boost::asio::any_io_executor executor, const Config& config, Logger& logger)
+    : executor(std::move(executor)),
+    connectionString(config.getDbConnectionString()),
+    capacity(static_cast<size_t>(std::max(1, config.getDbAsyncConnections()))),
+    logger(logger) {
+}
+
+AsyncDatabase::~AsyncDatabase() = default;
+
+std::runtime_error AsyncDatabase::error(const Connection& connection, const std::string& what) {
+    std::string message = connection.conn ? PQerrorMessage(connection.conn) : "";
+    while (!message.empty() && (message.back() == '\n' || message.back() == ' ')) message.pop_back();
+    return std::runtime_error(what + (message.empty() ? "" : ": " + message));
+}
+
+// Выдача соединения: свободное, право открыть новое или ожидание, пока другое соединение вернут
+awaitable<std::unique_ptr<AsyncDatabase::Connection>> AsyncDatabase::acquire() {
+    auto connection = co_await boost::asio::async_initiate<decltype(use_awaitable), void(std::unique_ptr<Connection>)>(
+        [this](auto handler) {
+            using Handler = decltype(handler);
+
+            // Обработчик вызывается через post: release может выполняться в другом потоке и под мьютексом
+            struct Pending : Waiter {
+                explicit Pending(Handler h) : handler(std::move(h)) {}
+                void complete(std::unique_ptr<Connection> connection) override {
+                    auto executor = boost::asio::get_associated_executor(handler);
+                    boost::asio::post(executor, [h = std::move(handler), c = std::move(connection)]() mutable {
+                        h(std::move(c));
+                        });
+                }
+                Handler handler;
+            };
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                auto connection = std::move(idle.back());
+                idle.pop_back();
+                lock.unlock();
+                Pending(std::move(handler)).complete(std::move(connection));
+            }
+            else if (created < capacity) {
+                created++;
+                lock.unlock();
+                Pending(std::move(handler)).complete(nullptr);
+            }
+            else {
+                waiters.push_back(std::make_unique<Pending>(std::move(handler)));
+            }
+        },
+        use_awaitable);
+
+    if (!connection) {
+        connection = std::make_unique<Connection>();
+        try {
+            co_await connect(*connection);
+        }
+        catch (...) {
+            release(nullptr); // Место в пуле освобождается для следующей попытки
+            throw;
+        }
+    }
+    co_return connection;
+}
+
+// Возврат соединения; nullptr — соединение потеряно, его место освобождается
+void AsyncDatabase::release(std::unique_ptr<Connection> connection) {
+    std::unique_ptr<Waiter> waiter;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!waiters.empty()) {
+            waiter = std::move(waiters.front()); // Соединение (или место для нового) сразу передаём ожидающему
+            waiters.pop_front();
+        }
+        else if (connection) {
+            idle.push_back(std::move(connection));
+        }
+        else {
+            created--;
+        }
+    }
+    if (waiter) waiter->complete(std::move(connection));
+}
+
+// Привязка сокета libpq к io_context
+void AsyncDatabase::attachSocket(Connection& connection) {
+    int fd = PQsocket(connection.conn);
+    if (fd < 0) throw error(connection, "Нет сокета соединения с базой данных");
+    if (connection.socket && static_cast<int>(connection.socket->native_handle()) == fd) return;
+
+    if (connection.socket) {
+        boost::system::error_code ec;
+        connection.socket->release(ec);
+    }
+    // Семейство адресов берём у самого сокета: libpq подключается по IPv4, IPv6 или через Unix-сокет
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        throw error(connection, "Не удалось определить тип сокета соединения с базой данных");
+    }
+    connection.socket = std::make_unique<stream_protocol::socket>(executor);
+    connection.socket->assign(stream_protocol(address.ss_family, SOCK_STREAM), fd);
+}
+
+// Неблокирующее подключение: PQconnectPoll говорит, какой готовности сокета ждать дальше
+awaitable<void> AsyncDatabase::connect(Connection& connection) {
+    connection.conn = PQconnectStart(connectionString.c_str());
+    if (!connection.conn || PQstatus(connection.conn) == CONNECTION_BAD) {
+        throw error(connection, "Ошибка подключения к базе данных");
+    }
+
+    PostgresPollingStatusType status = PGRES_POLLING_WRITING;
+    while (status != PGRES_POLLING_OK) {
+        if (status == PGRES_POLLING_FAILED) throw error(connection, "Ошибка подключения к базе данных");
+        attachSocket(connection); // При переборе адресов libpq может сменить сокет
+        co_await connection.socket->async_wait(
+            status == PGRES_POLLING_READING ? stream_protocol::socket::wait_read : stream_protocol::socket::wait_write, use_awaitable);
+        status = PQconnectPoll(connection.conn);
+    }
+    attachSocket(connection);
+    if (PQsetnonblocking(connection.conn, 1) != 0) throw error(connection, "Не удалось перевести соединение в неблокирующий режим");
+
+    // Подготавливаем поисковый запрос один раз на соединение
+    if (!PQsendPrepare(connection.conn, "search", Database::searchQuery, 7, nullptr)) {
+        throw error(connection, "Ошибка подготовки запроса");
+    }
+    Result result = co_await finish(connection);
+    if (!result || PQresultStatus(result.get()) != PGRES_COMMAND_OK) {
+        throw error(connection, "Ошибка подготовки запроса");
+    }
+    connection.prepared = true;
+    logger.info("Открыто асинхронное соединение с базой данных");
+}
+
+// Отправка запроса и ожидание всех его результатов без блокировки потока
+awaitable<AsyncDatabase::Result> AsyncDatabase::finish(Connection& connection) {
+    // Данные запроса могут не уйти в сокет сразу
+    while (true) {
+        int flushed = PQflush(connection.conn);
+        if (flushed == 0) break;
+        if (flushed < 0) throw error(connection, "Ошибка отправки запроса");
+        co_await connection.socket->async_wait(stream_protocol::socket::wait_write, use_awaitable);
+    }
+
+    // Читаем, пока libpq не соберёт все результаты; последний результат — итог запроса
+    Result last;
+    while (true) {
+        while (PQisBusy(connection.conn)) {
+            co_await connection.socket->async_wait(stream_protocol::socket::wait_read, use_awaitable);
+            if (!PQconsumeInput(connection.conn)) throw error(connection, "Ошибка чтения ответа базы данных");
+        }
+        PGresult* result = PQgetResult(connection.conn);
+        if (!result) break;
+        last.reset(result);
+    }
+    co_return last;
+}
+
+// Метод поиска
+awaitable<SearchPage> AsyncDatabase::search(std::vector<std::string> queryWords, size_t limit, size_t offset,
+    std::string cursor) {
+    SearchPage page;
+    if (queryWords.empty() || limit == 0) co_return page;
+
+    std::string afterScore, afterUrl;
+    if (!cursor.empty() && !Database::decodeCursor(cursor, afterScore, afterUrl)) {
+        throw std::invalid_argument("Некорректный курсор");
+    }
+
+    // Убираем повторы: запрос сравнивает число найденных слов с размером массива
+    std::sort(queryWords.begin(), queryWords.end());
+    queryWords.erase(std::unique(queryWords.begin(), queryWords.end()), queryWords.end());
+
+    std::string terms = toArrayLiteral(queryWords);
+    std::string k1 = formatFloat(Bm25::kK1);
+    std::string b = formatFloat(Bm25::kB);
+    std::string limitText = std::to_string(limit);
+    std::string offsetText = std::to_string(offset);
+    const char* values[] = { terms.c_str(), k1.c_str(), b.c_str(), limitText.c_str(), offsetText.c_str(),
+        cursor.empty() ? nullptr : afterScore.c_str(), cursor.empty() ? nullptr : afterUrl.c_str() }; // nullptr — NULL
+
+    auto connection = co_await acquire();
+    Result result;
+    std::exception_ptr failure;
+    try {
+        if (!PQsendQueryPrepared(connection->conn, "search", 7, values, nullptr, nullptr, 0)) {
+            throw error(*connection, "Ошибка отправки запроса");
+        }
+        result = co_await finish(*connection);
+        if (!result || PQresultStatus(result.get()) != PGRES_TUPLES_OK) {
+            throw std::runtime_error(std::string("Ошибка поиска: ") + (result ? PQresultErrorMessage(result.get()) : ""));
+        }
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+
+    // Разорванное соединение в пул не возвращаем: его место займёт новое
+    if (failure && PQstatus(connection->conn) != CONNECTION_OK) {
+        logger.warn("Асинхронное соединение с базой данных потеряно");
+        connection.reset();
+    }
+    release(std::move(connection));
+    if (failure) std::rethrow_exception(failure);
+
+    int rows = PQntuples(result.get());
+    page.results.reserve(static_cast<size_t>(rows));
+    for (int i = 0; i < rows; ++i) {
+        page.results.emplace_back(PQgetvalue(result.get(), i, 0), std::strtof(PQgetvalue(result.get(), i, 1), nullptr));
+        page.total = std::strtoull(PQgetvalue(result.get(), i, 2), nullptr, 10);
+    }
+    page.exactTotal = rows > 0 || (offset == 0 && cursor.empty()); // Как в Database::search
+    if (rows > 0 && page.results.size() == limit) {
+        page.nextCursor = Database::encodeCursor(PQgetvalue(result.get(), rows - 1, 1), page.results.back().first);
+    }
+    co_return page;
+}
@@ -0,0 +1,98 @@
+#include "connection_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+// Конструктор пула: открываем все соединения заранее, чтобы ошибка подключения проявилась при старте
+ConnectionPool::ConnectionPool(const std::string& connectionString, size_t size, Preparer preparer, Logger& logger)
+    : connectionString(connectionString), poolSize(std::max<size_t>(1, size)),
+    preparer(std::move(preparer)), logger(logger) {
+    idle.reserve(poolSize);
+    for (size_t i = 0; i < poolSize; ++i) {
+        idle.push_back({ std::make_unique<pqxx::connection>(connectionString), false });
+    }
+}
+
+// Метод получения соединения из пула
+ConnectionPool::Lease ConnectionPool::acquire(bool prepare) {
+    Slot slot;
+    {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        if (idle.empty()) {
+            // Пул исчерпан: ждём и учитываем время ожидания
+            auto started = std::chrono::steady_clock::now();
+            available.wait(lock, [this]() { return !idle.empty(); });
+            auto waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started).count());
+
+            waits++;
+            totalWaitUs += waited;
+            uint64_t prevMax = maxWaitUs.load();
+            while (waited > prevMax && !maxWaitUs.compare_exchange_weak(prevMax, waited)) {
+            }
+        }
+        slot = std::move(idle.back());
+        idle.pop_back();
+    }
+    acquisitions++;
+
+    try {
+        // Проверка здоровья: оборванное соединение открываем заново вне блокировки
+        if (!slot.connection || !slot.connection->is_open()) {
+            slot.connection = std::make_unique<pqxx::connection>(connectionString);
+            slot.prepared = false; // Подготовленные запросы живут в рамках соединения
+            reconnects++;
+            logger.warn("Соединение с базой данных восстановлено.");
+        }
+
+        if (prepare && !slot.prepared && preparer) {
+            preparer(*slot.connection);
+            slot.prepared = true;
+        }
+    }
+    catch (...) {
+        // Соединение с частично подготовленными запросами не переиспользуем: слот откроется заново
+        slot.connection.reset();
+        release(std::move(slot)); // Возвращаем слот, чтобы пул не уменьшался
+        throw;
+    }
+    return Lease(*this, std::move(slot));
+}
+
+// Метод возврата соединения в пул
+void ConnectionPool::release(Slot slot) {
+    if (slot.connection && !slot.connection->is_open()) {
+        slot.connection.reset(); // Оборванное соединение будет открыто заново при следующей выдаче
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        idle.push_back(std::move(slot));
+    }
+    available.notify_one();
+}
+
+// Метод получения счётчиков
+ConnectionPool::Stats ConnectionPool::stats() const {
+    Stats s;
+    s.acquisitions = acquisitions.load();
+    s.waits = waits.load();
+    s.totalWaitUs = totalWaitUs.load();
+    s.maxWaitUs = maxWaitUs.load();
+    s.reconnects = reconnects.load();
+    return s;
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool& pool, Slot slot)
+    : pool(&pool), slot(std::move(slot)) {
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), slot(std::move(other.slot)) {
+    other.pool = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool) {
+        pool->release(std::move(slot));
+    }
+}
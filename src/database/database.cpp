@@ -1,14 +1,148 @@
 #include "database.hpp"
 
-// Конструктор класса Database, инициализирует соединение с базой данных
+#include "bm25.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+
+// Конструктор класса Database, открывает пул соединений с базой данных
 Database::Database(const Config& config, Logger& logger)
-    : connection(config.getDbConnectionString()), logger(logger) {
-    logger.info("Подключено к базе данных.");
+    : logger(logger),
+    pool(config.getDbConnectionString(), static_cast<size_t>(config.getDbPoolSize()), &Database::prepareStatements, logger) {
+    logger.info("Подключено к базе данных, соединений в пуле: " + std::to_string(pool.size()));
+}
+
+// Поиск страниц, содержащих все слова запроса, по убыванию оценки BM25: слова передаются одним параметром
+// text[], поэтому текст запроса не меняется и план строится один раз на соединение. Длины страниц,
+// документные частоты и размер корпуса хранятся готовыми, так что запрос не считает COUNT по index.
+// Постраничная выдача: $4 — LIMIT, $5 — OFFSET, $6 и $7 — оценка (текстом) и URL последней показанной страницы
+// (NULL — с начала). Оценка возвращается текстом: float8 выводится без потери точности, и сравнение
+// с курсором точное. total — число всех совпадений (на странице после последней — не возвращается)
+// Средняя длина NULL (нет страниц или у всех длина 0) — нормализация по длине не применяется, как в Bm25::weight
+const char* const Database::searchQuery = R"(
+    WITH stats AS (
+        SELECT documents::float8 AS n,
+               NULLIF(total_length::float8 / NULLIF(documents, 0), 0) AS average_length
+        FROM corpus_stats WHERE id = 1
+    ),
+    matches AS (
+        SELECT p.url,
+               SUM(ln(1 + (s.n - w.doc_freq + 0.5) / (w.doc_freq + 0.5))
+                   * i.frequency * ($2::float8 + 1)
+                   / (i.frequency + $2::float8 * (1 - $3::float8 + $3::float8 * COALESCE(p.length / s.average_length, 1)))) AS score
+        FROM stats s
+        JOIN words w ON w.word = ANY($1::text[])
+        JOIN index i ON i.word_id = w.id
+        JOIN pages p ON p.id = i.page_id
+        GROUP BY p.url
+        HAVING COUNT(DISTINCT w.word) = cardinality($1::text[])
+    ),
+    counted AS (
+        SELECT url, score, COUNT(*) OVER () AS total FROM matches
+    )
+    SELECT url, score::text AS score, total
+    FROM counted
+    WHERE $6::text IS NULL OR score < $6::float8 OR (score = $6::float8 AND url > $7::text)
+    ORDER BY counted.score DESC, url
+    LIMIT $4 OFFSET $5
+)";
+
+// Метод для регистрации подготовленных запросов на соединении
+void Database::prepareStatements(pqxx::connection& connection) {
+    // Вставка или обновление страницы с её глубиной и состоянием для повторного обхода одним INSERT ... ON CONFLICT.
+    // Возвращает ID, признак вставки (xmax = 0: строку создал этот запрос) и длину страницы. При конфликте длина
+    // не меняется, поэтому возвращается прежняя длина последней зафиксированной версии строки, которую запрос
+    // заблокировал; так статистика корпуса меняется на точную разницу, даже если ту же новую страницу
+    // одновременно вставляет другая транзакция
+    connection.prepare("upsert_page", R"(
+        INSERT INTO pages AS p (url, length, depth, etag, last_modified, content_hash, simhash, links)
+        VALUES ($1, $2, $3, NULLIF($4, ''), NULLIF($5, ''), $6::bigint, NULLIF($7::bigint, 0), $8::text[])
+        ON CONFLICT (url) DO UPDATE SET depth = EXCLUDED.depth, etag = EXCLUDED.etag,
+            last_modified = EXCLUDED.last_modified, content_hash = EXCLUDED.content_hash, simhash = EXCLUDED.simhash,
+            links = EXCLUDED.links
+        RETURNING p.id, p.xmax = 0 AS inserted, p.length
+    )");
+
+    // Новые ETag, Last-Modified и ссылки страницы с тем же содержимым
+    connection.prepare("set_page_state",
+        "UPDATE pages SET etag = NULLIF($2, ''), last_modified = NULLIF($3, ''), links = $4::text[] WHERE url = $1");
+
+    // Сохранённые ссылки страницы (по строке на ссылку)
+    connection.prepare("page_links", "SELECT unnest(links) FROM pages WHERE url = $1");
+
+    // Новая длина уже существующей страницы (строка заблокирована upsert_page)
+    connection.prepare("set_page_length", "UPDATE pages SET length = $2 WHERE id = $1");
+
+    // Вставка всех новых слов пачки одним запросом; строки вставляются по порядку слов, поэтому параллельные
+    // транзакции ждут друг друга на одних и тех же словах в одном порядке
+    connection.prepare("insert_words",
+        "INSERT INTO words (word) SELECT t.word FROM unnest($1::text[]) AS t(word) ORDER BY t.word "
+        "ON CONFLICT (word) DO NOTHING");
+
+    // Обновление записей индекса страницы одним запросом (ID слов берём соединением с words): пишутся только
+    // записи новых слов и слов с другой частотой, записи слов, исчезнувших со страницы, удаляются.
+    // Возвращает изменения документной частоты: +1 для новых слов страницы, -1 для удалённых
+    connection.prepare("replace_postings", R"(
+        WITH fresh AS (
+            SELECT w.id AS word_id, t.frequency
+            FROM unnest($2::text[], $3::int[]) AS t(word, frequency)
+            JOIN words w ON w.word = t.word
+        ),
+        old AS (
+            SELECT word_id, frequency FROM index WHERE page_id = $1
+        ),
+        changed AS (
+            SELECT f.word_id, f.frequency, o.word_id IS NULL AS added
+            FROM fresh f LEFT JOIN old o ON o.word_id = f.word_id
+            WHERE o.frequency IS DISTINCT FROM f.frequency
+        ),
+        removed AS (
+            DELETE FROM index i
+            WHERE i.page_id = $1 AND i.word_id NOT IN (SELECT word_id FROM fresh)
+            RETURNING i.word_id
+        ),
+        upserted AS (
+            INSERT INTO index (page_id, word_id, frequency)
+            SELECT $1, word_id, frequency FROM changed
+            ON CONFLICT (page_id, word_id) DO UPDATE SET frequency = EXCLUDED.frequency
+        )
+        SELECT word_id, 1 AS delta FROM changed WHERE added
+        UNION ALL
+        SELECT word_id, -1 AS delta FROM removed
+    )");
+
+    // Блокировка строк слов в порядке ID перед изменением документной частоты (без взаимоблокировок)
+    // FOR NO KEY UPDATE не конфликтует с FOR KEY SHARE, которую берут внешние ключи index при записи страниц
+    // другой транзакции, поэтому её ожидание страницы, заблокированной этой транзакцией, не замыкается в цикл
+    connection.prepare("lock_words",
+        "SELECT id FROM words WHERE id = ANY($1::int[]) ORDER BY id FOR NO KEY UPDATE");
+
+    // Изменение документной частоты слов
+    connection.prepare("add_doc_freq", R"(
+        UPDATE words w SET doc_freq = w.doc_freq + d.delta
+        FROM unnest($1::int[], $2::int[]) AS d(id, delta)
+        WHERE w.id = d.id
+    )");
+
+    // Изменение числа документов и суммы их длин; версия корпуса растёт с каждой записью страниц
+    // и становится видна вместе с ними при фиксации транзакции
+    connection.prepare("add_corpus_stats",
+        "UPDATE corpus_stats SET documents = documents + $1, total_length = total_length + $2, "
+        "version = version + 1 WHERE id = 1");
+
+    // Текущая версия корпуса
+    connection.prepare("corpus_version", "SELECT version FROM corpus_stats WHERE id = 1");
+
+    // Поиск страниц по убыванию оценки BM25 (текст запроса общий с AsyncDatabase)
+    connection.prepare("search", searchQuery);
 }
 
 // Метод для инициализации таблиц в базе данных
 void Database::init() {
-    pqxx::work txn(connection); // Начинаем транзакцию
+    auto connection = pool.acquire(false); // Подготовленные запросы ссылаются на таблицы, которые создаются здесь
+    pqxx::work txn(*connection); // Начинаем транзакцию
     txn.exec(R"(
         CREATE TABLE IF NOT EXISTS pages (
             id SERIAL PRIMARY KEY,
@@ -24,93 +158,364 @@ void Database::init() {
             frequency INTEGER,
             PRIMARY KEY (page_id, word_id)
         );
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS length INTEGER NOT NULL DEFAULT 0;
+        ALTER TABLE words ADD COLUMN IF NOT EXISTS doc_freq INTEGER NOT NULL DEFAULT 0;
+        CREATE TABLE IF NOT EXISTS corpus_stats (
+            id SMALLINT PRIMARY KEY CHECK (id = 1),
+            documents BIGINT NOT NULL,
+            total_length BIGINT NOT NULL
+        );
+        ALTER TABLE corpus_stats ADD COLUMN IF NOT EXISTS version BIGINT NOT NULL DEFAULT 0;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS depth INTEGER NOT NULL DEFAULT 0;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS etag TEXT;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS last_modified TEXT;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS content_hash BIGINT;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS simhash BIGINT;
+        ALTER TABLE pages ADD COLUMN IF NOT EXISTS links TEXT[];
     )");  // Выполняем SQL-запрос на создание таблиц
+
+    // Статистика BM25 ведётся при записи страниц; для базы, заполненной до её появления, считаем её один раз
+    pqxx::result created = txn.exec("INSERT INTO corpus_stats (id, documents, total_length) VALUES (1, 0, 0) ON CONFLICT (id) DO NOTHING RETURNING id");
+    if (!created.empty()) {
+        txn.exec(R"(
+            UPDATE pages p SET length = s.length
+            FROM (SELECT page_id, SUM(frequency) AS length FROM index GROUP BY page_id) s
+            WHERE p.id = s.page_id;
+            UPDATE words w SET doc_freq = s.doc_freq
+            FROM (SELECT word_id, COUNT(*) AS doc_freq FROM index GROUP BY word_id) s
+            WHERE w.id = s.word_id;
+            UPDATE corpus_stats
+            SET documents = (SELECT COUNT(*) FROM pages), total_length = (SELECT COALESCE(SUM(length), 0) FROM pages)
+            WHERE id = 1;
+        )");
+        logger.info("Статистика BM25 рассчитана по существующим страницам.");
+    }
+
     txn.commit();  // Завершаем транзакцию
     logger.info("Таблицы инициализированы.");
 }
 
+// Метод для выполнения транзакции с переподключением
+// Пул проверяет соединение только через is_open(), поэтому соединение, оборванное сервером, обнаруживается
+// лишь на BEGIN в конструкторе pqxx::work или на первом запросе; выдача соединения и транзакция находятся
+// внутри try, чтобы такой обрыв тоже приводил к повтору на новом соединении
+void Database::runTransaction(const std::function<bool(pqxx::work&)>& work) {
+    for (int attempt = 0;; ++attempt) {
+        try {
+            auto connection = pool.acquire();
+            try {
+                pqxx::work txn(*connection);
+                if (work(txn)) txn.commit();
+                return;
+            }
+            catch (const pqxx::broken_connection&) {
+                connection.discard(); // Слот откроется заново при следующей выдаче
+                throw;
+            }
+        }
+        catch (const pqxx::broken_connection& e) {
+            if (attempt > 0) throw;
+            logger.warn("Соединение с базой данных оборвано, повторяем транзакцию: " + std::string(e.what()));
+        }
+    }
+}
+
 // Метод для сохранения документа в базе данных
-void Database::saveDocument(const std::string& url, const std::unordered_map<std::string, int>& words) {
-    pqxx::work txn(connection); // Начинаем транзакцию
+void Database::saveDocument(const Document& document) {
+    try {
+        bool saved = false;
+        runTransaction([&](pqxx::work& txn) {
+            StatsDelta stats;
+            insertWords(txn, { &document });
+            saved = writeDocument(txn, document, stats);
+            if (!saved) return false; // Транзакция откатывается
+            applyStats(txn, stats);
+            return true;
+            });
+        if (saved) logger.info("Сохранён документ: " + document.url);
+    }
+    catch (const pqxx::broken_connection&) {
+        throw; // База данных недоступна: страницу повторит вызывающий
+    }
+    catch (const std::exception& e) {
+        logger.error("Ошибка при сохранении документа: " + std::string(e.what()));
+    }
+}
+
+// Метод для сохранения пачки документов одной транзакцией
+// Блокировки берутся в одном порядке во всех транзакциях: сначала новые слова всей пачки (по порядку слов),
+// затем страницы (по порядку URL), затем строки слов для статистики (по ID), поэтому параллельные потоки
+// записи не блокируют друг друга взаимно
+void Database::saveDocuments(const std::vector<Document>& documents) {
+    if (documents.empty()) return;
+
+    std::vector<const Document*> ordered;
+    ordered.reserve(documents.size());
+    for (const auto& document : documents) ordered.push_back(&document);
+    std::sort(ordered.begin(), ordered.end(), [](const Document* a, const Document* b) { return a->url < b->url; });
 
     try {
-        // Вставляем URL страницы в таблицу pages, если его нет
-        txn.exec_params("INSERT INTO pages (url) VALUES ($1) ON CONFLICT (url) DO NOTHING", url);
-
-        // Получаем ID страницы по URL
-        pqxx::result pageRes = txn.exec_params("SELECT id FROM pages WHERE url = $1", url);
-        if (pageRes.empty()) {
-            logger.error("Не удалось получить ID страницы для URL: " + url);
-            return;
-        }
-        int pageId = pageRes[0][0].as<int>(); // Извлекаем ID страницы
-
-        // Для каждого слова, сохраняем его в таблице words, а затем индексируем на соответствующей странице
-        for (const auto& [word, freq] : words) {
-            txn.exec_params("INSERT INTO words (word) VALUES ($1) ON CONFLICT (word) DO NOTHING", word); // Вставляем слово
-            pqxx::result wordRes = txn.exec_params("SELECT id FROM words WHERE word = $1", word); // Получаем ID слова
-            if (wordRes.empty()) {
-                logger.error("Не удалось получить ID слова для: " + word);
-                continue; // Если ID слова не найдено, продолжаем с другим словом
+        runTransaction([&](pqxx::work& txn) {
+            StatsDelta stats; // Статистика пачки применяется одним обновлением в конце транзакции
+            insertWords(txn, ordered);
+            for (const Document* document : ordered) {
+                writeDocument(txn, *document, stats);
             }
-            int wordId = wordRes[0][0].as<int>(); // Извлекаем ID слова
-
-            // Вставляем или обновляем запись в индексе (связь между страницей и словом с учётом частоты)
-            txn.exec_params(R"(
-                INSERT INTO index (page_id, word_id, frequency)
-                VALUES ($1, $2, $3)
-                ON CONFLICT (page_id, word_id) DO UPDATE SET frequency = $3
-            )", pageId, wordId, freq);
+            applyStats(txn, stats);
+            return true; // Одна фиксация на все страницы пачки
+            });
+        logger.info("Сохранено документов одной транзакцией: " + std::to_string(documents.size()));
+        return;
+    }
+    catch (const pqxx::broken_connection&) {
+        throw; // База данных недоступна: пачку повторит вызывающий
+    }
+    catch (const std::exception& e) {
+        logger.error("Ошибка при сохранении пачки документов: " + std::string(e.what()));
+    }
+
+    // Одна ошибочная страница откатывает всю пачку, поэтому сохраняем страницы по одной
+    // (обрыв соединения и здесь повторяется на новом соединении, а затем передаётся вызывающему)
+    logger.warn("Повторяем сохранение пачки постранично.");
+    for (const Document* document : ordered) {
+        saveDocument(*document);
+    }
+}
+
+// Метод для вставки новых слов пачки: слова всех страниц объединяются и сортируются
+void Database::insertWords(pqxx::work& txn, const std::vector<const Document*>& documents) {
+    std::vector<std::string> terms;
+    for (const Document* document : documents) {
+        for (const auto& entry : document->words) terms.push_back(entry.first);
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    txn.exec_prepared("insert_words", terms);
+}
+
+// Метод для записи документа в открытой транзакции
+// Все слова страницы передаются массивами и записываются постоянным числом запросов (unnest), а не по слову за раз
+bool Database::writeDocument(pqxx::work& txn, const Document& document, StatsDelta& stats) {
+    const std::string& url = document.url;
+
+    // Сортируем слова: записи индекса страницы пишутся в постоянном порядке
+    std::vector<std::pair<std::string, int>> sorted(document.words.begin(), document.words.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    // Раскладываем частоты в два параллельных массива для передачи в запрос как text[] и int[]
+    std::vector<std::string> terms;
+    std::vector<int> frequencies;
+    terms.reserve(sorted.size());
+    frequencies.reserve(sorted.size());
+    long long length = 0; // Длина страницы для BM25 — сумма частот её слов
+    for (auto& [word, freq] : sorted) {
+        terms.push_back(std::move(word));
+        frequencies.push_back(freq);
+        length += freq;
+    }
+
+    // Вставляем URL страницы с длиной и состоянием и сразу получаем её ID и прежнюю длину
+    // Хэши хранятся в BIGINT: беззнаковые значения передаются с тем же набором битов
+    pqxx::result pageRes = txn.exec_prepared("upsert_page", url, length, document.depth, document.etag,
+        document.lastModified, static_cast<long long>(document.contentHash), static_cast<long long>(document.simhash),
+        document.links);
+    if (pageRes.empty()) {
+        logger.error("Не удалось получить ID страницы для URL: " + url);
+        return false;
+    }
+    int pageId = pageRes[0][0].as<int>(); // Извлекаем ID страницы
+    if (pageRes[0][1].as<bool>()) {
+        stats.documents++;
+        stats.totalLength += length;
+    }
+    else {
+        long long previousLength = pageRes[0][2].as<long long>();
+        if (previousLength != length) {
+            txn.exec_prepared("set_page_length", pageId, length);
+            stats.totalLength += length - previousLength;
         }
+    }
 
-        txn.commit();  // Завершаем транзакцию
-        logger.info("Сохранён документ: " + url);
+    // Обновляем изменившиеся записи индекса страницы одним запросом (новые слова уже вставлены insertWords)
+    for (const auto& row : txn.exec_prepared("replace_postings", pageId, terms, frequencies)) {
+        stats.docFreq[row[0].as<int>()] += row[1].as<int>();
     }
-    catch (const std::exception& e) {
-        logger.error("Ошибка при сохранении документа: " + std::string(e.what()));
-        txn.abort(); // Если произошла ошибка, откатываем транзакцию
+
+    return true;
+}
+
+// Метод для применения накопленных изменений статистики BM25 в открытой транзакции
+// Строки слов блокируются в порядке ID, а строка corpus_stats — последней, поэтому параллельные
+// транзакции не блокируют друг друга взаимно; блокировки держатся только до фиксации
+void Database::applyStats(pqxx::work& txn, const StatsDelta& stats) {
+    std::vector<int> ids;
+    std::vector<int> deltas;
+    for (const auto& [id, delta] : stats.docFreq) {
+        if (delta == 0) continue;
+        ids.push_back(id);
+        deltas.push_back(delta);
+    }
+    if (!ids.empty()) {
+        txn.exec_prepared("lock_words", ids);
+        txn.exec_prepared("add_doc_freq", ids, deltas);
+    }
+    txn.exec_prepared("add_corpus_stats", stats.documents, stats.totalLength); // Всегда: версия корпуса меняется
+}
+
+// Метод для получения сохранённых ссылок страницы
+std::vector<std::string> Database::pageLinks(const std::string& url) {
+    auto connection = pool.acquire();
+    pqxx::read_transaction txn(*connection);
+    std::vector<std::string> links;
+    for (const auto& row : txn.exec_prepared("page_links", url)) {
+        links.push_back(row[0].as<std::string>());
     }
+    return links;
+}
+
+// Метод для обновления состояния страницы с тем же содержимым
+void Database::updatePageState(const std::string& url, const std::string& etag, const std::string& lastModified,
+    const std::vector<std::string>& links) {
+    runTransaction([&](pqxx::work& txn) {
+        txn.exec_prepared("set_page_state", url, etag, lastModified, links);
+        return true;
+        });
+}
+
+// Метод для получения версии корпуса
+long long Database::corpusVersion() {
+    auto connection = pool.acquire();
+    pqxx::read_transaction txn(*connection);
+    pqxx::result r = txn.exec_prepared("corpus_version");
+    return r.empty() ? 0 : r[0][0].as<long long>();
 }
 
 // Метод для поиска страниц по запросу
-std::vector<std::pair<std::string, int>> Database::search(const std::vector<std::string>& queryWords) {
-    pqxx::work txn(connection);  // Начинаем транзакцию
-    std::vector<std::pair<std::string, int>> results;  // Результаты поиска
+SearchPage Database::search(const std::vector<std::string>& queryWords, size_t limit, size_t offset,
+    const std::string& cursor) {
+    SearchPage page;  // Результаты поиска
 
-    if (queryWords.empty()) return results;  // Если нет запроса, возвращаем пустой результат
+    if (queryWords.empty() || limit == 0) return page;  // Если нет запроса, возвращаем пустой результат
 
-    std::ostringstream whereStream;
-    // Создаём часть WHERE для SQL-запроса на основе слов из запроса
-    for (size_t i = 0; i < queryWords.size(); ++i) {
-        if (i > 0) whereStream << " OR "; // Добавляем OR между словами
-        whereStream << "w.word = " << txn.quote(queryWords[i]); // Экранируем слово
+    std::optional<std::string> afterScore, afterUrl;
+    if (!cursor.empty()) {
+        std::string score, url;
+        if (!decodeCursor(cursor, score, url)) throw std::invalid_argument("Некорректный курсор");
+        afterScore = std::move(score);
+        afterUrl = std::move(url);
     }
 
-    // Формируем SQL-запрос
-    std::string sql =
-        "SELECT p.url, SUM(i.frequency) AS total " // Выбираем URL и суммируем частоты слов
-        "FROM pages p "
-        "JOIN index i ON p.id = i.page_id "
-        "JOIN words w ON w.id = i.word_id ";
+    // Убираем повторы: запрос сравнивает число найденных слов с размером массива
+    std::vector<std::string> terms(queryWords);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    auto connection = pool.acquire(); // Берём соединение из пула на время запроса
+    pqxx::work txn(*connection);  // Начинаем транзакцию
+
+    // Выполняем подготовленный запрос
+    pqxx::result r = txn.exec_prepared("search", terms, Bm25::kK1, Bm25::kB,
+        static_cast<long long>(limit), static_cast<long long>(offset), afterScore, afterUrl);
 
-    if (!queryWords.empty()) {
-        sql += "WHERE " + whereStream.str() + " "; // Добавляем фильтрацию по словам
+    // Добавляем найденные результаты на страницу
+    std::string lastScore;
+    for (const auto& row : r) {
+        lastScore = row["score"].as<std::string>();  // Оценка BM25 текстом (для курсора)
+        page.results.emplace_back(row["url"].as<std::string>(), std::strtof(lastScore.c_str(), nullptr));
+        page.total = row["total"].as<uint64_t>();
     }
+    // total приходит в каждой строке; пустая первая страница значит, что совпадений нет вовсе (total = 0 точно).
+    // Пустая страница после offset или курсора числа совпадений не сообщает
+    page.exactTotal = !page.results.empty() || (offset == 0 && cursor.empty());
+    if (page.results.size() == limit) page.nextCursor = encodeCursor(lastScore, page.results.back().first);
 
-    sql +=
-        "GROUP BY p.url "  // Группируем по URL
-        "HAVING COUNT(DISTINCT w.word) = " + std::to_string(queryWords.size()) + " " // Отбираем страницы, которые содержат все слова запроса
-        "ORDER BY total DESC "  // Сортируем по убыванию суммы частот
-        "LIMIT 10";  // Ограничиваем результат 10 страницами
+    return page;  // Возвращаем результаты поиска
+}
 
-    pqxx::result r = txn.exec(sql);  // Выполняем запрос
+// Курсор базы данных: оценка текстом и URL последней страницы, в шестнадцатеричном виде (без символов,
+// требующих экранирования в URL)
+std::string Database::encodeCursor(const std::string& score, const std::string& url) {
+    static const char digits[] = "0123456789abcdef";
+    std::string raw = score + '\n' + url;
+    std::string cursor;
+    cursor.reserve(raw.size() * 2);
+    for (unsigned char ch : raw) {
+        cursor += digits[ch >> 4];
+        cursor += digits[ch & 15];
+    }
+    return cursor;
+}
 
-    // Добавляем найденные результаты в вектор
-    for (const auto& row : r) {
-        std::string url = row["url"].as<std::string>();  // Извлекаем URL
-        int score = row["total"].as<int>();  // Извлекаем сумму частот
-        results.emplace_back(url, score);  // Добавляем результат в вектор
+bool Database::decodeCursor(const std::string& cursor, std::string& score, std::string& url) {
+    if (cursor.size() % 2 != 0) return false;
+    std::string raw;
+    raw.reserve(cursor.size() / 2);
+    for (size_t i = 0; i < cursor.size(); i += 2) {
+        auto nibble = [](char ch) -> int {
+            if (ch >= '0' && ch <= '9') return ch - '0';
+            if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+            return -1;
+        };
+        int high = nibble(cursor[i]), low = nibble(cursor[i + 1]);
+        if (high < 0 || low < 0) return false;
+        raw += static_cast<char>(high * 16 + low);
     }
+    size_t separator = raw.find('\n');
+    if (separator == std::string::npos || separator == 0) return false;
+    score = raw.substr(0, separator);
+    url = raw.substr(separator + 1);
+    char* end = nullptr;
+    std::strtod(score.c_str(), &end); // Оценка уходит в запрос параметром float8: проверяем, что это число
+    return end == score.c_str() + score.size();
+}
+
+// Метод для потоковой выгрузки корпуса
+// Строки читаются через COPY по одной, без загрузки всего результата в память; REPEATABLE READ даёт
+// всем трём запросам один снимок, так что записи индекса не ссылаются на неизвестные страницы и слова
+void Database::scanCorpus(const std::function<void(int pageId, std::string_view url)>& onPage,
+    const std::function<void(int wordId, std::string_view word)>& onWord,
+    const std::function<void(int wordId, int pageId, int frequency)>& onPosting) {
+    auto connection = pool.acquire();
+    pqxx::transaction<pqxx::isolation_level::repeatable_read, pqxx::write_policy::read_only> txn(*connection);
+
+    txn.for_stream("SELECT id, url FROM pages", [&](int id, std::string_view url) {
+        onPage(id, url);
+        });
+    txn.for_stream("SELECT id, word FROM words", [&](int id, std::string_view word) {
+        onWord(id, word);
+        });
+    txn.for_stream("SELECT word_id, page_id, frequency FROM index", [&](int wordId, int pageId, int frequency) {
+        onPosting(wordId, pageId, frequency);
+        });
+}
+
+// Метод для выгрузки состояния сохранённых страниц одним потоком строк
+void Database::scanPageStates(const std::function<void(std::string_view url, const PageState& state)>& onPage) {
+    auto connection = pool.acquire();
+    pqxx::transaction<pqxx::isolation_level::read_committed, pqxx::write_policy::read_only> txn(*connection);
+
+    PageState state;
+    txn.for_stream(
+        "SELECT url, depth, COALESCE(etag, ''), COALESCE(last_modified, ''), COALESCE(content_hash, 0), "
+        "COALESCE(simhash, 0), links IS NOT NULL FROM pages",
+        [&](std::string_view url, int depth, std::string_view etag, std::string_view lastModified, long long hash,
+            long long simhash, bool linksStored) {
+            state.depth = depth;
+            state.etag.assign(etag);
+            state.lastModified.assign(lastModified);
+            state.contentHash = static_cast<uint64_t>(hash);
+            state.simhash = static_cast<uint64_t>(simhash);
+            state.linksStored = linksStored;
+            onPage(url, state);
+        });
+}
 
-    return results;  // Возвращаем результаты поиска
+// Метод для записи в лог счётчиков пула соединений
+void Database::logPoolStats() {
+    auto stats = pool.stats();
+    logger.info("Пул соединений: выдано " + std::to_string(stats.acquisitions) +
+        ", ожиданий " + std::to_string(stats.waits) +
+        ", суммарное ожидание " + std::to_string(stats.totalWaitUs) + " мкс" +
+        ", максимальное ожидание " + std::to_string(stats.maxWaitUs) + " мкс" +
+        ", переподключений " + std::to_string(stats.reconnects));
 }
@@ -0,0 +1,344 @@
+#include "html_tokenizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace {
+
+    constexpr size_t npos = std::string_view::npos;
+
+    // Разделители слов ASCII: пробельные символы и знаки препинания
+    constexpr std::array<bool, 256> makeSeparators() {
+        std::array<bool, 256> table{};
+        for (char ch : std::string_view(" \n\r\t\v\f.,!?:;\"'(){}[]\\/@#$%^&*+=<>`~|")) {
+            table[static_cast<unsigned char>(ch)] = true;
+        }
+        return table;
+    }
+    constexpr std::array<bool, 256> separators = makeSeparators();
+
+    constexpr uint32_t softHyphen = 0xAD; // Мягкий перенос: не разделяет слово и в него не попадает
+
+    // Именованные сущности, которые встречаются в тексте страниц; остальные остаются как есть
+    struct NamedEntity {
+        std::string_view name;
+        uint32_t codepoint;
+    };
+    constexpr NamedEntity namedEntities[] = {
+        { "amp", '&' }, { "lt", '<' }, { "gt", '>' }, { "quot", '"' }, { "apos", '\'' },
+        { "nbsp", 0xA0 }, { "shy", softHyphen }, { "copy", 0xA9 }, { "reg", 0xAE }, { "deg", 0xB0 },
+        { "middot", 0xB7 }, { "laquo", 0xAB }, { "raquo", 0xBB }, { "times", 0xD7 },
+        { "ensp", 0x2002 }, { "emsp", 0x2003 }, { "thinsp", 0x2009 },
+        { "ndash", 0x2013 }, { "mdash", 0x2014 }, { "lsquo", 0x2018 }, { "rsquo", 0x2019 }, { "sbquo", 0x201A },
+        { "ldquo", 0x201C }, { "rdquo", 0x201D }, { "bdquo", 0x201E }, { "bull", 0x2022 }, { "hellip", 0x2026 },
+        { "euro", 0x20AC }, { "trade", 0x2122 }, { "minus", 0x2212 },
+    };
+
+    bool isAsciiAlpha(char ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+    }
+
+    bool isAsciiAlnum(char ch) {
+        return isAsciiAlpha(ch) || (ch >= '0' && ch <= '9');
+    }
+
+    bool isSpace(char ch) {
+        return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '\f';
+    }
+
+    // Сравнение имени тега или атрибута с именем в нижнем регистре
+    bool equalsLower(std::string_view text, std::string_view lower) {
+        if (text.size() != lower.size()) return false;
+        for (size_t i = 0; i < text.size(); ++i) {
+            char ch = text[i];
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+            if (ch != lower[i]) return false;
+        }
+        return true;
+    }
+
+    // Символы, разделяющие слова: пробелы, тире, кавычки и другие типографские знаки
+    bool isSeparator(uint32_t codepoint) {
+        if (codepoint < 0x80) return separators[codepoint];
+        switch (codepoint) {
+        case 0xA0: case 0xA9: case 0xAB: case 0xAE: case 0xB0: case 0xB7: case 0xBB: case 0xD7:
+        case 0x2022: case 0x2026: case 0x2039: case 0x203A: case 0x2122: case 0x2212:
+            return true;
+        default:
+            return (codepoint >= 0x2000 && codepoint <= 0x200B) ||  // Пробелы разной ширины
+                (codepoint >= 0x2012 && codepoint <= 0x2015) ||     // Тире
+                (codepoint >= 0x2018 && codepoint <= 0x201F);       // Кавычки
+        }
+    }
+
+    // Длина типографского знака UTF-8 в позиции pos (0 — не разделитель)
+    // Все такие знаки лежат в U+0080..U+00FF и U+2000..U+2FFF, то есть начинаются с байта 0xC2, 0xC3 или 0xE2
+    size_t utf8Separator(std::string_view text, size_t pos) {
+        auto lead = static_cast<unsigned char>(text[pos]);
+        if ((lead == 0xC2 || lead == 0xC3) && pos + 1 < text.size()) {
+            uint32_t codepoint = ((lead & 0x1Fu) << 6) | (static_cast<unsigned char>(text[pos + 1]) & 0x3Fu);
+            return isSeparator(codepoint) ? 2 : 0;
+        }
+        if (lead == 0xE2 && pos + 2 < text.size()) {
+            uint32_t codepoint = ((lead & 0x0Fu) << 12) | ((static_cast<unsigned char>(text[pos + 1]) & 0x3Fu) << 6) |
+                (static_cast<unsigned char>(text[pos + 2]) & 0x3Fu);
+            return isSeparator(codepoint) ? 3 : 0;
+        }
+        return 0;
+    }
+
+    void appendUtf8(std::string& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out.push_back(static_cast<char>(codepoint));
+        }
+        else if (codepoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else if (codepoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else {
+            out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    int digitValue(char ch, bool hex) {
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (hex && ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        if (hex && ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+    // Разбор сущности в позиции pos ('&'); возвращает её длину (0 — не сущность) и код символа
+    size_t parseEntity(std::string_view input, size_t pos, uint32_t& codepoint) {
+        size_t i = pos + 1;
+        if (i >= input.size()) return 0;
+
+        if (input[i] == '#') {
+            // Числовая сущность: &#1087; или &#x43F; (точка с запятой в конце необязательна)
+            bool hex = ++i < input.size() && (input[i] == 'x' || input[i] == 'X');
+            if (hex) ++i;
+            size_t digitsStart = i;
+            uint64_t value = 0;
+            for (int digit; i < input.size() && (digit = digitValue(input[i], hex)) >= 0; ++i) {
+                value = std::min<uint64_t>(value * (hex ? 16 : 10) + static_cast<uint64_t>(digit), 0x110000);
+            }
+            if (i == digitsStart) return 0;
+            if (i < input.size() && input[i] == ';') ++i;
+
+            // Недопустимые коды заменяются символом U+FFFD, как в браузерах
+            bool valid = value != 0 && value < 0x110000 && (value < 0xD800 || value > 0xDFFF);
+            codepoint = valid ? static_cast<uint32_t>(value) : 0xFFFD;
+            return i - pos;
+        }
+
+        // Именованная сущность: только из таблицы и только с точкой с запятой
+        size_t nameStart = i;
+        while (i < input.size() && i - nameStart < 8 && isAsciiAlnum(input[i])) ++i;
+        if (i == nameStart || i >= input.size() || input[i] != ';') return 0;
+        std::string_view name = input.substr(nameStart, i - nameStart);
+        for (const auto& entity : namedEntities) {
+            if (entity.name == name) {
+                codepoint = entity.codepoint;
+                return i + 1 - pos;
+            }
+        }
+        return 0;
+    }
+
+    // Пропуск содержимого <script> или <style> до закрывающего тега (имя без учёта регистра)
+    size_t skipRawText(std::string_view html, size_t pos, std::string_view lowerName) {
+        while (true) {
+            size_t close = html.find("</", pos);
+            if (close == npos) return html.size();
+            size_t nameEnd = close + 2 + lowerName.size();
+            if (nameEnd <= html.size() && equalsLower(html.substr(close + 2, lowerName.size()), lowerName) &&
+                (nameEnd == html.size() || !isAsciiAlnum(html[nameEnd]))) {
+                size_t end = html.find('>', nameEnd);
+                return end == npos ? html.size() : end + 1;
+            }
+            pos = close + 2;
+        }
+    }
+
+} // namespace
+
+size_t HtmlTokenizer::decodeEntity(std::string_view input, size_t pos, std::string& out) {
+    uint32_t codepoint = 0;
+    size_t length = parseEntity(input, pos, codepoint);
+    if (length > 0) appendUtf8(out, codepoint);
+    return length;
+}
+
+// Один проход по странице: текст между тегами режется на слова, теги разбираются на месте
+void HtmlTokenizer::scan(std::string_view html, const Callback& onText, const Callback& onLink) {
+    wordStart = npos;
+    copying = false;
+
+    size_t i = 0;
+    while (i < html.size()) {
+        auto ch = static_cast<unsigned char>(html[i]);
+
+        if (ch == '<') {
+            flushWord(html, i, onText); // Тег разделяет слова
+            i = scanTag(html, i, onLink);
+            continue;
+        }
+
+        size_t separator = 0;
+        uint32_t codepoint = 0;
+        size_t entity = ch == '&' ? parseEntity(html, i, codepoint) : 0;
+        if (entity > 0) {
+            if (isSeparator(codepoint)) {
+                separator = entity;
+            }
+            else {
+                // Декодированный символ отличается от исходного текста: дальше слово собирается в буфере
+                if (wordStart == npos) {
+                    wordStart = i;
+                    word.clear();
+                }
+                else if (!copying) {
+                    word.assign(html.substr(wordStart, i - wordStart));
+                }
+                copying = true;
+                if (codepoint != softHyphen) appendUtf8(word, codepoint);
+                i += entity;
+                continue;
+            }
+        }
+        else if (ch < 0x80) {
+            separator = separators[ch] ? 1 : 0;
+        }
+        else {
+            separator = utf8Separator(html, i);
+        }
+
+        if (separator > 0) {
+            flushWord(html, i, onText);
+            i += separator;
+            continue;
+        }
+
+        // Обычный символ слова (включая байты многобайтовых символов UTF-8)
+        if (wordStart == npos) {
+            wordStart = i;
+            copying = false;
+        }
+        else if (copying) {
+            word.push_back(html[i]);
+        }
+        ++i;
+    }
+    flushWord(html, html.size(), onText);
+}
+
+void HtmlTokenizer::flushWord(std::string_view html, size_t end, const Callback& onText) {
+    if (wordStart == npos) return;
+    if (onText) {
+        if (copying) {
+            if (!word.empty()) onText(word);
+        }
+        else {
+            onText(html.substr(wordStart, end - wordStart));
+        }
+    }
+    wordStart = npos;
+    copying = false;
+}
+
+// Разбор тега: комментарии и объявления пропускаются, у <a> берётся href, после <script>/<style> — их содержимое
+size_t HtmlTokenizer::scanTag(std::string_view html, size_t pos, const Callback& onLink) {
+    size_t i = pos + 1;
+    if (i >= html.size()) return html.size();
+
+    if (html.compare(i, 3, "!--") == 0) {
+        size_t end = html.find("-->", i + 3);
+        return end == npos ? html.size() : end + 3;
+    }
+    if (html[i] == '!' || html[i] == '?') {
+        size_t end = html.find('>', i);
+        return end == npos ? html.size() : end + 1;
+    }
+
+    bool closing = html[i] == '/';
+    if (closing) ++i;
+    if (i >= html.size() || !isAsciiAlpha(html[i])) {
+        return pos + 1; // Не тег ("a < b"): '<' лишь разделяет слова
+    }
+
+    size_t nameStart = i;
+    while (i < html.size() && isAsciiAlnum(html[i])) ++i;
+    std::string_view name = html.substr(nameStart, i - nameStart);
+
+    bool wantHref = !closing && onLink && equalsLower(name, "a");
+    std::string_view rawText = !closing && equalsLower(name, "script") ? "script"
+        : !closing && equalsLower(name, "style") ? "style" : "";
+
+    // Атрибуты: имя[=значение], значение в кавычках может содержать '>'
+    while (i < html.size()) {
+        char ch = html[i];
+        if (ch == '>') {
+            ++i;
+            break;
+        }
+        if (isSpace(ch) || ch == '/') {
+            ++i;
+            continue;
+        }
+
+        size_t attrStart = i;
+        while (i < html.size() && !isSpace(html[i]) && html[i] != '=' && html[i] != '>' && html[i] != '/') ++i;
+        std::string_view attr = html.substr(attrStart, i - attrStart);
+
+        while (i < html.size() && isSpace(html[i])) ++i;
+        if (i >= html.size() || html[i] != '=') continue;
+        ++i;
+        while (i < html.size() && isSpace(html[i])) ++i;
+
+        std::string_view value;
+        if (i < html.size() && (html[i] == '"' || html[i] == '\'')) {
+            size_t end = html.find(html[i], i + 1);
+            if (end == npos) end = html.size();
+            value = html.substr(i + 1, end - i - 1);
+            i = end == html.size() ? end : end + 1;
+        }
+        else {
+            size_t valueStart = i;
+            while (i < html.size() && !isSpace(html[i]) && html[i] != '>') ++i;
+            value = html.substr(valueStart, i - valueStart);
+        }
+
+        if (wantHref && equalsLower(attr, "href")) {
+            wantHref = false; // Учитывается только первый href
+            while (!value.empty() && isSpace(value.front())) value.remove_prefix(1);
+            while (!value.empty() && isSpace(value.back())) value.remove_suffix(1);
+            if (value.empty()) continue;
+
+            if (value.find('&') == npos) {
+                onLink(value);
+            }
+            else {
+                link.clear();
+                for (size_t j = 0; j < value.size();) {
+                    size_t length = value[j] == '&' ? decodeEntity(value, j, link) : 0;
+                    if (length == 0) link.push_back(value[j++]);
+                    else j += length;
+                }
+                onLink(link);
+            }
+        }
+    }
+
+    if (!rawText.empty()) {
+        i = skipRawText(html, i, rawText); // Код и стили не являются текстом страницы
+    }
+    return i;
+}
@@ -1,9 +1,71 @@
 #include "indexer.hpp"
+#include "term_counter.hpp"
 #include <boost/locale.hpp>
-#include <regex>
+#include <array>
+#include <cstdint>
 #include <fstream>
-#include <sstream>
-#include <cctype>
+
+namespace {
+
+    // Нижний регистр ASCII
+    constexpr std::array<char, 128> makeAsciiLower() {
+        std::array<char, 128> table{};
+        for (int ch = 0; ch < 128; ++ch) {
+            table[ch] = static_cast<char>(ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch);
+        }
+        return table;
+    }
+    constexpr std::array<char, 128> asciiLower = makeAsciiLower();
+
+    // Нижний регистр кириллицы U+0400..U+045F (двухбайтовые последовательности с ведущим байтом 0xD0 или 0xD1):
+    // Ѐ..Џ -> ѐ..џ, А..Я -> а..я, строчные остаются как есть
+    constexpr std::array<uint16_t, 0x60> makeCyrillicLower() {
+        std::array<uint16_t, 0x60> table{};
+        for (uint16_t i = 0; i < 0x60; ++i) {
+            uint16_t codepoint = 0x400 + i;
+            table[i] = codepoint < 0x410 ? codepoint + 0x50 : codepoint < 0x430 ? codepoint + 0x20 : codepoint;
+        }
+        return table;
+    }
+    constexpr std::array<uint16_t, 0x60> cyrillicLower = makeCyrillicLower();
+
+    // Приведение по таблицам; false — в слове есть символы, которых нет в таблицах
+    bool toLowerFast(std::string_view word, std::string& out) {
+        out.clear();
+        for (size_t i = 0; i < word.size();) {
+            auto lead = static_cast<unsigned char>(word[i]);
+            if (lead < 0x80) {
+                out.push_back(asciiLower[lead]);
+                ++i;
+                continue;
+            }
+            if ((lead != 0xD0 && lead != 0xD1) || i + 1 >= word.size()) return false;
+            auto next = static_cast<unsigned char>(word[i + 1]);
+            if ((next & 0xC0) != 0x80) return false;
+
+            uint32_t codepoint = ((lead & 0x1Fu) << 6) | (next & 0x3Fu);
+            if (codepoint >= 0x460) return false; // Исторические и национальные буквы — через Boost.Locale
+            codepoint = cyrillicLower[codepoint - 0x400];
+            out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            i += 2;
+        }
+        return true;
+    }
+
+    // Рабочие буферы потока: токенизатор, счётчик слов и буфер приведения регистра живут между страницами
+    struct Scratch {
+        HtmlTokenizer tokenizer;
+        TermCounter counter;
+        std::string folded;
+    };
+
+    Scratch& threadScratch() {
+        thread_local Scratch scratch;
+        return scratch;
+    }
+
+} // namespace
 
 // Конструктор класса Indexer, принимает настройки конфигурации и логгер
 Indexer::Indexer(const Config& config, Logger& logger)
@@ -17,45 +79,51 @@ Indexer::Indexer(const Config& config, Logger& logger)
 void Indexer::loadStopwords() {
     std::ifstream in("stopwords.txt");  // Открываем файл стоп-слов
     std::string word;
+    std::string folded;
     while (std::getline(in, word)) {  // Читаем файл строка за строкой
-        stopwords.insert(boost::locale::to_lower(word));  // Преобразуем слово в нижний регистр и добавляем в множество
+        toLower(word, folded);  // Преобразуем слово в нижний регистр так же, как слова страниц
+        stopwords.insert(folded);  // Добавляем в множество
     }
     logger.info("Загружено стоп-слов: " + std::to_string(stopwords.size()));  // Логируем количество загруженных стоп-слов
 }
 
-// Метод для очистки HTML-кода от тегов и лишних символов
-std::string Indexer::cleanHtml(const std::string& html) {
-    std::string text = std::regex_replace(html, std::regex("<[^>]*>"), " ");  // Убираем HTML-теги
-    text = std::regex_replace(text, std::regex(R"([\n\r\t.,!?:;"'(){}[\]\\/@#$%^&*+=<>`~|])"), " ");  // Убираем лишние символы
-    return text;  // Возвращаем очищенный текст
+void Indexer::toLower(std::string_view word, std::string& out) {
+    if (!toLowerFast(word, out)) {
+        out = boost::locale::to_lower(word.data(), word.data() + word.size());
+    }
 }
 
 // Метод для извлечения слов из HTML-кода
-std::unordered_map<std::string, int> Indexer::extractWords(const std::string& html) {
-    std::unordered_map<std::string, int> wordFreq;  // Мап для хранения частот слов
-    std::string cleanText = cleanHtml(html);  // Очищаем HTML
-
-    std::istringstream iss(cleanText);  // Преобразуем очищенный текст в поток
-    std::string word;
+// Страница просматривается один раз: токенизатор отдаёт слова видимого текста и ссылки, слова считаются
+// в буфере потока без выделения памяти, и только итоговые частоты переносятся в результат
+std::unordered_map<std::string, int> Indexer::extractWords(const std::string& html, const HtmlTokenizer::Callback& onLink) const {
+    Scratch& scratch = threadScratch();
+    scratch.counter.clear();
 
-    // Проходим по каждому слову в потоке
-    while (iss >> word) {
+    // Проходим по каждому слову видимого текста
+    scratch.tokenizer.scan(html, [&](std::string_view token) {
         try {
-            word = boost::locale::to_lower(word);  // Преобразуем слово в нижний регистр
+            toLower(token, scratch.folded);  // Преобразуем слово в нижний регистр
         }
         catch (const std::exception& ex) {
             logger.error("Ошибка в boost::locale::to_lower: " + std::string(ex.what()));  // Логируем ошибку в случае исключения
-            continue;
+            return;
         }
 
         // Пропускаем слова слишком короткие или слишком длинные
-        if (word.length() < 3 || word.length() > 32) continue;
+        if (scratch.folded.length() < 3 || scratch.folded.length() > 32) return;
 
-        // Пропускаем слова, которые являются стоп-словами (если это указано)
-        if (useStopwords && stopwords.count(word)) continue;
+        // Стоп-слово проверяется при первом появлении на странице, дальше его запись просто пропускается
+        bool inserted = false;
+        auto& entry = scratch.counter.find(scratch.folded, inserted);
+        if (inserted && useStopwords && stopwords.count(scratch.folded)) entry.count = -1;
+        if (entry.count >= 0) ++entry.count;  // Увеличиваем частоту найденного слова
+        }, onLink);
 
-        wordFreq[word]++;  // Увеличиваем частоту найденного слова
+    std::unordered_map<std::string, int> wordFreq;  // Мап для хранения частот слов
+    wordFreq.reserve(scratch.counter.size());
+    for (const auto& entry : scratch.counter.entries()) {
+        if (entry.count > 0) wordFreq.emplace(scratch.counter.term(entry), entry.count);
     }
-
     return wordFreq;  // Возвращаем частоты слов
 }
@@ -0,0 +1,95 @@
+#include "simhash_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace {
+
+    constexpr size_t minTerms = 16;     // Наименьшее число различных слов проверяемой страницы
+    constexpr int maxBlocks = 8;        // Наибольшее число блоков (расстояние до 7)
+
+    // FNV-1a с перемешиванием splitmix64: биты хэша слова должны быть независимы
+    uint64_t termHash(const std::string& term) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char ch : term) {
+            hash ^= ch;
+            hash *= 1099511628211ull;
+        }
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebull;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+    uint64_t blockValue(uint64_t fingerprint, int start, int end) {
+        uint64_t value = fingerprint >> start;
+        return end - start == 64 ? value : value & ((uint64_t(1) << (end - start)) - 1);
+    }
+
+} // namespace
+
+SimHashIndex::SimHashIndex(int maxDistance)
+    : maxDistance(std::min(maxDistance, maxBlocks - 1)) {
+    if (this->maxDistance < 0) return;
+
+    int blocks = this->maxDistance + 1;
+    for (int i = 0; i <= blocks; ++i) blockStart.push_back(i * 64 / blocks);
+    tables.resize(blocks);
+}
+
+// Каждое слово голосует за биты своего хэша с весом, равным частоте; бит отпечатка — знак суммы голосов
+uint64_t SimHashIndex::fingerprint(const std::unordered_map<std::string, int>& words) {
+    std::array<int64_t, 64> votes{};
+    for (const auto& [term, count] : words) {
+        uint64_t hash = termHash(term);
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += (hash >> bit) & 1 ? count : -count;
+        }
+    }
+
+    uint64_t result = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0) result |= uint64_t(1) << bit;
+    }
+    return result;
+}
+
+bool SimHashIndex::isNearDuplicate(const std::unordered_map<std::string, int>& words, uint64_t previous,
+    uint64_t* remembered) {
+    if (maxDistance < 0 || words.size() < minTerms) return false;
+
+    uint64_t print = fingerprint(words);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t block = 0; block < tables.size(); ++block) {
+        auto it = tables[block].find(blockValue(print, blockStart[block], blockStart[block + 1]));
+        if (it == tables[block].end()) continue;
+        for (uint64_t other : it->second) {
+            if (other != previous && std::popcount(print ^ other) <= maxDistance) return true;
+        }
+    }
+
+    if (print != previous) insert(print);
+    if (remembered) *remembered = print;
+    return false;
+}
+
+void SimHashIndex::remember(uint64_t fingerprint) {
+    if (maxDistance < 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(fingerprint);
+}
+
+void SimHashIndex::insert(uint64_t fingerprint) {
+    for (size_t block = 0; block < tables.size(); ++block) {
+        tables[block][blockValue(fingerprint, blockStart[block], blockStart[block + 1])].push_back(fingerprint);
+    }
+    ++count;
+}
+
+size_t SimHashIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
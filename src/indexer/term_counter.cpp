@@ -0,0 +1,58 @@
+#include "term_counter.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    constexpr size_t initialSlots = 1024;   // Начальный размер таблицы (страница редко содержит больше 700 слов)
+
+} // namespace
+
+void TermCounter::clear() {
+    items.clear();
+    arena.clear();
+    std::fill(slots.begin(), slots.end(), 0u);
+}
+
+TermCounter::Entry& TermCounter::find(std::string_view term, bool& inserted) {
+    // Заполненность не больше половины: пробы остаются короткими
+    if ((items.size() + 1) * 2 > slots.size()) grow();
+
+    uint32_t hash = hashOf(term);
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint32_t index = slots[slot];
+        if (index == 0) {
+            slots[slot] = static_cast<uint32_t>(items.size() + 1);
+            items.push_back({ static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(term.size()), hash, 0 });
+            arena.append(term);
+            inserted = true;
+            return items.back();
+        }
+        Entry& entry = items[index - 1];
+        if (entry.hash == hash && this->term(entry) == term) {
+            inserted = false;
+            return entry;
+        }
+    }
+}
+
+void TermCounter::grow() {
+    slots.assign(std::max(initialSlots, slots.size() * 2), 0u);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < items.size(); ++i) {
+        size_t slot = items[i].hash & mask;
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+// FNV-1a: слова короткие, поэтому побайтовый хэш не уступает более сложным
+uint32_t TermCounter::hashOf(std::string_view term) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char ch : term) {
+        hash ^= ch;
+        hash *= 16777619u;
+    }
+    return hash;
+}
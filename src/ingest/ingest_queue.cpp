@@ -0,0 +1,171 @@
+#include "ingest_queue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+    constexpr int saveAttempts = 5;                         // Попыток записи пачки, пока база данных недоступна
+    constexpr std::chrono::seconds firstRetryDelay(1);      // Пауза перед повтором, удваивается с каждой попыткой
+
+} // namespace
+
+// Конструктор класса IngestQueue, читает параметры отложенной записи из конфигурации
+IngestQueue::IngestQueue(const Config& config, Logger& logger, Database& db, StoredCallback onStored)
+    : logger(logger), db(db),
+    capacity(static_cast<size_t>(std::max(1, config.getIngestQueueSize()))),
+    batchSize(static_cast<size_t>(std::max(1, config.getIngestBatchSize()))),
+    flushInterval(std::max(1, config.getIngestFlushIntervalMs())),
+    writersCount(std::max(1, config.getIngestWriters())),
+    writeDatabase(config.shouldWriteDatabase()),
+    segmentDir(config.getSegmentDir()),
+    segmentFlushDocs(static_cast<size_t>(std::max(1, config.getSegmentFlushDocs()))),
+    onStored(std::move(onStored)) {
+}
+
+// Деструктор гарантирует, что ни одна принятая страница не потеряется
+IngestQueue::~IngestQueue() {
+    stop();
+}
+
+// Метод запуска потоков записи
+void IngestQueue::start() {
+    for (int i = 0; i < writersCount; ++i) {
+        writers.emplace_back([this]() { writerLoop(); });
+    }
+    logger.info("Запущено потоков записи в БД: " + std::to_string(writersCount) +
+        ", размер пачки: " + std::to_string(batchSize));
+    if (!writeDatabase && segmentDir.empty()) {
+        logger.warn("Запись в базу данных и в сегменты отключена: проиндексированные страницы не сохраняются.");
+    }
+}
+
+// Метод постановки страницы в очередь
+bool IngestQueue::push(Document document) {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        // Обратное давление: краулер ждёт, пока потоки записи не освободят место
+        notFull.wait(lock, [this]() { return queue.size() < capacity || closed; });
+        if (closed) return false;
+
+        queue.push_back(std::move(document));
+    }
+    notEmpty.notify_one(); // Будим поток записи
+    return true;
+}
+
+// Метод закрытия очереди и ожидания записи оставшихся страниц
+void IngestQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        closed = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+
+    for (auto& writer : writers) {
+        if (writer.joinable())
+            writer.join();
+    }
+    writers.clear();
+
+    // Остаток, не набравший полного сегмента, тоже записываем
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    flushSegment();
+}
+
+// Цикл потока записи
+void IngestQueue::writerLoop() {
+    std::vector<Document> batch;
+    batch.reserve(batchSize);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            notEmpty.wait(lock, [this]() { return !queue.empty() || closed; });
+            if (queue.empty()) return; // Очередь закрыта и полностью записана
+
+            // Даём пачке наполниться, но не дольше интервала сброса
+            notEmpty.wait_for(lock, flushInterval, [this]() { return queue.size() >= batchSize || closed; });
+
+            size_t count = std::min(batchSize, queue.size());
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        notFull.notify_all(); // Освободилось место для краулера
+
+        bool saved = !writeDatabase || saveBatch(batch);
+        if (!segmentDir.empty()) {
+            appendToSegment(batch, saved);
+        }
+        else if (saved && onStored) {
+            std::vector<std::string> urls;
+            for (const auto& document : batch) urls.push_back(document.url);
+            notifyStored(urls);
+        }
+        batch.clear();
+    }
+}
+
+// Метод записи пачки в базу данных: при ошибке (например, PostgreSQL перезапускается посреди обхода) пачка
+// записывается повторно с растущей паузой. Поток записи не завершается, а краулер тем временем ждёт места в очереди
+bool IngestQueue::saveBatch(const std::vector<Document>& batch) {
+    std::chrono::seconds delay = firstRetryDelay;
+    for (int attempt = 1;; ++attempt) {
+        try {
+            db.saveDocuments(batch); // Одна транзакция на всю пачку
+            return true;
+        }
+        catch (const std::exception& e) {
+            logger.error("Ошибка записи пачки в БД (попытка " + std::to_string(attempt) + " из " +
+                std::to_string(saveAttempts) + "): " + e.what());
+        }
+        if (attempt == saveAttempts) break;
+        std::this_thread::sleep_for(delay);
+        delay *= 2;
+    }
+    logger.error("Пачка не сохранена в БД, страниц: " + std::to_string(batch.size()));
+    return false;
+}
+
+// Метод добавления пачки в строящийся сегмент
+void IngestQueue::appendToSegment(const std::vector<Document>& batch, bool saved) {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    for (const auto& document : batch) {
+        if (saved && onStored) segmentUrls.push_back(document.url);
+        uint32_t length = 0;
+        for (const auto& [word, freq] : document.words) length += static_cast<uint32_t>(freq);
+
+        uint32_t doc = segment.addDocument(document.url, length);
+        for (const auto& [word, freq] : document.words) {
+            segment.addPosting(segment.termId(word), doc, static_cast<uint32_t>(freq));
+        }
+    }
+    if (segment.documentCount() >= segmentFlushDocs) {
+        flushSegment();
+    }
+}
+
+// Метод записи накопленного сегмента: страницы отмечаются сохранёнными только после записи файла, иначе
+// продолжение обхода после сбоя не загрузило бы их заново
+void IngestQueue::flushSegment() {
+    if (segmentDir.empty() || segment.documentCount() == 0) return;
+    try {
+        std::string path = segment.writeFile(segmentDir);
+        logger.info("Записан сегмент индекса: " + path + " (документов " + std::to_string(segment.documentCount()) + ")");
+        notifyStored(segmentUrls);
+    }
+    catch (const std::exception& e) {
+        logger.error(std::string("Ошибка записи сегмента индекса: ") + e.what());
+    }
+    segment.clear();
+    segmentUrls.clear();
+}
+
+// Метод оповещения о сохранённых страницах
+void IngestQueue::notifyStored(const std::vector<std::string>& urls) {
+    if (!onStored) return;
+    for (const auto& url : urls) onStored(url);
+}
@@ -53,6 +53,7 @@ int main(int argc, char* argv[]) {
         }
         else if (mode == "server") {
             logger.info("Режим: Сервер");
+            db.init();  // Те же миграции, что и у краулера: подготовленные запросы ссылаются на новые столбцы
             SearchServer server(config, logger, db, running); // Создаём объект сервера
             server.run(); // Запускаем сервер
         }
@@ -61,6 +62,8 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        db.logPoolStats(); // Выводим счётчики пула соединений
+
     }
     catch (const std::exception& ex) {
         // Ловим исключения и выводим сообщение об ошибке
@@ -0,0 +1,77 @@
+#include "http_session.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using boost::asio::use_awaitable;
+
+// Конструктор сессии: запоминает адрес клиента, пока сокет открыт
+HttpSession::HttpSession(boost::asio::ip::tcp::socket socket, const Handler& handler, std::chrono::seconds timeout, Logger& logger)
+    : stream(std::move(socket)), handler(handler), timeout(timeout), logger(logger) {
+    beast::error_code ec;
+    remote = stream.socket().remote_endpoint(ec);
+}
+
+void HttpSession::start() {
+    boost::asio::co_spawn(stream.get_executor(), run(shared_from_this()), boost::asio::detached);
+}
+
+// Цикл обслуживания соединения
+boost::asio::awaitable<void> HttpSession::run(std::shared_ptr<HttpSession> /*self*/) {
+    try {
+        while (true) {
+            // Чтение следующего запроса; клиент, не приславший его за таймаут, отключается
+            request = {};
+            stream.expires_after(timeout);
+            co_await http::async_read(stream, buffer, request, use_awaitable);
+
+            // Обработка запроса; исключение обработчика превращается в ответ 500
+            Response response;
+            bool failed = false;
+            try {
+                response = co_await handler(request, remote);
+            }
+            catch (const std::exception& e) {
+                logger.error(std::string("Ошибка обработки запроса: ") + e.what());
+                failed = true;
+            }
+            if (failed) response = internalError(); // co_await внутри catch недопустим, ответ собираем после
+            response.version(request.version());
+            response.keep_alive(request.keep_alive());
+            if (response.result() != http::status::not_modified) {
+                response.prepare_payload(); // У 304 тела нет, а Content-Length описывал бы полную версию
+            }
+
+            bool keepAlive = response.keep_alive();
+            stream.expires_after(timeout);
+            co_await http::async_write(stream, response, use_awaitable);
+
+            if (!keepAlive) break; // Иначе соединение остаётся открытым для следующего запроса
+        }
+    }
+    catch (const boost::system::system_error& e) {
+        const auto& ec = e.code();
+        if (ec != http::error::end_of_stream && ec != beast::error::timeout && ec != boost::asio::error::operation_aborted) {
+            logger.warn("Ошибка обмена с клиентом: " + ec.message());
+        }
+        if (ec != http::error::end_of_stream) co_return; // Клиент не закрывал соединение сам: сокет закроет деструктор
+    }
+    close();
+}
+
+// Ответ на ошибку обработчика
+HttpSession::Response HttpSession::internalError() const {
+    Response response(http::status::internal_server_error, request.version());
+    response.set(http::field::content_type, "text/plain; charset=utf-8");
+    response.body() = "500 Internal Server Error";
+    return response;
+}
+
+// Корректное закрытие соединения
+void HttpSession::close() {
+    beast::error_code ec;
+    stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_send, ec);
+}
@@ -0,0 +1,386 @@
+#include "index_segment.hpp"
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr char kMagic[8] = { 'S', 'E', 'G', 'I', 'D', 'X', '0', '1' };
+    constexpr uint32_t kVersion = 2; // 2: длины для BM25 (сумма длин, minLength слов и блоков)
+
+    // Заголовок файла сегмента
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t docCount;
+        uint32_t termCount;
+        uint32_t level;
+        uint64_t generation;
+        uint64_t firstGeneration;
+        uint64_t docTableOffset;
+        uint64_t urlDataOffset;
+        uint64_t termTableOffset;
+        uint64_t termDataOffset;
+        uint64_t postingsOffset;
+        uint64_t postingsSize;
+        uint64_t totalLength;
+    };
+    static_assert(sizeof(FileHeader) == 96, "FileHeader layout must not contain padding");
+
+    // Запись таблицы документов
+    struct DocEntry {
+        uint64_t urlOffset;  // Смещение URL в данных URL
+        uint32_t length;     // Длина документа (сумма частот слов)
+        uint32_t reserved;
+    };
+    static_assert(sizeof(DocEntry) == 16, "DocEntry layout must not contain padding");
+
+    // Запись словаря
+    struct TermEntry {
+        uint64_t textOffset;      // Смещение слова в данных слов
+        uint64_t postingsOffset;  // Смещение списка от начала раздела словопозиций
+        uint32_t textLength;      // Длина слова в байтах
+        uint32_t docFreq;         // Количество документов со словом
+        uint32_t maxFreq;         // Максимальная частота слова в документе
+        uint32_t minLength;       // Минимальная длина документа со словом
+    };
+    static_assert(sizeof(TermEntry) == 32, "TermEntry layout must not contain padding");
+
+    // Чтение записи из отображённой памяти (адрес может быть не выровнен)
+    template<typename T>
+    T load(const uint8_t* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    // Дописывание записи в буфер
+    template<typename T>
+    void append(std::vector<uint8_t>& out, const T& value) {
+        const auto* p = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    // Сброс файла на диск: без него после сбоя питания переименованный сегмент может оказаться пустым или недописанным
+    bool syncFile(std::FILE* file) {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(::fileno(file)) == 0;
+#endif
+    }
+
+    // Сброс каталога на диск, чтобы переименование пережило сбой (в Windows каталог так не сбрасывается)
+    void syncDirectory(const std::filesystem::path& directory) {
+#ifndef _WIN32
+        int fd = ::open(directory.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        ::fsync(fd);
+        ::close(fd);
+#else
+        (void)directory;
+#endif
+    }
+
+} // namespace
+
+// Открытие файла сегмента через mmap
+std::shared_ptr<IndexSegment> IndexSegment::open(const std::string& path) {
+    std::shared_ptr<IndexSegment> segment(new IndexSegment());
+    try {
+        segment->mapping = boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_only);
+        segment->region = boost::interprocess::mapped_region(segment->mapping, boost::interprocess::read_only);
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("Cannot map segment " + path + ": " + e.what());
+    }
+    segment->filePath = path;
+    segment->attach(static_cast<const uint8_t*>(segment->region.get_address()), segment->region.get_size());
+    return segment;
+}
+
+// Сегмент в памяти
+std::shared_ptr<IndexSegment> IndexSegment::fromBuffer(std::vector<uint8_t> bytes) {
+    std::shared_ptr<IndexSegment> segment(new IndexSegment());
+    segment->buffer = std::move(bytes);
+    segment->attach(segment->buffer.data(), segment->buffer.size());
+    return segment;
+}
+
+IndexSegment::~IndexSegment() {
+    if (obsolete && !filePath.empty()) {
+        // Сначала снимаем отображение: на Windows отображённый файл удалить нельзя
+        region = boost::interprocess::mapped_region();
+        mapping = boost::interprocess::file_mapping();
+        std::error_code ec;
+        std::filesystem::remove(filePath, ec);
+    }
+}
+
+// Проверка заголовка и разметка разделов
+void IndexSegment::attach(const uint8_t* bytes, size_t length) {
+    auto corrupt = [this](const char* what) {
+        return std::runtime_error("Corrupt segment " + (filePath.empty() ? std::string("<memory>") : filePath) + ": " + what);
+    };
+
+    if (length < sizeof(FileHeader)) throw corrupt("file too small");
+    auto header = load<FileHeader>(bytes);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) throw corrupt("bad magic");
+    if (header.version != kVersion) throw corrupt("unsupported version");
+
+    auto fits = [length](uint64_t offset, uint64_t bytesNeeded) {
+        return offset <= length && bytesNeeded <= length - offset;
+    };
+    if (!fits(header.docTableOffset, (static_cast<uint64_t>(header.docCount) + 1) * sizeof(DocEntry)) ||
+        !fits(header.termTableOffset, static_cast<uint64_t>(header.termCount) * sizeof(TermEntry)) ||
+        !fits(header.postingsOffset, header.postingsSize + PostingCodec::kPadding) ||
+        header.urlDataOffset > header.termTableOffset || header.termDataOffset > header.postingsOffset) {
+        throw corrupt("section out of bounds");
+    }
+
+    // Записи таблиц читаются при поиске без проверок, поэтому проверяем их один раз здесь:
+    // URL лежат между urlDataOffset и таблицей слов, слова — между termDataOffset и словопозициями
+    uint64_t urlBytes = header.termTableOffset - header.urlDataOffset;
+    uint64_t previousUrl = 0;
+    for (uint64_t doc = 0; doc <= header.docCount; ++doc) {
+        auto entry = load<DocEntry>(bytes + header.docTableOffset + doc * sizeof(DocEntry));
+        if (entry.urlOffset < previousUrl || entry.urlOffset > urlBytes) throw corrupt("document entry out of bounds");
+        previousUrl = entry.urlOffset;
+    }
+    // Списки словопозиций: заголовок и таблица блоков должны умещаться в разделе, а номера документов в
+    // заголовках блоков — в таблице документов (номера документов внутри блоков проверяются при использовании)
+    uint64_t textBytes = header.postingsOffset - header.termDataOffset;
+    for (uint64_t i = 0; i < header.termCount; ++i) {
+        auto entry = load<TermEntry>(bytes + header.termTableOffset + i * sizeof(TermEntry));
+        if (entry.textOffset > textBytes || entry.textLength > textBytes - entry.textOffset ||
+            entry.postingsOffset > header.postingsSize) {
+            throw corrupt("term entry out of bounds");
+        }
+        const uint8_t* list = bytes + header.postingsOffset + entry.postingsOffset;
+        if (!PostingCodec::validate(list, header.postingsSize - entry.postingsOffset, header.docCount) ||
+            load<uint32_t>(list) != entry.docFreq) {
+            throw corrupt("postings out of bounds");
+        }
+    }
+
+    base = bytes;
+    size = length;
+    gen = { header.generation, header.level, header.firstGeneration };
+    docCount = header.docCount;
+    lengthSum = header.totalLength;
+    termsCount = header.termCount;
+    docTable = bytes + header.docTableOffset;
+    urlData = bytes + header.urlDataOffset;
+    termTable = bytes + header.termTableOffset;
+    termData = bytes + header.termDataOffset;
+    postingsData = bytes + header.postingsOffset;
+}
+
+std::string_view IndexSegment::url(uint32_t doc) const {
+    if (doc >= docCount) return {};
+    auto entry = load<DocEntry>(docTable + doc * sizeof(DocEntry));
+    auto nextEntry = load<DocEntry>(docTable + (doc + 1) * sizeof(DocEntry));
+    return { reinterpret_cast<const char*>(urlData + entry.urlOffset), nextEntry.urlOffset - entry.urlOffset };
+}
+
+uint32_t IndexSegment::documentLength(uint32_t doc) const {
+    if (doc >= docCount) return 0;
+    return load<DocEntry>(docTable + doc * sizeof(DocEntry)).length;
+}
+
+IndexSegment::Term IndexSegment::termAt(uint32_t i) const {
+    auto entry = load<TermEntry>(termTable + i * sizeof(TermEntry));
+    return {
+        std::string_view(reinterpret_cast<const char*>(termData + entry.textOffset), entry.textLength),
+        postingsData + entry.postingsOffset,
+        entry.docFreq,
+        entry.maxFreq,
+        entry.minLength
+    };
+}
+
+bool IndexSegment::find(std::string_view word, Term& term) const {
+    uint32_t lo = 0, hi = termsCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        Term candidate = termAt(mid);
+        int cmp = candidate.text.compare(word);
+        if (cmp == 0) {
+            term = candidate;
+            return true;
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return false;
+}
+
+uint32_t SegmentBuilder::addDocument(std::string_view url, uint32_t length) {
+    urls.emplace_back(url);
+    lengths.push_back(length);
+    return static_cast<uint32_t>(urls.size() - 1);
+}
+
+uint32_t SegmentBuilder::termId(std::string_view word) {
+    auto it = termIds.find(std::string(word));
+    if (it != termIds.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(words.size());
+    termIds.emplace(std::string(word), id);
+    words.emplace_back(word);
+    lists.emplace_back();
+    return id;
+}
+
+void SegmentBuilder::addPosting(uint32_t termId, uint32_t doc, uint32_t freq) {
+    lists[termId].emplace_back(doc, freq);
+}
+
+void SegmentBuilder::clear() {
+    urls.clear();
+    lengths.clear();
+    termIds.clear();
+    words.clear();
+    lists.clear();
+}
+
+IndexSegment::Generation SegmentBuilder::newGeneration() {
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    uint64_t value = static_cast<uint64_t>(now);
+    return { value, 0, value };
+}
+
+// Сериализация сегмента
+std::vector<uint8_t> SegmentBuilder::build(const IndexSegment::Generation& generation) {
+    // Словарь упорядочен по слову, чтобы искать в нём двоичным поиском прямо в отображённом файле
+    std::vector<uint32_t> order(words.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return words[a] < words[b]; });
+
+    // Кодируем списки словопозиций
+    std::vector<uint8_t> postings;
+    std::vector<TermEntry> terms;
+    terms.reserve(order.size());
+    uint64_t textOffset = 0;
+    for (uint32_t id : order) {
+        auto& list = lists[id];
+        if (list.empty()) continue;
+        std::sort(list.begin(), list.end());
+
+        uint32_t maxFreq = 0;
+        uint32_t minLength = std::numeric_limits<uint32_t>::max();
+        for (const auto& [doc, freq] : list) {
+            maxFreq = std::max(maxFreq, freq);
+            minLength = std::min(minLength, doc < lengths.size() ? lengths[doc] : 0);
+        }
+
+        TermEntry entry{};
+        entry.textOffset = textOffset;
+        entry.postingsOffset = postings.size();
+        entry.textLength = static_cast<uint32_t>(words[id].size());
+        entry.docFreq = static_cast<uint32_t>(list.size());
+        entry.maxFreq = maxFreq;
+        entry.minLength = minLength;
+        terms.push_back(entry);
+
+        PostingCodec::encode(list, lengths, postings);
+        textOffset += words[id].size();
+    }
+
+    uint64_t urlBytes = 0;
+    for (const auto& url : urls) urlBytes += url.size();
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.docCount = static_cast<uint32_t>(urls.size());
+    header.termCount = static_cast<uint32_t>(terms.size());
+    header.level = generation.level;
+    header.generation = generation.value;
+    header.firstGeneration = generation.first;
+    header.docTableOffset = sizeof(FileHeader);
+    header.urlDataOffset = header.docTableOffset + (urls.size() + 1) * sizeof(DocEntry);
+    header.termTableOffset = header.urlDataOffset + urlBytes;
+    header.termDataOffset = header.termTableOffset + terms.size() * sizeof(TermEntry);
+    header.postingsOffset = header.termDataOffset + textOffset;
+    header.postingsSize = postings.size();
+    for (uint32_t length : lengths) header.totalLength += length;
+
+    std::vector<uint8_t> out;
+    out.reserve(header.postingsOffset + postings.size() + PostingCodec::kPadding);
+    append(out, header);
+
+    uint64_t urlOffset = 0;
+    for (size_t doc = 0; doc <= urls.size(); ++doc) {
+        DocEntry entry{ urlOffset, doc < urls.size() ? lengths[doc] : 0, 0 };
+        append(out, entry);
+        if (doc < urls.size()) urlOffset += urls[doc].size();
+    }
+    for (const auto& url : urls) out.insert(out.end(), url.begin(), url.end());
+
+    for (const auto& entry : terms) append(out, entry);
+    for (uint32_t id : order) {
+        if (!lists[id].empty()) out.insert(out.end(), words[id].begin(), words[id].end());
+    }
+
+    out.insert(out.end(), postings.begin(), postings.end());
+    out.resize(out.size() + PostingCodec::kPadding, 0);
+    return out;
+}
+
+// Атомарная запись сегмента в каталог
+std::string SegmentBuilder::writeFile(const std::string& directory, const IndexSegment::Generation& generation) {
+    return publishFile(directory, build(generation), generation, false);
+}
+
+std::string SegmentBuilder::writeFile(const std::string& directory) {
+    auto placeholder = newGeneration();
+    return publishFile(directory, build(placeholder), placeholder, true);
+}
+
+std::string SegmentBuilder::publishFile(const std::string& directory, std::vector<uint8_t> bytes,
+    IndexSegment::Generation generation, bool fresh) {
+    std::filesystem::create_directories(directory);
+
+    // Пишем во временный файл и переименовываем: читатели никогда не увидят недописанный сегмент
+    std::filesystem::path tmp = std::filesystem::path(directory) /
+        ("seg-" + std::to_string(generation.value) + "-" + std::to_string(generation.level) + ".tmp");
+    // Данные сбрасываются на диск до переименования: иначе после сбоя под именем сегмента может оказаться пустой файл
+    if (fresh) {
+        generation = newGeneration();
+        std::memcpy(bytes.data() + offsetof(FileHeader, generation), &generation.value, sizeof(generation.value));
+        std::memcpy(bytes.data() + offsetof(FileHeader, firstGeneration), &generation.first, sizeof(generation.first));
+    }
+    std::FILE* out = std::fopen(tmp.string().c_str(), "wb");
+    bool written = out && std::fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size() &&
+        std::fflush(out) == 0 && syncFile(out);
+    if (out && std::fclose(out) != 0) written = false;
+    if (!written) throw std::runtime_error("Cannot write segment " + tmp.string());
+
+    // Имя нужно только для уникальности: порядок сегментов определяется поколением из заголовка
+    char name[64];
+    std::snprintf(name, sizeof(name), "seg-%020llu-%02u",
+        static_cast<unsigned long long>(generation.value), static_cast<unsigned>(generation.level));
+    std::filesystem::path path = std::filesystem::path(directory) / (std::string(name) + ".seg");
+    for (int suffix = 1; std::filesystem::exists(path); ++suffix) {
+        path = std::filesystem::path(directory) / (std::string(name) + "-" + std::to_string(suffix) + ".seg");
+    }
+    std::filesystem::rename(tmp, path);
+    syncDirectory(directory);
+    return path.string();
+}
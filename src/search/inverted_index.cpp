@@ -0,0 +1,530 @@
+#include "inverted_index.hpp"
+#include "bm25.hpp"
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_set>
+
+// Конструктор класса InvertedIndex
+InvertedIndex::InvertedIndex(const Config& config, Logger& logger)
+    : logger(logger),
+    segmentDir(config.getSegmentDir()),
+    mergeFactor(static_cast<size_t>(std::max(2, config.getMergeFactor()))),
+    mergeInterval(std::max(1, config.getMergeIntervalMs())),
+    queryMode(config.getQueryMode() == "any" ? TopKEvaluator::Mode::Disjunctive : TopKEvaluator::Mode::Conjunctive),
+    topKStrategy(config.getTopKAlgorithm() == "exhaustive" ? TopKEvaluator::Strategy::Exhaustive : TopKEvaluator::Strategy::BlockMaxWand),
+    current(std::make_shared<Snapshot>()) {
+}
+
+InvertedIndex::~InvertedIndex() {
+    stopMerging();
+}
+
+// Метод загрузки индекса
+InvertedIndex::LoadResult InvertedIndex::load(Database& db) {
+    std::unique_lock<std::mutex> loadLock(loadMutex, std::try_to_lock);
+    if (!loadLock.owns_lock()) return merging ? LoadResult::MergeInProgress : LoadResult::ReloadInProgress;
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<IndexSegment>> segments;
+
+    if (!segmentDir.empty()) {
+        segments = openDirectory(*snapshot());
+    }
+    if (segments.empty()) {
+        // Сегментов ещё нет: строим первый из системы учёта (базы данных)
+        segments.push_back(buildFromDatabase(db));
+    }
+
+    size_t documents = 0, terms = 0, bytes = 0;
+    for (const auto& segment : segments) {
+        documents += segment->documentCount();
+        terms += segment->termCount();
+        bytes += segment->sizeBytes();
+    }
+    size_t count = segments.size();
+    publish(makeSnapshot(std::move(segments)));
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    logger.info("Индекс загружен: сегментов " + std::to_string(count) +
+        ", документов " + std::to_string(documents) +
+        ", слов " + std::to_string(terms) +
+        ", байт " + std::to_string(bytes) +
+        ", SIMD-распаковка " + (PostingCodec::simdAvailable() ? "включена" : "недоступна") +
+        ", за " + std::to_string(elapsed.count()) + " мс");
+    return LoadResult::Loaded;
+}
+
+// Построение сегмента из таблиц pages/words/index
+std::shared_ptr<IndexSegment> InvertedIndex::buildFromDatabase(Database& db) {
+    SegmentBuilder builder;
+    std::unordered_map<int, uint32_t> pageToDoc;   // ID страницы -> номер документа
+    std::unordered_map<int, uint32_t> wordToTerm;  // ID слова -> номер слова в построителе
+    std::vector<std::pair<std::string, uint32_t>> pages; // URL и длина документа
+    struct Posting { uint32_t term, doc, freq; };
+    std::vector<Posting> postings;
+    size_t skipped = 0;
+
+    db.scanCorpus(
+        [&](int pageId, std::string_view url) {
+            pageToDoc.emplace(pageId, static_cast<uint32_t>(pages.size()));
+            pages.emplace_back(std::string(url), 0);
+        },
+        [&](int wordId, std::string_view word) {
+            wordToTerm.emplace(wordId, builder.termId(word));
+        },
+        [&](int wordId, int pageId, int frequency) {
+            auto doc = pageToDoc.find(pageId);
+            auto term = wordToTerm.find(wordId);
+            if (doc == pageToDoc.end() || term == wordToTerm.end() || frequency <= 0) {
+                skipped++;
+                return;
+            }
+            pages[doc->second].second += static_cast<uint32_t>(frequency);
+            postings.push_back({ term->second, doc->second, static_cast<uint32_t>(frequency) });
+        });
+
+    for (const auto& [url, length] : pages) builder.addDocument(url, length);
+    for (const auto& posting : postings) builder.addPosting(posting.term, posting.doc, posting.freq);
+    std::vector<Posting>().swap(postings);
+
+    if (skipped > 0) {
+        logger.warn("Пропущено записей индекса без страницы или слова: " + std::to_string(skipped));
+    }
+
+    if (segmentDir.empty()) {
+        return IndexSegment::fromBuffer(builder.build(SegmentBuilder::newGeneration()));
+    }
+    std::string path = builder.writeFile(segmentDir);
+    logger.info("Сегмент построен из базы данных: " + path);
+    return IndexSegment::open(path);
+}
+
+// Открытие сегментов каталога
+std::vector<std::shared_ptr<IndexSegment>> InvertedIndex::openDirectory(const Snapshot& previous) {
+    std::vector<std::shared_ptr<IndexSegment>> segments;
+    std::filesystem::create_directories(segmentDir);
+
+    for (const auto& entry : std::filesystem::directory_iterator(segmentDir)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".seg") continue;
+        std::string path = entry.path().string();
+
+        auto open = std::find_if(previous.segments.begin(), previous.segments.end(),
+            [&path](const auto& segment) { return segment->path() == path; });
+        if (open != previous.segments.end()) {
+            segments.push_back(*open); // Уже отображён: переиспользуем
+            continue;
+        }
+        try {
+            segments.push_back(IndexSegment::open(path));
+        }
+        catch (const std::exception& e) {
+            logger.error(std::string("Сегмент пропущен: ") + e.what());
+        }
+    }
+
+    // Сегменты, чьи поколения уже вошли в слитый сегмент (слияние прервалось до удаления исходных файлов), удаляем
+    std::vector<std::shared_ptr<IndexSegment>> alive;
+    for (const auto& segment : segments) {
+        const auto& g = segment->generation();
+        bool superseded = std::any_of(segments.begin(), segments.end(), [&g](const auto& other) {
+            const auto& m = other->generation();
+            return m.level > g.level && m.first <= g.first && g.value <= m.value;
+        });
+        if (superseded) {
+            segment->markObsolete();
+        }
+        else {
+            alive.push_back(segment);
+        }
+    }
+
+    std::sort(alive.begin(), alive.end(), [](const auto& a, const auto& b) {
+        return a->generation() < b->generation();
+    });
+    return alive;
+}
+
+// Сборка снимка: документ перекрыт, если тот же URL есть в более новом сегменте
+// Для единственного сегмента (обычное состояние после слияния) ничего не вычисляется, и старт остаётся O(1)
+std::shared_ptr<const InvertedIndex::Snapshot> InvertedIndex::makeSnapshot(std::vector<std::shared_ptr<IndexSegment>> segments) {
+    static std::atomic<uint64_t> generations{ 0 };
+    auto next = std::make_shared<Snapshot>();
+    next->generation = ++generations;
+    next->segments = std::move(segments);
+    next->shadowed.resize(next->segments.size());
+    for (const auto& segment : next->segments) {
+        next->documents += segment->documentCount();
+        next->totalLength += segment->totalLength();
+    }
+    if (next->segments.size() < 2) return next;
+
+    std::unordered_set<std::string_view> newer;
+    for (size_t s = next->segments.size(); s-- > 0;) {
+        const IndexSegment& segment = *next->segments[s];
+        std::vector<bool> shadowed(segment.documentCount(), false);
+        bool any = false;
+        for (uint32_t doc = segment.documentCount(); doc-- > 0;) { // Внутри сегмента более поздний документ новее
+            if (!newer.insert(segment.url(doc)).second) {
+                shadowed[doc] = true;
+                any = true;
+                next->documents--; // Перекрытые документы не входят в статистику BM25
+                next->totalLength -= segment.documentLength(doc);
+            }
+        }
+        if (any) next->shadowed[s] = std::move(shadowed);
+    }
+    return next;
+}
+
+// Средняя длина актуального документа
+float InvertedIndex::Snapshot::averageLength() const {
+    return documents > 0 ? static_cast<float>(static_cast<double>(totalLength) / static_cast<double>(documents)) : 0.0f;
+}
+
+// Метод получения текущего снимка
+std::shared_ptr<const InvertedIndex::Snapshot> InvertedIndex::snapshot() const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return current;
+}
+
+// Метод подмены текущего снимка
+void InvertedIndex::publish(std::shared_ptr<const Snapshot> next) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    current = std::move(next);
+}
+
+// Количество документов в текущем снимке
+size_t InvertedIndex::documentCount() const {
+    size_t documents = 0;
+    for (const auto& segment : snapshot()->segments) documents += segment->documentCount();
+    return documents;
+}
+
+// Вывод перцентилей задержки поиска
+void InvertedIndex::logSearchStats() const {
+    if (latency.count() == 0) return;
+    logger.info(std::string("Задержка поиска (") +
+        (queryMode == TopKEvaluator::Mode::Conjunctive ? "все слова" : "любое слово") + ", " +
+        (topKStrategy == TopKEvaluator::Strategy::BlockMaxWand ? "blockmax" : "exhaustive") + "): " +
+        latency.summary());
+}
+
+// Количество сегментов в текущем снимке
+size_t InvertedIndex::segmentCount() const {
+    return snapshot()->segments.size();
+}
+
+namespace {
+
+    // Курсор индекса в памяти: снимок, оценка и позиция (сегмент, документ) последнего показанного результата
+    struct IndexCursor {
+        uint64_t generation = 0;
+        float score = 0.0f;
+        uint64_t segment = 0;
+        uint32_t doc = 0;
+    };
+
+    // Поля в шестнадцатеричном виде через точку; оценка хранится битами, чтобы сравнение было точным
+    std::string encodeCursor(const IndexCursor& cursor) {
+        uint32_t bits;
+        std::memcpy(&bits, &cursor.score, sizeof(bits));
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%llx.%x.%llx.%x", static_cast<unsigned long long>(cursor.generation),
+            bits, static_cast<unsigned long long>(cursor.segment), cursor.doc);
+        return buffer;
+    }
+
+    bool decodeCursor(const std::string& text, IndexCursor& cursor) {
+        if (text.find_first_not_of("0123456789abcdef.") != std::string::npos) return false;
+        unsigned long long generation = 0, segment = 0;
+        unsigned int bits = 0, doc = 0;
+        if (std::sscanf(text.c_str(), "%llx.%x.%llx.%x", &generation, &bits, &segment, &doc) != 4) return false;
+        cursor.generation = generation;
+        std::memcpy(&cursor.score, &bits, sizeof(bits));
+        cursor.segment = segment;
+        cursor.doc = doc;
+        return std::isfinite(cursor.score);
+    }
+
+} // namespace
+
+// Метод поиска: отбор лучших документов в каждом сегменте и объединение результатов
+SearchPage InvertedIndex::search(const std::vector<std::string>& queryWords, size_t limit, size_t offset,
+    const std::string& cursor) const {
+    SearchPage page;
+    if (queryWords.empty() || limit == 0) return page;
+
+    IndexCursor after;
+    if (!cursor.empty() && !decodeCursor(cursor, after)) {
+        throw std::invalid_argument("Некорректный курсор");
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    auto index = snapshot(); // Снимок остаётся живым до конца запроса, даже если индекс перезагрузят
+
+    // Уникальные слова запроса
+    std::vector<std::string_view> words(queryWords.begin(), queryWords.end());
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // Ищем слова в словарях сегментов один раз: найденные записи нужны и для IDF, и для отбора
+    const size_t segmentCount = index->segments.size();
+    std::vector<std::vector<IndexSegment::Term>> found(segmentCount, std::vector<IndexSegment::Term>(words.size()));
+    std::vector<std::vector<bool>> present(segmentCount, std::vector<bool>(words.size(), false));
+    for (size_t s = 0; s < segmentCount; ++s) {
+        for (size_t w = 0; w < words.size(); ++w) {
+            present[s][w] = index->segments[s]->find(words[w], found[s][w]);
+        }
+    }
+
+    // Документная частота слова складывается из словарей сегментов
+    // (копии страницы в ещё не слитых сегментах считаются несколько раз, слияние это исправляет)
+    std::vector<uint64_t> docFreq(words.size(), 0);
+    for (size_t s = 0; s < segmentCount; ++s) {
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (present[s][w]) docFreq[w] += found[s][w].docFreq;
+        }
+    }
+
+    // IDF берём из кэша снимка, при промахе считаем по документной частоте
+    std::vector<float> idf(words.size());
+    {
+        std::lock_guard<std::mutex> lock(index->idfMutex);
+        for (size_t w = 0; w < words.size(); ++w) {
+            auto cached = index->idfCache.find(std::string(words[w]));
+            if (cached != index->idfCache.end()) {
+                idf[w] = cached->second;
+                continue;
+            }
+            idf[w] = Bm25::idf(index->documents, docFreq[w]);
+            if (docFreq[w] > 0) index->idfCache.emplace(std::string(words[w]), idf[w]); // Кэш ограничен словарём индекса
+        }
+    }
+
+    // Кандидат: оценка, номер сегмента, номер документа в сегменте
+    struct Candidate {
+        float score;
+        size_t segment;
+        uint32_t doc;
+    };
+    std::vector<Candidate> candidates;
+
+    // В кучу каждого сегмента попадают offset + limit документов после курсора: цена страницы растёт со смещением,
+    // но не с номером страницы, если листать курсором
+    const size_t depth = offset + limit;
+    const bool sameSnapshot = !cursor.empty() && after.generation == index->generation;
+    TopKEvaluator evaluator(depth, queryMode, topKStrategy, index->averageLength());
+    std::vector<TopKEvaluator::Term> terms;
+    for (size_t s = 0; s < segmentCount; ++s) {
+        // В режиме "все слова" отсутствие любого слова в сегменте означает, что совпадений в нём нет
+        terms.clear();
+        bool complete = true;
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (!present[s][w]) {
+                complete = false;
+                continue;
+            }
+            const auto& term = found[s][w];
+            terms.push_back({ term.postings, term.docFreq, term.maxFreq, term.minLength, idf[w] });
+        }
+        if (terms.empty() || (!complete && queryMode == TopKEvaluator::Mode::Conjunctive)) continue;
+
+        // Позиция курсора внутри сегмента: при равной оценке документы упорядочены по (сегмент, номер).
+        // Если индекс с тех пор перезагружен, номера сегментов другие, и продолжаем только по оценке
+        TopKEvaluator::After bound;
+        if (!cursor.empty()) {
+            constexpr uint64_t kNoTies = uint64_t(1) << 32;
+            bound.score = after.score;
+            bound.firstTiedDoc = !sameSnapshot || s < after.segment ? kNoTies
+                : s == after.segment ? uint64_t(after.doc) + 1 : 0;
+        }
+
+        // Устаревшие версии страниц (актуальная лежит в более новом сегменте) в результат не попадают
+        for (const auto& hit : evaluator.run(terms, *index->segments[s], index->shadowed[s], bound)) {
+            candidates.push_back({ hit.score, s, hit.doc });
+        }
+    }
+
+    // Объединяем лучшие документы всех сегментов
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.segment != b.segment) return a.segment < b.segment;
+        return a.doc < b.doc;
+    });
+    const size_t matched = candidates.size();
+    const bool more = matched >= depth;
+    if (candidates.size() > depth) candidates.resize(depth);
+    candidates.erase(candidates.begin(), candidates.begin() + std::min(offset, candidates.size()));
+
+    page.results.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        page.results.emplace_back(std::string(index->segments[candidate.segment]->url(candidate.doc)), candidate.score);
+    }
+    if (more && !candidates.empty()) {
+        const auto& last = candidates.back();
+        page.nextCursor = encodeCursor({ index->generation, last.score, last.segment, last.doc });
+    }
+
+    // Точное число совпадений отбор лучших не считает: оцениваем его по документным частотам,
+    // считая слова независимыми, и ограничиваем тем, что известно наверняка
+    double documents = static_cast<double>(index->documents);
+    if (documents > 0) {
+        double estimate;
+        if (queryMode == TopKEvaluator::Mode::Conjunctive) {
+            estimate = documents;
+            double smallest = documents;
+            for (uint64_t df : docFreq) {
+                estimate *= static_cast<double>(df) / documents;
+                smallest = std::min(smallest, static_cast<double>(df));
+            }
+            estimate = std::min(estimate, smallest);
+        }
+        else {
+            double missing = 1.0;
+            double largest = 0.0;
+            for (uint64_t df : docFreq) {
+                missing *= 1.0 - std::min(1.0, static_cast<double>(df) / documents);
+                largest = std::max(largest, static_cast<double>(df));
+            }
+            estimate = std::max(documents * (1.0 - missing), largest);
+        }
+        page.total = static_cast<uint64_t>(std::llround(estimate));
+    }
+    if (cursor.empty()) page.total = std::max<uint64_t>(page.total, offset + page.results.size());
+    if (!more && cursor.empty()) {
+        page.total = matched; // Все совпадения поместились в кучи сегментов: число известно точно
+        page.exactTotal = true;
+    }
+
+    latency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+    return page;
+}
+
+// Метод запуска фонового слияния
+void InvertedIndex::startMerging() {
+    if (segmentDir.empty() || mergeThread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        mergeStopping = false;
+    }
+    mergeThread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mergeMutex);
+        while (!mergeCv.wait_for(lock, mergeInterval, [this]() { return mergeStopping; })) {
+            lock.unlock();
+            try {
+                while (mergeOnce()) {
+                    // Сливаем, пока сегментов больше, чем mergeFactor
+                }
+            }
+            catch (const std::exception& e) {
+                logger.error(std::string("Ошибка слияния сегментов: ") + e.what());
+            }
+            lock.lock();
+        }
+        });
+}
+
+// Метод остановки фонового слияния
+void InvertedIndex::stopMerging() {
+    {
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        mergeStopping = true;
+    }
+    mergeCv.notify_all();
+    if (mergeThread.joinable()) mergeThread.join();
+}
+
+// Слияние соседних сегментов
+bool InvertedIndex::mergeOnce() {
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    merging = true;
+    struct MergingReset {
+        std::atomic<bool>& flag;
+        ~MergingReset() { flag = false; }
+    } mergingReset{ merging };
+    {
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        if (mergeStopping) return false;
+    }
+
+    auto base = snapshot();
+    const auto& segments = base->segments;
+    if (segments.size() <= mergeFactor) return false;
+    for (const auto& segment : segments) {
+        if (segment->path().empty()) return false; // Сегменты только в памяти не сливаются
+    }
+
+    // Сливаем только соседние по поколению сегменты, иначе нарушится правило «новый сегмент перекрывает старый»;
+    // из всех окон выбираем самое маленькое по размеру
+    size_t bestStart = 0, bestSize = SIZE_MAX;
+    for (size_t start = 0; start + mergeFactor <= segments.size(); ++start) {
+        size_t total = 0;
+        for (size_t i = start; i < start + mergeFactor; ++i) total += segments[i]->sizeBytes();
+        if (total < bestSize) {
+            bestSize = total;
+            bestStart = start;
+        }
+    }
+    auto first = segments.begin() + static_cast<std::ptrdiff_t>(bestStart);
+    auto last = first + static_cast<std::ptrdiff_t>(mergeFactor);
+
+    auto started = std::chrono::steady_clock::now();
+    SegmentBuilder builder;
+
+    // Документы берём от новых сегментов к старым: устаревшие копии того же URL отбрасываются
+    std::vector<std::vector<int64_t>> docMaps(mergeFactor);
+    std::unordered_set<std::string_view> seen;
+    for (size_t i = mergeFactor; i-- > 0;) {
+        const IndexSegment& segment = *first[static_cast<std::ptrdiff_t>(i)];
+        docMaps[i].assign(segment.documentCount(), -1);
+        for (uint32_t doc = segment.documentCount(); doc-- > 0;) {
+            std::string_view url = segment.url(doc);
+            if (seen.insert(url).second) {
+                docMaps[i][doc] = builder.addDocument(url, segment.documentLength(doc));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < mergeFactor; ++i) {
+        const IndexSegment& segment = *first[static_cast<std::ptrdiff_t>(i)];
+        for (uint32_t t = 0; t < segment.termCount(); ++t) {
+            IndexSegment::Term term = segment.termAt(t);
+            uint32_t id = builder.termId(term.text);
+            for (PostingCodec::Cursor cursor(term.postings); cursor.valid(); cursor.next()) {
+                if (cursor.doc() >= docMaps[i].size()) continue; // Документа нет в таблице сегмента
+                int64_t doc = docMaps[i][cursor.doc()];
+                if (doc >= 0) builder.addPosting(id, static_cast<uint32_t>(doc), cursor.freq());
+            }
+        }
+    }
+
+    // Слитый сегмент занимает место самого нового из исходных
+    IndexSegment::Generation generation{ (*(last - 1))->generation().value, 0, (*first)->generation().first };
+    for (auto it = first; it != last; ++it) {
+        generation.level = std::max(generation.level, (*it)->generation().level + 1);
+    }
+    std::string path = builder.writeFile(segmentDir, generation);
+    auto merged = IndexSegment::open(path);
+
+    std::vector<std::shared_ptr<IndexSegment>> nextSegments(segments.begin(), first);
+    nextSegments.push_back(merged);
+    nextSegments.insert(nextSegments.end(), last, segments.end());
+    publish(makeSnapshot(std::move(nextSegments)));
+
+    // Исходные файлы удалятся, когда их перестанут использовать запросы, начатые до подмены
+    for (auto it = first; it != last; ++it) (*it)->markObsolete();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    logger.info("Слито сегментов: " + std::to_string(mergeFactor) +
+        " -> " + path + " (документов " + std::to_string(merged->documentCount()) +
+        ", за " + std::to_string(elapsed.count()) + " мс)");
+    return true;
+}
@@ -0,0 +1,114 @@
+#include "json_writer.hpp"
+
+#include <charconv>
+#include <cmath>
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false; // Значение поля идёт сразу после двоеточия
+        return;
+    }
+    if (!empty.empty()) {
+        if (!empty.back()) out += ',';
+        empty.back() = false;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out += '{';
+    empty.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out += '}';
+    empty.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out += '[';
+    empty.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out += ']';
+    empty.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    writeString(name);
+    out += ':';
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    writeString(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separate();
+    if (!std::isfinite(number)) {
+        out += "null";
+        return *this;
+    }
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number); // Кратчайшая точная запись
+    out.append(buffer, ec == std::errc() ? end : buffer);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t number) {
+    separate();
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, ec == std::errc() ? end : buffer);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out += "null";
+    return *this;
+}
+
+// Экранируются кавычка, обратная косая черта и управляющие символы; байты UTF-8 пишутся как есть
+void JsonWriter::writeString(std::string_view text) {
+    static const char digits[] = "0123456789abcdef";
+    out += '"';
+    size_t plain = 0; // Начало ещё не записанного участка без спецсимволов
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+        out.append(text.data() + plain, i - plain);
+        plain = i + 1;
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += digits[ch >> 4];
+            out += digits[ch & 15];
+        }
+    }
+    out.append(text.data() + plain, text.size() - plain);
+    out += '"';
+}
@@ -0,0 +1,60 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+
+// Номер корзины: старший бит задаёт степень двойки, следующие два бита — четверть внутри неё
+size_t LatencyHistogram::bucketOf(uint64_t micros) {
+    if (micros < kSubBuckets) return static_cast<size_t>(micros);
+    unsigned exponent = static_cast<unsigned>(std::bit_width(micros)) - 1;
+    size_t sub = static_cast<size_t>((micros >> (exponent - 2)) & (kSubBuckets - 1));
+    return (exponent - 1) * kSubBuckets + sub;
+}
+
+// Наибольшее значение, попадающее в корзину
+uint64_t LatencyHistogram::upperBound(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    unsigned exponent = static_cast<unsigned>(bucket / kSubBuckets) + 1;
+    uint64_t sub = bucket % kSubBuckets;
+    uint64_t step = uint64_t{ 1 } << (exponent - 2);
+    return (uint64_t{ 1 } << exponent) + (sub + 1) * step - 1;
+}
+
+void LatencyHistogram::record(std::chrono::microseconds elapsed) {
+    uint64_t micros = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t seen = maximum.load(std::memory_order_relaxed);
+    while (micros > seen && !maximum.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+
+    // Ранг замера, который должен оказаться не выше искомой границы
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(n) + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > n) rank = n;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(upperBound(i), maximum.load(std::memory_order_relaxed));
+    }
+    return maximum.load(std::memory_order_relaxed);
+}
+
+std::string LatencyHistogram::summary() const {
+    return "запросов " + std::to_string(count()) +
+        ", p50 " + std::to_string(percentile(50)) + " мкс" +
+        ", p95 " + std::to_string(percentile(95)) + " мкс" +
+        ", p99 " + std::to_string(percentile(99)) + " мкс" +
+        ", максимум " + std::to_string(maximum.load(std::memory_order_relaxed)) + " мкс";
+}
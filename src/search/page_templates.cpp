@@ -0,0 +1,172 @@
+#include "page_templates.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+namespace http = boost::beast::http;
+
+namespace {
+
+    // Чтение файла целиком; пустой результат — файл не прочитан
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return {};
+        std::ostringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    // ETag: хэш FNV-1a содержимого в шестнадцатеричном виде
+    std::string makeEtag(std::string_view content) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char ch : content) {
+            hash ^= ch;
+            hash *= 1099511628211ull;
+        }
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "\"%016llx\"", static_cast<unsigned long long>(hash));
+        return buffer;
+    }
+
+    // Время изменения файла в формате HTTP-даты (RFC 9110, IMF-fixdate)
+    // Названия дней и месяцев задаются явно, чтобы результат не зависел от локали
+    std::string httpDate(const std::string& path) {
+        std::error_code ec;
+        auto written = std::filesystem::last_write_time(path, ec);
+        if (ec) return {};
+        auto system = std::chrono::file_clock::to_sys(written);
+        std::time_t time = std::chrono::system_clock::to_time_t(
+            std::chrono::time_point_cast<std::chrono::system_clock::duration>(system));
+
+        const std::tm* utc = std::gmtime(&time); // Вызывается только при запуске сервера
+        if (!utc) return {};
+        static const std::array<const char*, 7> days = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+        static const std::array<const char*, 12> months = {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+            days[utc->tm_wday], utc->tm_mday, months[utc->tm_mon], utc->tm_year + 1900,
+            utc->tm_hour, utc->tm_min, utc->tm_sec);
+        return buffer;
+    }
+
+    // Сравнение ETag со списком из If-None-Match (слабые метки W/ сравниваются по значению)
+    bool etagMatches(std::string_view header, std::string_view etag) {
+        while (!header.empty()) {
+            size_t comma = header.find(',');
+            std::string_view item = header.substr(0, comma);
+            header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+
+            while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+            if (item.substr(0, 2) == "W/") item.remove_prefix(2);
+            if (item == "*" || item == etag) return true;
+        }
+        return false;
+    }
+
+} // namespace
+
+// Метод для чтения статического файла
+StaticAsset StaticAsset::load(const std::string& path, std::string contentType) {
+    StaticAsset asset;
+    asset.contentType = std::move(contentType);
+    std::string content = readFile(path);
+    if (content.empty()) return asset;
+
+    asset.etag = makeEtag(content);
+    asset.lastModified = httpDate(path);
+    asset.body = std::make_shared<const std::string>(std::move(content));
+
+    // Сжимаем один раз с максимальным уровнем; вариант храним, только если он меньше оригинала
+    auto precompress = [&](ContentEncoding encoding) -> std::shared_ptr<const std::string> {
+        std::string packed = ResponseEncoder::compress(encoding, { asset.body }, ResponseEncoder::maxLevel(encoding));
+        if (packed.size() >= asset.body->size()) return nullptr;
+        return std::make_shared<const std::string>(std::move(packed));
+        };
+    asset.gzip = precompress(ContentEncoding::Gzip);
+#ifdef HAVE_BROTLI
+    asset.brotli = precompress(ContentEncoding::Brotli);
+#endif
+    return asset;
+}
+
+// Метод для проверки условного запроса
+bool StaticAsset::notModified(const HttpSession::Request& req, const std::string& tag) const {
+    // If-None-Match главнее If-Modified-Since (RFC 9110, 13.1.3)
+    auto noneMatch = req.find(http::field::if_none_match);
+    if (noneMatch != req.end()) {
+        return etagMatches(std::string_view(noneMatch->value().data(), noneMatch->value().size()), tag);
+    }
+    // Браузеры возвращают Last-Modified без изменений, поэтому достаточно сравнить строки
+    auto modifiedSince = req.find(http::field::if_modified_since);
+    return modifiedSince != req.end() && !lastModified.empty() &&
+        std::string_view(modifiedSince->value().data(), modifiedSince->value().size()) == lastModified;
+}
+
+// Метод для формирования ответа со статическим файлом
+HttpSession::Response StaticAsset::respond(const HttpSession::Request& req, const ResponseEncoder& encoder) const {
+    HttpSession::Response res;
+    res.version(req.version());
+    if (!body) {
+        res.result(http::status::not_found);
+        res.set(http::field::content_type, "text/html");
+        res.body() = "404 Not Found";
+        return res;
+    }
+
+    // Вариант по Accept-Encoding клиента; метка варианта отличается от метки оригинала суффиксом
+    auto header = req[http::field::accept_encoding];
+    ContentEncoding encoding = encoder.negotiate(std::string_view(header.data(), header.size()));
+    const std::shared_ptr<const std::string>* selected = &body;
+    if (encoding == ContentEncoding::Gzip && gzip) selected = &gzip;
+    else if (encoding == ContentEncoding::Brotli && brotli) selected = &brotli;
+    else encoding = ContentEncoding::Identity; // Сжатие не уменьшило файл: отдаём как есть
+    std::string tag = encoding == ContentEncoding::Identity
+        ? etag : etag.substr(0, etag.size() - 1) + "-" + ResponseEncoder::name(encoding) + "\"";
+
+    res.set(http::field::etag, tag);
+    if (!lastModified.empty()) res.set(http::field::last_modified, lastModified);
+    res.set(http::field::cache_control, "no-cache"); // Копию можно хранить, но перед показом нужно переспросить
+    if (encoder.enabled()) res.set(http::field::vary, "Accept-Encoding");
+
+    if (notModified(req, tag)) {
+        res.result(http::status::not_modified);
+        return res;
+    }
+    res.result(http::status::ok);
+    res.set(http::field::content_type, contentType);
+    if (encoding != ContentEncoding::Identity) res.set(http::field::content_encoding, ResponseEncoder::name(encoding));
+    res.body().append(*selected); // Общий буфер, без копирования
+    return res;
+}
+
+// Метод для чтения шаблона страницы
+PageTemplate PageTemplate::load(const std::string& path, const std::string& marker) {
+    PageTemplate page;
+    std::string content = readFile(path);
+    if (content.empty()) return page;
+
+    size_t pos = content.find(marker);
+    if (pos == std::string::npos) pos = content.size();
+    page.suffix = std::make_shared<const std::string>(content.substr(std::min(content.size(), pos + marker.size())));
+    content.resize(pos);
+    page.prefix = std::make_shared<const std::string>(std::move(content));
+    return page;
+}
+
+// Метод для сборки страницы со вставкой
+SegmentedBody::value_type PageTemplate::render(std::shared_ptr<const std::string> insert) const {
+    SegmentedBody::value_type body;
+    body.append(prefix);
+    body.append(std::move(insert));
+    body.append(suffix);
+    return body;
+}
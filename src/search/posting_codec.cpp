@@ -0,0 +1,338 @@
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define POSTING_CODEC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC и Clang генерируют SSSE3-инструкции только в функциях с явным атрибутом; MSVC разрешает их всегда
+#if defined(POSTING_CODEC_X86) && (defined(__GNUC__) || defined(__clang__))
+#define POSTING_CODEC_SSSE3 __attribute__((target("ssse3")))
+#else
+#define POSTING_CODEC_SSSE3
+#endif
+
+namespace PostingCodec {
+
+    namespace {
+
+        // Длина числа в байтах при упаковке StreamVByte
+        uint32_t byteLength(uint32_t value) {
+            if (value < (1u << 8)) return 1;
+            if (value < (1u << 16)) return 2;
+            if (value < (1u << 24)) return 3;
+            return 4;
+        }
+
+        // Упаковка n чисел в StreamVByte: сначала управляющие байты, затем сами данные
+        void encodeStream(const uint32_t* values, size_t n, std::vector<uint8_t>& out) {
+            size_t ctrlStart = out.size();
+            out.resize(out.size() + (n + 3) / 4, 0);
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t len = byteLength(values[i]);
+                out[ctrlStart + i / 4] |= static_cast<uint8_t>((len - 1) << (2 * (i % 4)));
+                for (uint32_t b = 0; b < len; ++b) {
+                    out.push_back(static_cast<uint8_t>(values[i] >> (8 * b)));
+                }
+            }
+        }
+
+        // Таблицы для распаковки: суммарная длина четвёрки чисел и маска перестановки байт для pshufb
+        struct DecodeTables {
+            std::array<uint8_t, 256> lengths{};
+            std::array<std::array<uint8_t, 16>, 256> shuffles{};
+
+            constexpr DecodeTables() {
+                for (int ctrl = 0; ctrl < 256; ++ctrl) {
+                    uint8_t offset = 0;
+                    for (int lane = 0; lane < 4; ++lane) {
+                        int len = ((ctrl >> (2 * lane)) & 3) + 1;
+                        for (int b = 0; b < 4; ++b) {
+                            shuffles[ctrl][lane * 4 + b] = b < len ? static_cast<uint8_t>(offset + b) : 0xFF;
+                        }
+                        offset = static_cast<uint8_t>(offset + len);
+                    }
+                    lengths[ctrl] = offset;
+                }
+            }
+        };
+
+        constexpr DecodeTables tables;
+
+        // Скалярная распаковка n чисел, возвращает указатель за концом данных
+        const uint8_t* decodeScalar(const uint8_t* ctrl, const uint8_t* in, size_t n, uint32_t* out) {
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+                uint32_t value = 0;
+                for (uint32_t b = 0; b < len; ++b) {
+                    value |= static_cast<uint32_t>(in[b]) << (8 * b);
+                }
+                out[i] = value;
+                in += len;
+            }
+            return in;
+        }
+
+#if defined(POSTING_CODEC_X86)
+        // SIMD-распаковка: одна инструкция pshufb раскладывает четвёрку чисел по 32-битным полосам
+        // Читает до 16 байт за концом данных четвёрки, поэтому за списками требуется kPadding байт
+        POSTING_CODEC_SSSE3
+        const uint8_t* decodeSsse3(const uint8_t* ctrl, const uint8_t* in, size_t n, uint32_t* out) {
+            size_t quads = n / 4;
+            for (size_t q = 0; q < quads; ++q) {
+                uint8_t c = ctrl[q];
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffles[c].data()));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * q), _mm_shuffle_epi8(bytes, mask));
+                in += tables.lengths[c];
+            }
+            // Хвост из 1-3 чисел распаковываем скалярно
+            return decodeScalar(ctrl + quads, in, n % 4, out + 4 * quads);
+        }
+
+        // Префиксная сумма разностей в номера документов по четыре числа за шаг (SSE2)
+        void prefixSumSse2(uint32_t* values, size_t n, uint32_t base) {
+            __m128i carry = _mm_set1_epi32(static_cast<int>(base));
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi32(v, carry);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), v);
+                carry = _mm_shuffle_epi32(v, 0xFF);
+            }
+            uint32_t last = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+            for (; i < n; ++i) {
+                last += values[i];
+                values[i] = last;
+            }
+        }
+#else
+        // Скалярная префиксная сумма
+        void prefixSumScalar(uint32_t* values, size_t n, uint32_t base) {
+            for (size_t i = 0; i < n; ++i) {
+                base += values[i];
+                values[i] = base;
+            }
+        }
+#endif
+
+        // Определяем поддержку SSSE3 один раз при запуске
+        bool detectSsse3() {
+#if defined(POSTING_CODEC_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#elif defined(POSTING_CODEC_X86) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_cpu_supports("ssse3");
+#else
+            return false;
+#endif
+        }
+
+        const bool hasSsse3 = detectSsse3();
+
+        // Распаковка с выбором реализации по возможностям процессора
+        const uint8_t* decode(const uint8_t* ctrl, const uint8_t* in, size_t n, uint32_t* out) {
+#if defined(POSTING_CODEC_X86)
+            if (hasSsse3) return decodeSsse3(ctrl, in, n, out);
+#endif
+            return decodeScalar(ctrl, in, n, out);
+        }
+
+        void prefixSum(uint32_t* values, size_t n, uint32_t base) {
+#if defined(POSTING_CODEC_X86)
+            prefixSumSse2(values, n, base);
+#else
+            prefixSumScalar(values, n, base);
+#endif
+        }
+
+        void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+            std::memcpy(out.data() + at, &value, sizeof(value));
+        }
+
+        uint32_t getU32(const uint8_t* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+    } // namespace
+
+    bool simdAvailable() {
+        return hasSsse3;
+    }
+
+    // Кодирование списка словопозиций
+    void encode(const std::vector<std::pair<uint32_t, uint32_t>>& postings, const std::vector<uint32_t>& lengths,
+        std::vector<uint8_t>& out) {
+        uint32_t blockCount = static_cast<uint32_t>((postings.size() + kBlockSize - 1) / kBlockSize);
+
+        size_t listStart = out.size();
+        size_t headersStart = listStart + 2 * sizeof(uint32_t);
+        size_t dataStart = headersStart + blockCount * sizeof(BlockHeader);
+        out.resize(dataStart);
+        putU32(out, listStart, static_cast<uint32_t>(postings.size()));
+        putU32(out, listStart + sizeof(uint32_t), blockCount);
+
+        uint32_t gaps[kBlockSize];
+        uint32_t freqs[kBlockSize];
+        uint32_t prevDoc = 0;
+        for (uint32_t b = 0; b < blockCount; ++b) {
+            size_t first = b * kBlockSize;
+            size_t n = std::min(kBlockSize, postings.size() - first);
+
+            uint32_t maxFreq = 0;
+            uint32_t minLength = std::numeric_limits<uint32_t>::max();
+            for (size_t i = 0; i < n; ++i) {
+                const auto& [doc, freq] = postings[first + i];
+                gaps[i] = doc - prevDoc;
+                freqs[i] = freq;
+                maxFreq = std::max(maxFreq, freq);
+                minLength = std::min(minLength, doc < lengths.size() ? lengths[doc] : 0);
+                prevDoc = doc;
+            }
+
+            size_t header = headersStart + b * sizeof(BlockHeader);
+            putU32(out, header, prevDoc);
+            putU32(out, header + 4, static_cast<uint32_t>(out.size() - dataStart));
+            putU32(out, header + 8, maxFreq);
+            putU32(out, header + 12, minLength);
+
+            encodeStream(gaps, n, out);
+            encodeStream(freqs, n, out);
+        }
+    }
+
+    // Проверка списка: курсор читает данные блока по смещению из заголовка и длинам из управляющих байт
+    bool validate(const uint8_t* list, size_t available, uint32_t docCount) {
+        if (available < 2 * sizeof(uint32_t)) return false;
+        uint64_t docFreq = getU32(list);
+        uint64_t blockCount = getU32(list + sizeof(uint32_t));
+        if (blockCount != (docFreq + kBlockSize - 1) / kBlockSize) return false;
+
+        uint64_t dataStart = 2 * sizeof(uint32_t) + blockCount * sizeof(BlockHeader);
+        if (dataStart > available) return false;
+        const uint8_t* headers = list + 2 * sizeof(uint32_t);
+        uint64_t dataBytes = available - dataStart;
+
+        uint64_t end = 0; // Конец данных предыдущего блока
+        for (uint64_t b = 0; b < blockCount; ++b) {
+            const uint8_t* p = headers + b * sizeof(BlockHeader);
+            uint32_t lastDoc = getU32(p);
+            uint64_t offset = getU32(p + 4);
+            if (lastDoc >= docCount || (b > 0 && lastDoc <= getU32(p - sizeof(BlockHeader)))) return false;
+            if (offset < end || offset > dataBytes) return false;
+
+            // Две упаковки StreamVByte (разности и частоты): управляющие байты, затем 1-4 байта на число
+            size_t n = std::min<uint64_t>(kBlockSize, docFreq - b * kBlockSize);
+            size_t ctrlBytes = (n + 3) / 4;
+            for (int stream = 0; stream < 2; ++stream) {
+                if (ctrlBytes > dataBytes - offset) return false;
+                const uint8_t* ctrl = list + dataStart + offset;
+                uint64_t length = 0;
+                for (size_t i = 0; i < n; ++i) length += ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+                offset += ctrlBytes;
+                if (length > dataBytes - offset) return false;
+                offset += length;
+            }
+            end = offset;
+        }
+        return true;
+    }
+
+    Cursor::Cursor(const uint8_t* list) {
+        totalDocs = getU32(list);
+        blockCount = getU32(list + sizeof(uint32_t));
+        headers = list + 2 * sizeof(uint32_t);
+        data = headers + blockCount * sizeof(BlockHeader);
+        if (blockCount > 0) loadBlock(0);
+    }
+
+    BlockHeader Cursor::header(uint32_t b) const {
+        const uint8_t* p = headers + b * sizeof(BlockHeader);
+        return { getU32(p), getU32(p + 4), getU32(p + 8), getU32(p + 12) };
+    }
+
+    void Cursor::loadBlock(uint32_t b) {
+        block = b;
+        pos = 0;
+        count = static_cast<uint32_t>(std::min<size_t>(kBlockSize, totalDocs - static_cast<size_t>(b) * kBlockSize));
+        isValid = true;
+
+        uint32_t base = b == 0 ? 0 : header(b - 1).lastDoc;
+        const uint8_t* ctrl = data + header(b).offset;
+        size_t ctrlBytes = (count + 3) / 4;
+
+        const uint8_t* freqCtrl = decode(ctrl, ctrl + ctrlBytes, count, docs);
+        decode(freqCtrl, freqCtrl + ctrlBytes, count, freqs);
+        prefixSum(docs, count, base);
+    }
+
+    void Cursor::next() {
+        if (!isValid) return;
+        if (++pos < count) return;
+        if (block + 1 < blockCount) {
+            loadBlock(block + 1);
+        }
+        else {
+            isValid = false;
+        }
+    }
+
+    void Cursor::nextGEQ(uint32_t target) {
+        if (!isValid || docs[pos] >= target) return;
+
+        // Цель за пределами текущего блока: ищем по заголовкам первый блок, который может её содержать
+        if (docs[count - 1] < target) {
+            uint32_t found = findBlock(block + 1, target);
+            if (found == blockCount) {
+                isValid = false;
+                return;
+            }
+            loadBlock(found);
+        }
+
+        // Внутри распакованного блока — двоичный поиск
+        pos = static_cast<uint32_t>(std::lower_bound(docs + pos, docs + count, target) - docs);
+    }
+
+    uint32_t Cursor::findBlock(uint32_t from, uint32_t target) const {
+        // Цель обычно недалеко: сначала удваиваем шаг, затем двоичный поиск в найденном промежутке
+        uint32_t lo = from, hi = from, step = 1;
+        while (hi < blockCount && header(hi).lastDoc < target) {
+            lo = hi + 1;
+            hi = blockCount - hi > step ? hi + step : blockCount;
+            step *= 2;
+        }
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (header(mid).lastDoc < target) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    bool Cursor::shallowSeek(uint32_t target, BlockHeader& out) {
+        uint32_t from = std::max(block, shallowBlock);
+        if (from < blockCount && header(from).lastDoc >= target) {
+            out = header(from);
+            return true;
+        }
+        shallowBlock = findBlock(from, target);
+        if (shallowBlock == blockCount) return false;
+        out = header(shallowBlock);
+        return true;
+    }
+
+} // namespace PostingCodec
@@ -0,0 +1,115 @@
+#include "query_cache.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+    // Приблизительные накладные расходы на запись: узел списка, элемент хэш-таблицы, управляющий блок строки
+    constexpr size_t kEntryOverhead = 160;
+
+} // namespace
+
+QueryCache::QueryCache(size_t memoryBudget, std::chrono::milliseconds ttl, size_t shardCount)
+    : shardBudget(memoryBudget / std::max<size_t>(1, shardCount)), ttl(ttl) {
+    shardCount = std::max<size_t>(1, shardCount);
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) shards.push_back(std::make_unique<Shard>());
+}
+
+std::string QueryCache::makeKey(std::vector<std::string> words) {
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::string key;
+    for (const auto& word : words) {
+        key += word;
+        key += '\0'; // Разделитель, которого нет в словах
+    }
+    return key;
+}
+
+QueryCache::Shard& QueryCache::shardFor(const std::string& key) {
+    return *shards[std::hash<std::string>{}(key) % shards.size()];
+}
+
+void QueryCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+    shard.bytes -= it->bytes;
+    shard.entries.erase(std::string_view(it->key));
+    shard.lru.erase(it);
+}
+
+std::shared_ptr<const std::string> QueryCache::get(const std::string& key) {
+    if (!enabled()) return nullptr;
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.entries.find(std::string_view(key));
+    if (found == shard.entries.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto it = found->second;
+    if (it->epoch != epoch() || std::chrono::steady_clock::now() >= it->expires) {
+        if (it->epoch == epoch()) expired.fetch_add(1, std::memory_order_relaxed);
+        erase(shard, it);
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it); // Запись становится самой свежей
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return it->value;
+}
+
+void QueryCache::put(const std::string& key, std::shared_ptr<const std::string> value, uint64_t valueEpoch) {
+    if (!enabled() || !value) return;
+
+    size_t bytes = key.size() + value->size() + kEntryOverhead;
+    if (bytes > shardBudget) return; // Слишком большая запись вытеснила бы весь шард
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (valueEpoch != epoch()) return; // Результат посчитан по корпусу, который уже сменился
+
+    auto found = shard.entries.find(std::string_view(key));
+    if (found != shard.entries.end()) erase(shard, found->second);
+
+    // Вытесняем давно не использованные записи, пока новая не поместится в бюджет шарда
+    while (!shard.lru.empty() && shard.bytes + bytes > shardBudget) {
+        erase(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shard.lru.push_front({ key, std::move(value), valueEpoch, std::chrono::steady_clock::now() + ttl, bytes });
+    shard.entries.emplace(std::string_view(shard.lru.front().key), shard.lru.begin());
+    shard.bytes += bytes;
+}
+
+void QueryCache::invalidate() {
+    // Сначала новая эпоха: put с результатом старого корпуса после этого будет отброшен
+    currentEpoch.fetch_add(1, std::memory_order_acq_rel);
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+QueryCache::Stats QueryCache::stats() const {
+    Stats result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.expired = expired.load(std::memory_order_relaxed);
+    result.evictions = evictions.load(std::memory_order_relaxed);
+    result.invalidations = currentEpoch.load(std::memory_order_relaxed);
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result.entries += shard->entries.size();
+        result.bytes += shard->bytes;
+    }
+    return result;
+}
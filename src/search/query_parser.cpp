@@ -0,0 +1,103 @@
+#include "query_parser.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+    // Таблица значений шестнадцатеричных цифр (-1 — не цифра)
+    constexpr std::array<int8_t, 256> makeHexTable() {
+        std::array<int8_t, 256> table{};
+        for (auto& value : table) value = -1;
+        for (int i = 0; i < 10; ++i) table['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 6; ++i) {
+            table['a' + i] = static_cast<int8_t>(10 + i);
+            table['A' + i] = static_cast<int8_t>(10 + i);
+        }
+        return table;
+    }
+    constexpr std::array<int8_t, 256> kHex = makeHexTable();
+
+    // Пробельные символы, как у std::isspace в локали "C"
+    constexpr bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+    }
+
+} // namespace
+
+// Метод декодирования одной строки
+bool QueryParser::decode(std::string_view encoded, std::string& out) {
+    size_t plain = 0; // Начало ещё не скопированного участка без "%" и "+"
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        char ch = encoded[i];
+        if (ch != '%' && ch != '+') continue;
+
+        out.append(encoded.data() + plain, i - plain);
+        if (ch == '+') {
+            out += ' ';
+            plain = i + 1;
+            continue;
+        }
+        if (i + 2 >= encoded.size()) return false;
+        int high = kHex[static_cast<unsigned char>(encoded[i + 1])];
+        int low = kHex[static_cast<unsigned char>(encoded[i + 2])];
+        if (high < 0 || low < 0) return false;
+        out += static_cast<char>(high * 16 + low);
+        i += 2;
+        plain = i + 1;
+    }
+    out.append(encoded.data() + plain, encoded.size() - plain);
+    return true;
+}
+
+// Метод разбора строки параметров
+bool QueryParser::parse(std::string_view encoded) {
+    buffer.clear();
+    params.clear();
+    buffer.reserve(encoded.size()); // Декодированный текст не длиннее исходного: string_view не устаревают
+
+    while (!encoded.empty()) {
+        size_t amp = encoded.find('&');
+        std::string_view pair = encoded.substr(0, amp);
+        encoded = amp == std::string_view::npos ? std::string_view() : encoded.substr(amp + 1);
+        if (pair.empty()) continue; // "a=1&&b=2"
+
+        size_t eq = pair.find('=');
+        Param param;
+        param.keyBegin = buffer.size();
+        if (!decode(pair.substr(0, eq), buffer)) {
+            params.clear();
+            return false;
+        }
+        param.keyEnd = param.valueBegin = buffer.size();
+        if (eq != std::string_view::npos && !decode(pair.substr(eq + 1), buffer)) {
+            params.clear();
+            return false;
+        }
+        param.valueEnd = buffer.size();
+        params.push_back(param);
+    }
+    return true;
+}
+
+// Значение параметра по имени
+std::optional<std::string_view> QueryParser::get(std::string_view name) const {
+    std::string_view text(buffer);
+    for (const auto& param : params) {
+        if (text.substr(param.keyBegin, param.keyEnd - param.keyBegin) == name) {
+            return text.substr(param.valueBegin, param.valueEnd - param.valueBegin);
+        }
+    }
+    return std::nullopt;
+}
+
+// Метод разбиения на слова
+void QueryParser::tokenize(std::string_view text, std::vector<std::string_view>& tokens) {
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && isSpace(text[i])) ++i;
+        size_t begin = i;
+        while (i < text.size() && !isSpace(text[i])) ++i;
+        if (i > begin) tokens.push_back(text.substr(begin, i - begin));
+    }
+}
@@ -0,0 +1,226 @@
+#include "response_encoder.hpp"
+
+#include <zlib.h>
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace http = boost::beast::http;
+
+namespace {
+
+    // Контекст zlib потока: создаётся один раз и переиспользуется через deflateReset
+    class GzipContext {
+    public:
+        ~GzipContext() {
+            if (initialized) deflateEnd(&stream);
+        }
+
+        z_stream& acquire(int level) {
+            if (initialized && level != currentLevel) {
+                deflateEnd(&stream);
+                initialized = false;
+            }
+            if (!initialized) {
+                stream = {};
+                // windowBits 15 + 16: заголовок и контрольная сумма gzip
+                if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                    throw std::runtime_error("Ошибка инициализации zlib");
+                }
+                initialized = true;
+                currentLevel = level;
+            }
+            else {
+                deflateReset(&stream);
+            }
+            return stream;
+        }
+
+    private:
+        z_stream stream{};
+        bool initialized = false;
+        int currentLevel = 0;
+    };
+
+    std::string gzipCompress(const std::vector<std::shared_ptr<const std::string>>& segments, int level) {
+        thread_local GzipContext context;
+        z_stream& stream = context.acquire(level);
+
+        uLong total = 0;
+        for (const auto& segment : segments) total += static_cast<uLong>(segment->size());
+
+        // Буфер на оценку сверху: весь вход сжимается за один проход без перевыделений
+        std::string out(deflateBound(&stream, total), '\0');
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+
+        for (const auto& segment : segments) {
+            if (segment->empty()) continue;
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(segment->data()));
+            stream.avail_in = static_cast<uInt>(segment->size());
+            if (deflate(&stream, Z_NO_FLUSH) != Z_OK || stream.avail_in != 0) {
+                throw std::runtime_error("Ошибка сжатия gzip");
+            }
+        }
+        if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+            throw std::runtime_error("Ошибка сжатия gzip");
+        }
+        out.resize(stream.total_out);
+        return out;
+    }
+
+#ifdef HAVE_BROTLI
+    // Состояние brotli нельзя сбросить после завершения потока, поэтому оно создаётся на каждый ответ
+    std::string brotliCompress(const std::vector<std::shared_ptr<const std::string>>& segments, int quality) {
+        std::unique_ptr<BrotliEncoderState, void(*)(BrotliEncoderState*)> state(
+            BrotliEncoderCreateInstance(nullptr, nullptr, nullptr), &BrotliEncoderDestroyInstance);
+        if (!state) throw std::runtime_error("Ошибка инициализации brotli");
+        BrotliEncoderSetParameter(state.get(), BROTLI_PARAM_QUALITY, static_cast<uint32_t>(quality));
+
+        size_t total = 0;
+        for (const auto& segment : segments) total += segment->size();
+
+        std::string out(std::max<size_t>(BrotliEncoderMaxCompressedSize(total), 64), '\0');
+        size_t written = 0;
+        auto run = [&](BrotliEncoderOperation operation, const uint8_t* data, size_t size) {
+            size_t availableIn = size;
+            while (true) {
+                if (written == out.size()) out.resize(out.size() * 2);
+                size_t availableOut = out.size() - written;
+                uint8_t* next = reinterpret_cast<uint8_t*>(out.data()) + written;
+                if (!BrotliEncoderCompressStream(state.get(), operation, &availableIn, &data, &availableOut, &next, nullptr)) {
+                    throw std::runtime_error("Ошибка сжатия brotli");
+                }
+                written = out.size() - availableOut;
+                bool done = operation == BROTLI_OPERATION_FINISH
+                    ? BrotliEncoderIsFinished(state.get())
+                    : availableIn == 0 && !BrotliEncoderHasMoreOutput(state.get());
+                if (done) break;
+            }
+        };
+        for (const auto& segment : segments) {
+            run(BROTLI_OPERATION_PROCESS, reinterpret_cast<const uint8_t*>(segment->data()), segment->size());
+        }
+        run(BROTLI_OPERATION_FINISH, nullptr, 0);
+        out.resize(written);
+        return out;
+    }
+#endif
+
+    // Вес кодировки из элемента Accept-Encoding вида "gzip;q=0.8"
+    double parseQuality(std::string_view params) {
+        size_t pos = params.find("q=");
+        if (pos == std::string_view::npos) return 1.0;
+        return std::strtod(std::string(params.substr(pos + 2)).c_str(), nullptr);
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+} // namespace
+
+// Конструктор класса ResponseEncoder
+ResponseEncoder::ResponseEncoder(bool enabled, size_t minSize, int gzipLevel, int brotliQuality)
+    : enabled_(enabled), minSize(minSize),
+    gzipLevel(std::clamp(gzipLevel, 1, 9)), brotliQuality(std::clamp(brotliQuality, 0, 11)) {
+}
+
+const char* ResponseEncoder::name(ContentEncoding encoding) {
+    switch (encoding) {
+    case ContentEncoding::Gzip: return "gzip";
+    case ContentEncoding::Brotli: return "br";
+    default: return "identity";
+    }
+}
+
+int ResponseEncoder::maxLevel(ContentEncoding encoding) {
+    return encoding == ContentEncoding::Brotli ? 11 : 9;
+}
+
+// Метод для выбора кодировки
+ContentEncoding ResponseEncoder::negotiate(std::string_view acceptEncoding) const {
+    if (!enabled_) return ContentEncoding::Identity;
+
+    double gzip = -1, brotli = -1, wildcard = -1;
+    while (!acceptEncoding.empty()) {
+        size_t comma = acceptEncoding.find(',');
+        std::string_view item = acceptEncoding.substr(0, comma);
+        acceptEncoding = comma == std::string_view::npos ? std::string_view() : acceptEncoding.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        double quality = semicolon == std::string_view::npos ? 1.0 : parseQuality(item.substr(semicolon + 1));
+        if (coding == "gzip" || coding == "x-gzip") gzip = quality;
+        else if (coding == "br") brotli = quality;
+        else if (coding == "*") wildcard = quality;
+    }
+    // Кодировки, не названные явно, получают вес "*"; q=0 означает запрет
+    if (gzip < 0) gzip = wildcard;
+    if (brotli < 0) brotli = wildcard;
+
+#ifdef HAVE_BROTLI
+    if (brotli > 0 && brotli >= gzip) return ContentEncoding::Brotli;
+#endif
+    if (gzip > 0) return ContentEncoding::Gzip;
+    return ContentEncoding::Identity;
+}
+
+// Метод для сжатия фрагментов тела
+std::string ResponseEncoder::compress(ContentEncoding encoding, const std::vector<std::shared_ptr<const std::string>>& segments,
+    int level) {
+    switch (encoding) {
+    case ContentEncoding::Gzip:
+        return gzipCompress(segments, level);
+#ifdef HAVE_BROTLI
+    case ContentEncoding::Brotli:
+        return brotliCompress(segments, level);
+#endif
+    default:
+        throw std::invalid_argument("Кодировка не поддерживается");
+    }
+}
+
+// Метод для сжатия динамического ответа
+void ResponseEncoder::encode(const HttpSession::Request& req, HttpSession::Response& res) {
+    if (!enabled_ || res.count(http::field::content_encoding) > 0) return;
+    res.set(http::field::vary, "Accept-Encoding"); // Ответ на тот же URL зависит от заголовка клиента
+
+    auto header = req[http::field::accept_encoding];
+    ContentEncoding encoding = negotiate(std::string_view(header.data(), header.size()));
+    if (encoding == ContentEncoding::Identity) return;
+    if (res.body().size() < minSize) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::string packed = compress(encoding, res.body().segments(),
+        encoding == ContentEncoding::Brotli ? brotliQuality : gzipLevel);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+
+    compressed.fetch_add(1, std::memory_order_relaxed);
+    bytesIn.fetch_add(res.body().size(), std::memory_order_relaxed);
+    bytesOut.fetch_add(packed.size(), std::memory_order_relaxed);
+    microseconds.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+
+    res.set(http::field::content_encoding, name(encoding));
+    res.body() = std::move(packed);
+}
+
+ResponseEncoder::Stats ResponseEncoder::stats() const {
+    Stats result;
+    result.compressed = compressed.load(std::memory_order_relaxed);
+    result.skipped = skipped.load(std::memory_order_relaxed);
+    result.bytesIn = bytesIn.load(std::memory_order_relaxed);
+    result.bytesOut = bytesOut.load(std::memory_order_relaxed);
+    result.microseconds = microseconds.load(std::memory_order_relaxed);
+    return result;
+}
@@ -1,35 +1,193 @@
 #include "search_server.hpp"
+#include "json_writer.hpp"
+#include "query_parser.hpp"
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
-#include <boost/asio/thread_pool.hpp>
-#include <boost/asio/post.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/use_awaitable.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/locale.hpp>
 
-#include <fstream>
-#include <sstream>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
 #include <thread>
 #include <algorithm>
 
 using tcp = boost::asio::ip::tcp;
 namespace http = boost::beast::http;
 
+namespace {
+
+    // Разделение запроса на слова и их нормализация (как при индексации)
+    std::vector<std::string> normalizeQuery(std::string_view text) {
+        std::vector<std::string_view> words;
+        QueryParser::tokenize(text, words);
+        std::vector<std::string> normalizedWords;
+        normalizedWords.reserve(words.size());
+        for (auto word : words) {
+            normalizedWords.push_back(
+                boost::locale::normalize(
+                    boost::locale::to_lower(std::string(word)), boost::locale::norm_default
+                )
+            );
+        }
+        return normalizedWords;
+    }
+
+    // Неотрицательное целое из параметра; false — параметр задан, но это не число
+    bool parseCount(std::optional<std::string_view> text, size_t& value) {
+        if (!text || text->empty()) return true;
+        auto [end, ec] = std::from_chars(text->data(), text->data() + text->size(), value);
+        return ec == std::errc() && end == text->data() + text->size();
+    }
+
+} // namespace
+
 // Конструктор SearchServer: инициализация с конфигурацией, логгером, базой данных и флагом работы сервера
 SearchServer::SearchServer(const Config& config, Logger& logger, Database& db, std::atomic<bool>& running)
-    : config(config), logger(logger), db(db), running(running) {
+    : config(config), logger(logger), db(db), running(running), index(config, logger),
+    cache(static_cast<size_t>(std::max(0, config.getCacheMemoryMb())) * 1024 * 1024,
+        std::chrono::seconds(std::max(1, config.getCacheTtlSeconds())),
+        static_cast<size_t>(std::max(1, config.getCacheShards()))),
+    encoder(config.isCompressionEnabled(), static_cast<size_t>(std::max(0, config.getCompressionMinSize())),
+        config.getGzipLevel(), config.getBrotliQuality()),
+    maxResults(static_cast<size_t>(std::max(1, config.getMaxResults()))),
+    maxOffset(static_cast<size_t>(std::max(0, config.getMaxOffset()))) {
 }
 
 // Метод запуска сервера
 void SearchServer::run() {
+    // Страницы читаем один раз, а не при каждом запросе
+    searchForm = StaticAsset::load("html/search_form.html", "text/html");
+    styleSheet = StaticAsset::load("html/style.css", "text/css");
+    resultsPage = PageTemplate::load("html/search_results.html", "<!--RESULTS-->");
+    if (!searchForm.body) logger.error("Не удалось прочитать html/search_form.html");
+    if (!styleSheet.body) logger.error("Не удалось прочитать html/style.css");
+    if (!resultsPage.loaded()) logger.error("Не удалось прочитать шаблон html/search_results.html");
+
+    if (config.useInMemoryIndex()) {
+        index.load(db); // Загружаем корпус в память до приёма первых запросов
+        index.startMerging(); // Фоновое слияние мелких сегментов (если задан каталог сегментов)
+    }
+    startVersionWatch();
     startServer();
+    stopVersionWatch();
+    index.stopMerging();
+    index.logSearchStats();
+    logCacheStats();
+    logCompressionStats();
+}
+
+// Метод запуска слежения за версией корпуса
+void SearchServer::startVersionWatch() {
+    if (!cache.enabled() && !config.useInMemoryIndex()) return;
+
+    versionStopping = false;
+    versionThread = std::thread([this]() {
+        std::chrono::milliseconds interval(std::max(100, config.getCorpusVersionPollMs()));
+        long long known = -1;
+        std::unique_lock<std::mutex> lock(versionMutex);
+        while (!versionStopping) {
+            lock.unlock();
+            try {
+                long long version = db.corpusVersion();
+                if (known >= 0 && version != known) {
+                    // Краулер зафиксировал новые страницы: индекс в памяти перестраиваем в этом потоке,
+                    // а не в потоках io_context, и только потом сбрасываем кэш, иначе он заполнится старыми ответами
+                    if (config.useInMemoryIndex() && index.load(db) != InvertedIndex::LoadResult::Loaded) {
+                        version = known; // Индекс занят слиянием или перезагрузкой: повторим при следующей проверке
+                    }
+                    else {
+                        cache.invalidate();
+                        logger.info("Версия корпуса изменилась (" + std::to_string(version) + "), кэш запросов сброшен");
+                    }
+                }
+                known = version;
+            }
+            catch (const std::exception& e) {
+                logger.error(std::string("Ошибка проверки версии корпуса: ") + e.what());
+            }
+            lock.lock();
+            versionCv.wait_for(lock, interval, [this]() { return versionStopping; });
+        }
+        });
+}
+
+// Метод остановки слежения за версией корпуса
+void SearchServer::stopVersionWatch() {
+    {
+        std::lock_guard<std::mutex> lock(versionMutex);
+        versionStopping = true;
+    }
+    versionCv.notify_all();
+    if (versionThread.joinable()) versionThread.join();
+}
+
+// Метод для записи в лог счётчиков кэша
+void SearchServer::logCacheStats() const {
+    if (!cache.enabled()) return;
+    auto stats = cache.stats();
+    uint64_t lookups = stats.hits + stats.misses;
+    logger.info("Кэш запросов: попаданий " + std::to_string(stats.hits) +
+        ", промахов " + std::to_string(stats.misses) +
+        (lookups > 0 ? " (" + std::to_string(stats.hits * 100 / lookups) + "% попаданий)" : std::string()) +
+        ", устарело по TTL " + std::to_string(stats.expired) +
+        ", вытеснено " + std::to_string(stats.evictions) +
+        ", сбросов " + std::to_string(stats.invalidations) +
+        ", записей " + std::to_string(stats.entries) +
+        ", байт " + std::to_string(stats.bytes));
+}
+
+// Метод для записи в лог счётчиков сжатия
+void SearchServer::logCompressionStats() const {
+    if (!encoder.enabled()) return;
+    auto stats = encoder.stats();
+    logger.info("Сжатие ответов: сжато " + std::to_string(stats.compressed) +
+        ", меньше порога " + std::to_string(stats.skipped) +
+        ", байт до " + std::to_string(stats.bytesIn) +
+        ", после " + std::to_string(stats.bytesOut) +
+        ", сэкономлено " + std::to_string(stats.bytesIn - stats.bytesOut) +
+        ", время сжатия " + std::to_string(stats.microseconds / 1000) + " мс");
+}
+
+// Метод для формирования блока результатов
+std::string SearchServer::renderResults(const std::vector<std::pair<std::string, float>>& results) {
+    if (results.empty()) {
+        return "<p><em>Ничего не найдено.</em></p>";
+    }
+
+    std::string html;
+    html.reserve(16 + results.size() * 96);
+    html += "<ul>";
+    for (const auto& [url, score] : results) {
+        char scoreText[32];
+        auto [end, ec] = std::to_chars(scoreText, scoreText + sizeof(scoreText), score, std::chars_format::fixed, 2);
+        html += "<li><a href='";
+        html += url;
+        html += "'>";
+        html += url;
+        html += "</a> — рейтинг: "; // Оценка BM25 дробная: показываем два знака
+        html.append(scoreText, ec == std::errc() ? end : scoreText);
+        html += "</li>";
+    }
+    html += "</ul>";
+    return html;
 }
 
 // Метод для старта сервера, включает настройки и запуск потоков
 void SearchServer::startServer() {
     try {
-        boost::asio::io_context ioc{ 1 };
+        int threads = config.getServerThreads() > 0
+            ? config.getServerThreads()
+            : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        boost::asio::io_context ioc{ threads };
 
         // Ловим SIGINT и SIGTERM для корректного завершения
         boost::asio::signal_set signals(ioc, SIGINT, SIGTERM);
@@ -41,20 +199,27 @@ void SearchServer::startServer() {
 
         // Создаём TCP-акцептор для прослушивания порта сервера
         tcp::acceptor acceptor{ ioc, {tcp::v4(), static_cast<unsigned short>(config.getServerPort())} };
-        logger.info("HTTP-сервер запущен на порту " + std::to_string(config.getServerPort()));
+        logger.info("HTTP-сервер запущен на порту " + std::to_string(config.getServerPort()) +
+            ", потоков: " + std::to_string(threads));
 
-        // Пул потоков для обработки запросов
-        boost::asio::thread_pool pool(std::thread::hardware_concurrency());
+        // Поисковые запросы к базе данных ждут ответа на том же io_context, не блокируя его потоки
+        if (!config.useInMemoryIndex()) {
+            asyncDb = std::make_unique<AsyncDatabase>(ioc.get_executor(), config, logger);
+        }
+
+        requestHandler = [this](const HttpSession::Request& req, const tcp::endpoint& remote) {
+            return handleRequest(req, remote);
+            };
+        std::chrono::seconds timeout(std::max(1, config.getSessionTimeoutSeconds()));
 
         // Лямбда-функция для асинхронного приёма подключений
+        // Каждое соединение получает свой strand: его обработчики не выполняются параллельно друг с другом,
+        // а разные соединения обслуживаются всеми потоками io_context
         std::function<void()> do_accept;
         do_accept = [&]() {
-            auto socket = std::make_shared<tcp::socket>(ioc);
-            acceptor.async_accept(*socket, [&, socket](boost::system::error_code ec) {
+            acceptor.async_accept(boost::asio::make_strand(ioc), [&](boost::system::error_code ec, tcp::socket socket) {
                 if (!ec) {
-                    boost::asio::post(pool, [this, socket]() mutable {
-                        handleSession(std::move(*socket)); // Обрабатываем подключение
-                        });
+                    std::make_shared<HttpSession>(std::move(socket), requestHandler, timeout, logger)->start();
                 }
                 if (running) {
                     do_accept(); // Ожидаем следующее подключение
@@ -64,139 +229,216 @@ void SearchServer::startServer() {
 
         do_accept(); // Старт первого accept'а
 
-        // Запускаем цикл событий
+        // Запускаем цикл событий во всех потоках; ни один поток не ждёт медленного клиента
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(threads - 1));
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back([&ioc]() { ioc.run(); });
+        }
         ioc.run();
+        for (auto& worker : workers) worker.join();
+        asyncDb.reset(); // Соединения закрываются после остановки io_context
 
-        pool.join(); // Ждём завершения всех задач в пуле
         logger.info("Сервер остановлен.");
     }
     catch (const std::exception& ex) {
+        asyncDb.reset();
         logger.error(std::string("Ошибка запуска сервера: ") + ex.what());
     }
 }
 
-// Метод обработки HTTP-сессии
-void SearchServer::handleSession(boost::asio::ip::tcp::socket socket) {
-    try {
-        boost::beast::flat_buffer buffer; // Буфер для чтения данных
-        http::request<http::string_body> req; // HTTP-запрос
-        http::read(socket, buffer, req); // Чтение запроса
-
-        http::response<http::string_body> res; // HTTP-ответ
-        res.version(req.version()); // Установка версии HTTP
-        res.keep_alive(false); // Отключение поддержки keep-alive
-
-        // Обработка GET-запроса на главную страницу
-        if (req.method() == http::verb::get && req.target() == "/") {
-            std::ifstream file("html/search_form.html"); // Чтение HTML-шаблона формы
-            std::stringstream ss;
-            ss << file.rdbuf();
-            res.result(http::status::ok); // Устанавливаем статус OK
-            res.set(http::field::content_type, "text/html"); // Устанавливаем тип контента
-            res.body() = ss.str(); // Тело ответа
+// Метод обработки HTTP-запроса
+boost::asio::awaitable<HttpSession::Response> SearchServer::handleRequest(const HttpSession::Request& req,
+    const tcp::endpoint& remote) {
+    HttpSession::Response res; // HTTP-ответ
+    res.version(req.version()); // Установка версии HTTP
 
+    // Главная страница и стили отдаются из памяти; на условный запрос с актуальной копией — 304 без тела
+    if (req.method() == http::verb::get && req.target() == "/") {
+        co_return searchForm.respond(req, encoder);
+    }
+    else if (req.method() == http::verb::get && req.target() == "/style.css") {
+        co_return styleSheet.respond(req, encoder);
+    }
+    // Обработка POST-запроса на поиск
+    else if (req.method() == http::verb::post && req.target() == "/search") {
+        // Декодируем тело формы; некорректная %-последовательность — ошибка клиента, а не сервера
+        QueryParser form;
+        if (!form.parse(req.body())) {
+            res.result(http::status::bad_request);
+            res.set(http::field::content_type, "text/plain; charset=utf-8");
+            res.body() = "400 Bad Request: malformed form encoding";
+            co_return res;
         }
-        // Обработка POST-запроса на поиск
-        else if (req.method() == http::verb::post && req.target() == "/search") {
-            // Функция декодирования URL
-            auto urlDecode = [](const std::string& str) -> std::string {
-                std::string result;
-                std::istringstream iss(str);
-                char ch;
-                while (iss.get(ch)) {
-                    if (ch == '%') {
-                        std::string hex;
-                        if (iss.get(ch)) hex += ch;
-                        if (iss.get(ch)) hex += ch;
-                        result += static_cast<char>(std::stoi(hex, nullptr, 16)); // Декодируем символы
-                    }
-                    else if (ch == '+') {
-                        result += ' '; // Заменяем "+" на пробел
-                    }
-                    else {
-                        result += ch;
-                    }
-                }
-                return result;
-                };
-
-            std::string query = req.body(); // Получаем тело запроса
-            std::string cleaned;
-            std::istringstream in(query);
-            std::string key, val;
-            if (std::getline(in, key, '=') && std::getline(in, val)) {
-                cleaned = urlDecode(val); // Декодируем параметры
-            }
+        std::string_view cleaned = form.get("query").value_or(std::string_view());
 
-            logger.info("Тело запроса (decoded) = [" + cleaned + "]");
+        logger.info("Тело запроса (decoded) = [" + std::string(cleaned) + "]");
 
-            // Разделяем запрос на слова
-            std::istringstream wordStream(cleaned);
-            std::string w;
-            std::vector<std::string> words;
-            while (wordStream >> w) {
-                words.push_back(w);
-            }
+        // Разделяем запрос на слова и нормализуем их
+        std::vector<std::string> normalizedWords = normalizeQuery(cleaned);
 
-            // Нормализуем слова
-            std::vector<std::string> normalizedWords;
-            for (auto& word : words) {
-                normalizedWords.push_back(
-                    boost::locale::normalize(
-                        boost::locale::to_lower(word), boost::locale::norm_default
-                    )
-                );
-            }
+        // Логируем нормализованные слова
+        for (const auto& word : normalizedWords) {
+            logger.info("Поисковое слово после нормализации: [" + word + "]");
+        }
+
+        // Одинаковые запросы отдаём из кэша; эпоха берётся до поиска, чтобы не сохранить устаревший ответ
+        std::string cacheKey = QueryCache::makeKey(normalizedWords);
+        auto page = cache.get(cacheKey);
+        if (!page) {
+            uint64_t epoch = cache.epoch();
+
+            // Выполняем поиск по индексу в памяти или по базе данных
+            auto results = co_await runSearch(normalizedWords, 10, 0, {});
+            page = std::make_shared<const std::string>(renderResults(results.results));
+            cache.put(cacheKey, page, epoch);
+        }
 
-            // Логируем нормализованные слова
-            for (const auto& word : normalizedWords) {
-                logger.info("Поисковое слово после нормализации: [" + word + "]");
+        // Формируем ответ: части шаблона и блок результатов из кэша уходят без копирования
+        res.result(http::status::ok);
+        res.set(http::field::content_type, "text/html");
+        res.body() = resultsPage.render(page);
+        encoder.encode(req, res); // Сжатие по Accept-Encoding (маленькие страницы уходят как есть)
+    }
+    // Поиск для программ: JSON с постраничной выдачей
+    else if (req.method() == http::verb::get &&
+        (req.target() == "/api/search" || req.target().starts_with("/api/search?"))) {
+        co_return co_await handleApiSearch(req);
+    }
+    // Перезагрузка индекса в памяти после нового обхода (только с локального адреса)
+    else if (req.method() == http::verb::post && req.target() == "/admin/reload") {
+        res.set(http::field::content_type, "text/plain; charset=utf-8");
+        if (!remote.address().is_loopback()) {
+            res.result(http::status::forbidden);
+            res.body() = "403 Forbidden";
+        }
+        else if (!config.useInMemoryIndex()) {
+            res.result(http::status::conflict);
+            res.body() = "In-memory index is disabled";
+        }
+        else if (reloadQueued.exchange(true)) {
+            res.result(http::status::conflict);
+            res.body() = "Reload already in progress";
+        }
+        else {
+            // Загрузка читает базу данных и файлы сегментов: выполняем её в отдельном потоке и ждём, не блокируя io_context
+            auto result = co_await boost::asio::co_spawn(reloadPool,
+                [this]() -> boost::asio::awaitable<InvertedIndex::LoadResult> {
+                    struct QueuedReset {
+                        std::atomic<bool>& flag;
+                        ~QueuedReset() { flag = false; }
+                    } queuedReset{ reloadQueued };
+                    co_return index.load(db);
+                },
+                boost::asio::use_awaitable);
+            switch (result) {
+            case InvertedIndex::LoadResult::Loaded:
+                cache.invalidate(); // Ответы, посчитанные по старому снимку индекса, больше не отдаём
+                res.result(http::status::ok);
+                res.body() = "Index reloaded: " + std::to_string(index.documentCount()) + " documents";
+                break;
+            case InvertedIndex::LoadResult::ReloadInProgress:
+                res.result(http::status::conflict);
+                res.body() = "Reload already in progress";
+                break;
+            case InvertedIndex::LoadResult::MergeInProgress:
+                // Слияние сегментов закончится само: клиенту достаточно повторить запрос позже
+                res.result(http::status::service_unavailable);
+                res.set(http::field::retry_after, "5");
+                res.body() = "Segment merge in progress, retry later";
+                break;
             }
+        }
+    }
+    else {
+        // Если путь не найден, возвращаем 404
+        res.result(http::status::not_found);
+        res.set(http::field::content_type, "text/html");
+        res.body() = "404 Not Found";
+    }
 
-            // Выполняем поиск по базе данных
-            auto results = db.search(normalizedWords);
+    co_return res; // Keep-alive и длину тела выставляет сессия
+}
 
-            // Чтение HTML-шаблона для результатов поиска
-            std::ifstream templateFile("html/search_results.html");
-            std::stringstream ss;
-            ss << templateFile.rdbuf();
-            std::string templateHtml = ss.str();
+// Метод поиска по индексу в памяти или по базе данных
+boost::asio::awaitable<SearchPage> SearchServer::runSearch(const std::vector<std::string>& words, size_t limit,
+    size_t offset, const std::string& cursor) {
+    if (config.useInMemoryIndex()) {
+        co_return index.search(words, limit, offset, cursor);
+    }
+    co_return co_await asyncDb->search(words, limit, offset, cursor);
+}
 
-            // Формирование результатов поиска
-            std::ostringstream resultsHtml;
-            if (results.empty()) {
-                resultsHtml << "<p><em>Ничего не найдено.</em></p>";
-            }
-            else {
-                resultsHtml << "<ul>";
-                for (const auto& [url, score] : results) {
-                    resultsHtml << "<li><a href='" << url << "'>" << url << "</a> — рейтинг: " << score << "</li>";
-                }
-                resultsHtml << "</ul>";
-            }
+// Метод обработки запроса GET /api/search?q=...&limit=...&offset=...&cursor=...
+boost::asio::awaitable<HttpSession::Response> SearchServer::handleApiSearch(const HttpSession::Request& req) {
+    HttpSession::Response res;
+    res.version(req.version());
+    res.set(http::field::content_type, "application/json; charset=utf-8");
 
-            // Вставляем результаты в шаблон
-            size_t pos = templateHtml.find("<!--RESULTS-->");
-            if (pos != std::string::npos) {
-                templateHtml.replace(pos, std::string("<!--RESULTS-->").length(), resultsHtml.str());
-            }
+    std::string_view target(req.target().data(), req.target().size());
+    size_t question = target.find('?');
+    std::string_view queryString = question == std::string_view::npos ? std::string_view() : target.substr(question + 1);
 
-            // Формируем ответ
-            res.result(http::status::ok);
-            res.set(http::field::content_type, "text/html");
-            res.body() = templateHtml;
-        }
-        else {
-            // Если путь не найден, возвращаем 404
-            res.result(http::status::not_found);
-            res.set(http::field::content_type, "text/html");
-            res.body() = "404 Not Found";
-        }
+    // Ошибка в параметрах: 400 с описанием
+    auto badRequest = [&](std::string_view message) {
+        std::string body;
+        JsonWriter(body).beginObject().key("error").value(message).endObject();
+        res.result(http::status::bad_request);
+        res.body() = std::move(body);
+        return res;
+    };
 
-        res.prepare_payload(); // Подготавливаем тело ответа
-        http::write(socket, res); // Отправляем ответ
+    QueryParser params; // Живёт в кадре сопрограммы: string_view на него действительны и после co_await
+    if (!params.parse(queryString)) co_return badRequest("Malformed percent-encoding in query string");
+
+    auto text = params.get("q");
+    if (!text || text->empty()) co_return badRequest("Missing parameter q");
+
+    size_t limit = 10, offset = 0;
+    if (!parseCount(params.get("limit"), limit) || limit == 0 || limit > maxResults) {
+        co_return badRequest("Parameter limit must be between 1 and " + std::to_string(maxResults));
+    }
+    if (!parseCount(params.get("offset"), offset) || offset > maxOffset) {
+        co_return badRequest("Parameter offset must be between 0 and " + std::to_string(maxOffset) +
+            "; use cursor for deeper pages");
     }
-    catch (const std::exception& e) {
-        logger.error(std::string("Ошибка обработки запроса: ") + e.what()); // Логируем ошибку
+    std::string cursor(params.get("cursor").value_or(std::string_view()));
+
+    std::vector<std::string> words = normalizeQuery(*text);
+    auto started = std::chrono::steady_clock::now();
+    SearchPage page;
+    bool badCursor = false;
+    try {
+        page = co_await runSearch(words, limit, offset, cursor);
     }
+    catch (const std::invalid_argument&) {
+        badCursor = true; // Остальные ошибки обрабатывает сессия (ответ 500)
+    }
+    if (badCursor) co_return badRequest("Invalid cursor");
+    double tookMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    // Пишем JSON сразу в тело ответа: размер известен примерно, поэтому буфер выделяется один раз
+    std::string body;
+    body.reserve(256 + page.results.size() * 128);
+    JsonWriter json(body);
+    json.beginObject()
+        .key("query").value(*text)
+        .key("took_ms").value(std::round(tookMs * 1000.0) / 1000.0)
+        .key("total").value(page.total)
+        .key("total_exact").value(page.exactTotal)
+        .key("offset").value(static_cast<uint64_t>(offset))
+        .key("limit").value(static_cast<uint64_t>(limit))
+        .key("results").beginArray();
+    for (const auto& [url, score] : page.results) {
+        json.beginObject().key("url").value(url).key("score").value(static_cast<double>(score)).endObject();
+    }
+    json.endArray().key("next_cursor");
+    if (page.nextCursor.empty()) json.null();
+    else json.value(page.nextCursor);
+    json.endObject();
+
+    res.result(http::status::ok);
+    res.body() = std::move(body);
+    encoder.encode(req, res);
+    co_return res;
 }
@@ -0,0 +1,239 @@
+#include "top_k_evaluator.hpp"
+#include "bm25.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+    // Запас на погрешность сложения float в разном порядке: граница не должна оказаться меньше точной оценки
+    constexpr float kBoundSlack = 1.0f + 1e-5f;
+
+    // Порядок документов в результате: выше оценка, при равенстве — меньший номер
+    bool better(const TopKEvaluator::Hit& a, const TopKEvaluator::Hit& b) {
+        return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+    }
+
+} // namespace
+
+TopKEvaluator::TopKEvaluator(size_t k, Mode mode, Strategy strategy, float averageLength)
+    : k(k), mode(mode), strategy(strategy), averageLength(averageLength) {
+}
+
+float TopKEvaluator::termScore(size_t term, uint32_t freq, uint32_t doc) const {
+    return Bm25::weight(terms[term].idf, freq, segment->documentLength(doc), averageLength);
+}
+
+float TopKEvaluator::termBound(size_t term, uint32_t maxFreq, uint32_t minLength) const {
+    return Bm25::weight(terms[term].idf, maxFreq, minLength, averageLength);
+}
+
+bool TopKEvaluator::competitive(float bound) const {
+    // Документы перебираются по возрастанию номера, поэтому при равной оценке новый документ проигрывает
+    return heap.size() < k || bound * kBoundSlack > heap.front().score;
+}
+
+void TopKEvaluator::offer(float score, uint32_t doc, const std::vector<bool>& excluded) {
+    if (doc >= segment->documentCount()) return; // Повреждённый список: документа нет в таблице сегмента
+    if (!excluded.empty() && excluded[doc]) return;
+    if (score > after.score || (score == after.score && doc < after.firstTiedDoc)) return; // Уже показан
+
+    Hit hit{ score, doc };
+    if (heap.size() < k) {
+        heap.push_back(hit);
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+    else if (better(hit, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = hit;
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+std::vector<TopKEvaluator::Hit> TopKEvaluator::run(const std::vector<Term>& queryTerms, const IndexSegment& querySegment,
+    const std::vector<bool>& excluded, const After& queryAfter) {
+    heap.clear();
+    segment = &querySegment;
+    after = queryAfter;
+    if (k == 0 || queryTerms.empty()) return {};
+
+    // Короткие списки вперёд: в конъюнктивном режиме первый из них ведёт перебор
+    terms = queryTerms;
+    std::sort(terms.begin(), terms.end(), [](const Term& a, const Term& b) { return a.docFreq < b.docFreq; });
+
+    cursors.clear();
+    listBounds.clear();
+    for (size_t i = 0; i < terms.size(); ++i) {
+        cursors.emplace_back(terms[i].postings);
+        listBounds.push_back(termBound(i, terms[i].maxFreq, terms[i].minLength));
+    }
+
+    if (mode == Mode::Conjunctive) {
+        runConjunctive(excluded);
+    }
+    else if (strategy == Strategy::BlockMaxWand) {
+        runDisjunctive(excluded);
+    }
+    else {
+        runDisjunctiveExhaustive(excluded);
+    }
+
+    std::sort(heap.begin(), heap.end(), better);
+    return heap;
+}
+
+// Все слова запроса: пересечение списков с отсечением по границам блоков
+void TopKEvaluator::runConjunctive(const std::vector<bool>& excluded) {
+    const bool pruning = strategy == Strategy::BlockMaxWand;
+    const float listBound = std::accumulate(listBounds.begin(), listBounds.end(), 0.0f);
+
+    // Граница по блокам, в которые попадает кандидат, действует до конца самого короткого из этих блоков
+    float blockBound = 0.0f;
+    uint32_t blockEnd = 0;
+    bool blockKnown = false;
+
+    PostingCodec::Cursor& lead = cursors.front();
+    while (lead.valid()) {
+        uint32_t candidate = lead.doc();
+
+        if (pruning && heap.size() >= k) {
+            // Даже максимальные частоты всех слов не дают войти в k лучших: дальше искать нечего
+            if (!competitive(listBound)) return;
+
+            if (!blockKnown || candidate > blockEnd) {
+                blockBound = 0.0f;
+                blockEnd = std::numeric_limits<uint32_t>::max();
+                for (size_t i = 0; i < cursors.size(); ++i) {
+                    PostingCodec::BlockHeader header;
+                    if (!cursors[i].shallowSeek(candidate, header)) return; // Список кончился: совпадений больше нет
+                    blockBound += termBound(i, header.maxFreq, header.minLength);
+                    blockEnd = std::min(blockEnd, header.lastDoc);
+                }
+                blockKnown = true;
+            }
+            // Если границы по блокам мало, пропускаем блоки целиком
+            if (!competitive(blockBound)) {
+                if (blockEnd == std::numeric_limits<uint32_t>::max()) return;
+                lead.nextGEQ(blockEnd + 1);
+                continue;
+            }
+        }
+
+        float score = termScore(0, lead.freq(), candidate);
+        bool matched = true;
+        for (size_t i = 1; i < cursors.size(); ++i) {
+            cursors[i].nextGEQ(candidate); // Блоки, целиком лежащие до кандидата, пропускаются без распаковки
+            if (!cursors[i].valid()) return; // Один из списков кончился: общих документов больше нет
+            if (cursors[i].doc() != candidate) {
+                lead.nextGEQ(cursors[i].doc()); // Пропускаем документы, которых нет в другом списке
+                matched = false;
+                break;
+            }
+            score += termScore(i, cursors[i].freq(), candidate);
+        }
+        if (!matched) continue;
+
+        offer(score, candidate, excluded);
+        lead.next();
+    }
+}
+
+// Хотя бы одно слово запроса: BlockMax-WAND
+void TopKEvaluator::runDisjunctive(const std::vector<bool>& excluded) {
+    std::vector<size_t> order(cursors.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    while (true) {
+        // Убираем закончившиеся списки и упорядочиваем остальные по текущему документу
+        order.erase(std::remove_if(order.begin(), order.end(), [this](size_t i) { return !cursors[i].valid(); }), order.end());
+        if (order.empty()) return;
+        // Списков мало и после сдвига порядок почти не меняется: сортировка вставками
+        for (size_t j = 1; j < order.size(); ++j) {
+            for (size_t i = j; i > 0 && cursors[order[i]].doc() < cursors[order[i - 1]].doc(); --i) {
+                std::swap(order[i], order[i - 1]);
+            }
+        }
+
+        // Опорный список: первый, на котором сумма границ предыдущих списков позволяет войти в k лучших
+        float accumulated = 0.0f;
+        size_t pivot = order.size();
+        for (size_t j = 0; j < order.size(); ++j) {
+            accumulated += listBounds[order[j]];
+            if (competitive(accumulated)) {
+                pivot = j;
+                break;
+            }
+        }
+        if (pivot == order.size()) return; // Ни один оставшийся документ не может войти в k лучших
+
+        uint32_t pivotDoc = cursors[order[pivot]].doc();
+        while (pivot + 1 < order.size() && cursors[order[pivot + 1]].doc() == pivotDoc) pivot++;
+
+        if (heap.size() >= k) {
+            // Уточняем границу по блокам, содержащим опорный документ
+            float blockBound = 0.0f;
+            uint32_t nextDoc = pivot + 1 < order.size() ? cursors[order[pivot + 1]].doc() : std::numeric_limits<uint32_t>::max();
+            for (size_t j = 0; j <= pivot; ++j) {
+                PostingCodec::BlockHeader header;
+                if (!cursors[order[j]].shallowSeek(pivotDoc, header)) continue;
+                blockBound += termBound(order[j], header.maxFreq, header.minLength);
+                if (header.lastDoc != std::numeric_limits<uint32_t>::max()) {
+                    nextDoc = std::min(nextDoc, header.lastDoc + 1);
+                }
+            }
+            if (!competitive(blockBound)) {
+                // Все документы до nextDoc не конкурентны: в списках до опорного их границы малы,
+                // а остальные списки стоят не раньше nextDoc
+                if (nextDoc <= pivotDoc) {
+                    if (pivotDoc == std::numeric_limits<uint32_t>::max()) return;
+                    nextDoc = pivotDoc + 1;
+                }
+                for (size_t j = 0; j <= pivot; ++j) cursors[order[j]].nextGEQ(nextDoc);
+                continue;
+            }
+        }
+
+        if (cursors[order.front()].doc() == pivotDoc) {
+            // Все списки до опорного стоят на нём: оцениваем документ полностью. Слагаемые складываем
+            // в порядке слов, а не списков: иначе оценка документа зависела бы от хода перебора,
+            // и курсор постраничной выдачи мог бы не совпасть с оценкой того же документа в следующем запросе
+            float score = 0.0f;
+            for (size_t i = 0; i < cursors.size(); ++i) {
+                if (cursors[i].valid() && cursors[i].doc() == pivotDoc) score += termScore(i, cursors[i].freq(), pivotDoc);
+            }
+            offer(score, pivotDoc, excluded);
+            for (size_t j = 0; j <= pivot; ++j) cursors[order[j]].next();
+        }
+        else {
+            // Документы до опорного не конкурентны: подтягиваем к нему отстающие списки
+            for (size_t j = 0; j < pivot; ++j) {
+                if (cursors[order[j]].doc() < pivotDoc) cursors[order[j]].nextGEQ(pivotDoc);
+            }
+        }
+    }
+}
+
+// Хотя бы одно слово запроса: полный перебор объединения списков
+void TopKEvaluator::runDisjunctiveExhaustive(const std::vector<bool>& excluded) {
+    while (true) {
+        uint32_t doc = std::numeric_limits<uint32_t>::max();
+        bool any = false;
+        for (auto& cursor : cursors) {
+            if (cursor.valid()) {
+                doc = std::min(doc, cursor.doc());
+                any = true;
+            }
+        }
+        if (!any) return;
+
+        float score = 0.0f;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            if (cursors[i].valid() && cursors[i].doc() == doc) {
+                score += termScore(i, cursors[i].freq(), doc);
+                cursors[i].next();
+            }
+        }
+        offer(score, doc, excluded);
+    }
+}
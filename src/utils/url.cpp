@@ -0,0 +1,260 @@
+#include "utils.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+// Разбор, разрешение и нормализация URL по RFC 3986 (разделы 3, 5.2 и 6.2) без регулярных выражений
+
+namespace {
+
+    // Части ссылки (URI или относительной ссылки) в виде срезов исходной строки
+    struct UrlParts {
+        std::string_view scheme;
+        std::string_view authority;
+        std::string_view path;
+        std::string_view query;
+        bool hasScheme = false;
+        bool hasAuthority = false;
+        bool hasQuery = false;
+    };
+
+    bool isAlpha(char ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+    }
+
+    bool isDigit(char ch) {
+        return ch >= '0' && ch <= '9';
+    }
+
+    int hexValue(char ch) {
+        if (isDigit(ch)) return ch - '0';
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+    char lower(char ch) {
+        return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+    }
+
+    // Незарезервированные символы (RFC 3986, 2.3): их процентное кодирование ничего не меняет
+    bool isUnreserved(unsigned char ch) {
+        return isAlpha(static_cast<char>(ch)) || isDigit(static_cast<char>(ch)) ||
+            ch == '-' || ch == '.' || ch == '_' || ch == '~';
+    }
+
+    // Символы, которые не могут стоять в URL как есть: управляющие, пробел, не-ASCII и небезопасные
+    bool needsEncoding(unsigned char ch) {
+        return ch <= 0x20 || ch >= 0x7F || ch == '"' || ch == '<' || ch == '>' || ch == '\\' ||
+            ch == '^' || ch == '`' || ch == '{' || ch == '|' || ch == '}';
+    }
+
+    // Разбор ссылки (RFC 3986, приложение B): [схема:][//authority]путь[?запрос][#фрагмент]
+    UrlParts split(std::string_view ref) {
+        UrlParts parts;
+
+        // Схема: буква, затем буквы, цифры, '+', '-', '.', до первого ':' раньше любого из "/?#"
+        if (!ref.empty() && isAlpha(ref[0])) {
+            size_t i = 1;
+            while (i < ref.size() && (isAlpha(ref[i]) || isDigit(ref[i]) || ref[i] == '+' || ref[i] == '-' || ref[i] == '.')) ++i;
+            if (i < ref.size() && ref[i] == ':') {
+                parts.scheme = ref.substr(0, i);
+                parts.hasScheme = true;
+                ref.remove_prefix(i + 1);
+            }
+        }
+
+        auto hash = ref.find('#');
+        if (hash != std::string_view::npos) ref = ref.substr(0, hash); // Фрагмент на сервер не передаётся
+
+        if (ref.substr(0, 2) == "//") {
+            ref.remove_prefix(2);
+            auto end = ref.find_first_of("/?");
+            parts.authority = ref.substr(0, end);
+            parts.hasAuthority = true;
+            ref.remove_prefix(parts.authority.size());
+        }
+
+        auto question = ref.find('?');
+        parts.path = ref.substr(0, question);
+        if (question != std::string_view::npos) {
+            parts.query = ref.substr(question + 1);
+            parts.hasQuery = true;
+        }
+        return parts;
+    }
+
+    // Удаление сегментов "." и ".." (RFC 3986, 5.2.4); результат — абсолютный путь
+    std::string removeDotSegments(std::string_view path) {
+        std::vector<std::string_view> segments;
+        bool trailingSlash = false;
+        if (!path.empty() && path[0] == '/') path.remove_prefix(1);
+
+        while (true) {
+            auto slash = path.find('/');
+            std::string_view segment = path.substr(0, slash);
+            bool last = slash == std::string_view::npos;
+            if (segment == ".") {
+                trailingSlash = last;
+            }
+            else if (segment == "..") {
+                if (!segments.empty()) segments.pop_back();
+                trailingSlash = last;
+            }
+            else {
+                segments.push_back(segment);
+                trailingSlash = false;
+            }
+            if (last) break;
+            path.remove_prefix(slash + 1);
+        }
+
+        std::string result;
+        for (auto segment : segments) {
+            result += '/';
+            result += segment;
+        }
+        if (trailingSlash || result.empty()) result += '/';
+        return result;
+    }
+
+    // Нормализация процентного кодирования (RFC 3986, 6.2.2.2): незарезервированные символы декодируются,
+    // шестнадцатеричные цифры переводятся в верхний регистр, недопустимые символы кодируются
+    void appendEncoded(std::string& out, std::string_view part) {
+        static constexpr char hexDigits[] = "0123456789ABCDEF";
+        for (size_t i = 0; i < part.size(); ++i) {
+            auto ch = static_cast<unsigned char>(part[i]);
+            if (ch == '%' && i + 2 < part.size() && hexValue(part[i + 1]) >= 0 && hexValue(part[i + 2]) >= 0) {
+                auto decoded = static_cast<unsigned char>(hexValue(part[i + 1]) * 16 + hexValue(part[i + 2]));
+                if (isUnreserved(decoded)) {
+                    out += static_cast<char>(decoded);
+                }
+                else {
+                    out += '%';
+                    out += hexDigits[decoded >> 4];
+                    out += hexDigits[decoded & 0xF];
+                }
+                i += 2;
+            }
+            else if (ch == '%' || needsEncoding(ch)) {
+                out += '%';
+                out += hexDigits[ch >> 4];
+                out += hexDigits[ch & 0xF];
+            }
+            else {
+                out += static_cast<char>(ch);
+            }
+        }
+    }
+
+    // Нормализация authority: хост в нижнем регистре, порт по умолчанию для схемы убирается
+    void appendAuthority(std::string& out, std::string_view authority, std::string_view defaultPort) {
+        auto at = authority.rfind('@');
+        if (at != std::string_view::npos) {
+            out.append(authority.substr(0, at + 1)); // Данные пользователя чувствительны к регистру
+            authority.remove_prefix(at + 1);
+        }
+
+        // Порт — после последнего ':', если он не внутри [IPv6]
+        std::string_view port;
+        auto colon = authority.rfind(':');
+        auto bracket = authority.rfind(']');
+        if (colon != std::string_view::npos && (bracket == std::string_view::npos || colon > bracket)) {
+            port = authority.substr(colon + 1);
+            authority = authority.substr(0, colon);
+        }
+
+        for (char ch : authority) out += lower(ch);
+        if (!port.empty() && port != defaultPort) {
+            out += ':';
+            out.append(port);
+        }
+    }
+
+    // Параметры запроса сортируются по имени (порядок одноимённых сохраняется), пустые отбрасываются
+    void appendQuery(std::string& out, std::string_view query) {
+        std::string encoded;
+        appendEncoded(encoded, query);
+
+        std::vector<std::string_view> params;
+        std::string_view rest = encoded;
+        while (!rest.empty()) {
+            auto amp = rest.find('&');
+            auto param = rest.substr(0, amp);
+            if (!param.empty()) params.push_back(param);
+            if (amp == std::string_view::npos) break;
+            rest.remove_prefix(amp + 1);
+        }
+        if (params.empty()) return;
+
+        std::stable_sort(params.begin(), params.end(), [](std::string_view a, std::string_view b) {
+            return a.substr(0, a.find('=')) < b.substr(0, b.find('='));
+            });
+        out += '?';
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (i > 0) out += '&';
+            out.append(params[i]);
+        }
+    }
+
+    // Сборка нормализованного URL из частей; пустая строка — не http(s) или нет хоста
+    std::string build(std::string_view scheme, std::string_view authority, std::string_view path,
+        std::string_view query, bool hasQuery) {
+        std::string lowerScheme;
+        for (char ch : scheme) lowerScheme += lower(ch);
+        if ((lowerScheme != "http" && lowerScheme != "https") || authority.empty()) return {};
+
+        std::string url;
+        url.reserve(scheme.size() + authority.size() + path.size() + query.size() + 8);
+        url += lowerScheme;
+        url += "://";
+        appendAuthority(url, authority, lowerScheme == "https" ? "443" : "80");
+        std::string encodedPath;
+        appendEncoded(encodedPath, path); // Сначала кодирование: "%2E%2E" — тоже сегмент ".."
+        url += removeDotSegments(encodedPath);
+        if (hasQuery) appendQuery(url, query);
+        return url;
+    }
+
+} // namespace
+
+namespace Utils {
+
+    // Функция для нормализации абсолютного URL
+    std::string normalizeUrl(const std::string& url) {
+        UrlParts parts = split(url);
+        if (!parts.hasScheme || !parts.hasAuthority) return {};
+        return build(parts.scheme, parts.authority, parts.path, parts.query, parts.hasQuery);
+    }
+
+    // Функция для разрешения ссылки относительно базового URL (RFC 3986, 5.2.2) с нормализацией результата
+    std::string resolveRelativeUrl(const std::string& base, const std::string& relative) {
+        UrlParts ref = split(relative);
+        if (ref.hasScheme) {
+            return ref.hasAuthority ? build(ref.scheme, ref.authority, ref.path, ref.query, ref.hasQuery) : std::string();
+        }
+
+        UrlParts from = split(base);
+        if (!from.hasScheme || !from.hasAuthority) return {};
+        if (ref.hasAuthority) {
+            return build(from.scheme, ref.authority, ref.path, ref.query, ref.hasQuery); // //host/путь
+        }
+        if (ref.path.empty()) {
+            // Пустой путь: путь базового URL, запрос ссылки или базового URL
+            return ref.hasQuery
+                ? build(from.scheme, from.authority, from.path, ref.query, true)
+                : build(from.scheme, from.authority, from.path, from.query, from.hasQuery);
+        }
+        if (ref.path[0] == '/') {
+            return build(from.scheme, from.authority, ref.path, ref.query, ref.hasQuery);
+        }
+
+        // Относительный путь дописывается к каталогу базового пути (RFC 3986, 5.2.3)
+        std::string merged(from.path.substr(0, from.path.rfind('/') + 1));
+        if (merged.empty()) merged = "/";
+        merged.append(ref.path);
+        return build(from.scheme, from.authority, merged, ref.query, ref.hasQuery);
+    }
+
+} // namespace Utils
@@ -0,0 +1,292 @@
+// Проверка FetchEngine на локальном HTTP-сервере с синтетическим графом страниц
+//
+// Сервер на 127.0.0.1 отдаёт страницы /page/N со ссылками на другие страницы (абсолютными и относительными),
+// перенаправление /redirect/N на /page/N, ответ 404 на /missing и 304 на запрос с совпадающим ETag, а на /slow
+// отвечает позже таймаута загрузки.
+// Каждое соединение сервер молча закрывает после нескольких ответов, хотя обещает keep-alive, — как сервер,
+// закрывающий простаивающие соединения: запрос по такому соединению из пула должен повториться через новое.
+//
+// Использование: fetch_engine_test [страниц=200]
+
+#include "config.hpp"
+#include "fetch_engine.hpp"
+#include "logger.hpp"
+#include "utils.hpp"
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+namespace {
+
+    int failures = 0;
+
+    constexpr int kTimeoutMs = 1000;                                // Таймаут загрузки в конфигурации теста
+    constexpr auto kSlowResponse = std::chrono::milliseconds(3000); // Задержка ответа на /slow
+
+    void check(bool condition, const std::string& what) {
+        if (condition) return;
+        ++failures;
+        std::cerr << "FAILED: " << what << "\n";
+    }
+
+    // Ссылки страницы: дерево (2n+1, 2n+2) и дальние ссылки, чтобы страницы находились по нескольким путям
+    std::vector<size_t> links(size_t page, size_t pages) {
+        std::vector<size_t> targets;
+        for (size_t next : { 2 * page + 1, 2 * page + 2, (page * 7 + 3) % pages }) {
+            if (next < pages) targets.push_back(next);
+        }
+        return targets;
+    }
+
+    // Синтетический сайт: по потоку на соединение, до requestsPerConnection ответов на соединение
+    class TestSite {
+    public:
+        TestSite(size_t pages, int requestsPerConnection)
+            : pages(pages), requestsPerConnection(requestsPerConnection),
+            acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)),
+            baseUrl("http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port())) {
+            thread = std::thread([this]() { acceptLoop(); });
+        }
+
+        ~TestSite() {
+            // Блокирующий accept не прерывается закрытием акцептора: будим его пустым подключением
+            stopping = true;
+            boost::system::error_code ec;
+            tcp::socket wake(ioc);
+            wake.connect(acceptor.local_endpoint(), ec);
+            thread.join();
+            acceptor.close(ec);
+            for (auto& session : sessions) session.join();
+        }
+
+        const std::string& base() const { return baseUrl; }
+        size_t connections() const { return accepted; }
+
+    private:
+        void acceptLoop() {
+            while (!stopping) {
+                boost::system::error_code ec;
+                tcp::socket socket(ioc);
+                acceptor.accept(socket, ec);
+                if (ec || stopping) return;
+                ++accepted;
+                sessions.emplace_back([this, socket = std::move(socket)]() mutable { serve(std::move(socket)); });
+            }
+        }
+
+        void serve(tcp::socket socket) {
+            beast::flat_buffer buffer;
+            for (int served = 0; served < requestsPerConnection; ++served) {
+                http::request<http::empty_body> req;
+                boost::system::error_code ec;
+                http::read(socket, buffer, req, ec);
+                if (ec) return;
+                if (req.target() == "/slow") std::this_thread::sleep_for(kSlowResponse);
+                http::write(socket, respond(req), ec);
+                if (ec) return;
+            }
+            // Закрываем без Connection: close — клиент узнает об этом только при следующем запросе
+            boost::system::error_code ec;
+            socket.shutdown(tcp::socket::shutdown_both, ec);
+        }
+
+        http::response<http::string_body> respond(const http::request<http::empty_body>& req) {
+            http::response<http::string_body> res{ http::status::ok, req.version() };
+            res.keep_alive(true);
+            std::string target(req.target());
+            size_t page = 0;
+            if (target.rfind("/redirect/", 0) == 0) {
+                res.result(http::status::found);
+                res.set(http::field::location, "/page/" + target.substr(10));
+            }
+            else if (target.rfind("/page/", 0) == 0 && (page = std::stoul(target.substr(6))) < pages) {
+                std::string etag = "\"v1-" + std::to_string(page) + "\"";
+                res.set(http::field::etag, etag);
+                if (req[http::field::if_none_match] == etag) {
+                    res.result(http::status::not_modified);
+                }
+                else {
+                    res.set(http::field::content_type, "text/html");
+                    std::string body = "<html><body><p>page " + std::to_string(page) + "</p>";
+                    for (size_t next : links(page, pages)) {
+                        // Чётные страницы ссылаются абсолютными URL, нечётные — относительными
+                        std::string href = page % 2 == 0 ? base() + "/page/" + std::to_string(next)
+                            : "../page/" + std::to_string(next);
+                        body += "<a href=\"" + href + "\">link</a>";
+                    }
+                    res.body() = body + "</body></html>";
+                }
+            }
+            else {
+                res.result(http::status::not_found);
+                res.body() = "not found";
+            }
+            res.prepare_payload();
+            return res;
+        }
+
+        size_t pages;
+        int requestsPerConnection;
+        net::io_context ioc;
+        tcp::acceptor acceptor;
+        std::string baseUrl;
+        std::thread thread;
+        std::vector<std::thread> sessions;
+        std::atomic<bool> stopping{ false };
+        std::atomic<size_t> accepted{ 0 };
+    };
+
+    // Ссылки из тела страницы
+    std::vector<std::string> extractLinks(const std::string& base, const std::string& body) {
+        std::vector<std::string> found;
+        const std::string marker = "href=\"";
+        for (size_t pos = body.find(marker); pos != std::string::npos; pos = body.find(marker, pos)) {
+            pos += marker.size();
+            size_t end = body.find('"', pos);
+            found.push_back(Utils::resolveRelativeUrl(base, body.substr(pos, end - pos)));
+        }
+        return found;
+    }
+
+    // Загрузка одного URL с ожиданием результата
+    FetchEngine::Result fetchOne(FetchEngine& engine, const std::string& url, FetchEngine::Validators validators = {}) {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        FetchEngine::Result copy;
+        engine.fetch(url, [&](FetchEngine::Result& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            copy = result;
+            finished = true;
+            done.notify_all();
+            }, std::move(validators));
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return finished; });
+        return copy;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t pages = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    auto configPath = std::filesystem::temp_directory_path() / "fetch_engine_test.ini";
+    {
+        std::ofstream ini(configPath);
+        ini << "[database]\nhost = localhost\nport = 5432\nname = test\nuser = test\npassword = test\n"
+            << "[crawler]\nstart_url = http://127.0.0.1/\ndepth = 1\ntimeout = " << kTimeoutMs << "\nfilter_stopwords = false\n"
+            << "max_in_flight = 16\nfetch_threads = 2\nindex_threads = 2\nmax_idle_per_host = 8\n"
+            << "[server]\nport = 0\n"
+            << "[logging]\nconsole = false\nfile = false\nlog_dir = logs\n";
+    }
+    Config config(configPath.string());
+    Logger logger(config);
+
+    TestSite site(pages, 3);
+    const std::string base = site.base();
+    FetchEngine engine(config, logger);
+
+    // Обход всего графа: каждая страница загружается один раз, ссылки ведут только на существующие страницы
+    {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::set<std::string> seen{ base + "/page/0" };
+        std::vector<std::string> queue{ base + "/page/0" };
+        size_t pending = 0, loaded = 0, errors = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!queue.empty() || pending > 0) {
+            if (queue.empty()) {
+                idle.wait(lock);
+                continue;
+            }
+            std::string url = std::move(queue.back());
+            queue.pop_back();
+            ++pending;
+            lock.unlock();
+            engine.fetch(url, [&](FetchEngine::Result& result) {
+                auto found = result.error.empty() ? extractLinks(result.url, result.body) : std::vector<std::string>();
+                std::lock_guard<std::mutex> guard(mutex);
+                if (result.error.empty() && result.status == 200) ++loaded;
+                else ++errors;
+                for (auto& link : found) {
+                    if (seen.insert(link).second) queue.push_back(std::move(link));
+                }
+                --pending;
+                idle.notify_all();
+                });
+            lock.lock();
+        }
+        check(errors == 0, "crawl: " + std::to_string(errors) + " page(s) failed");
+        check(loaded == pages, "crawl: loaded " + std::to_string(loaded) + " of " + std::to_string(pages) + " pages");
+        check(seen.size() == pages, "crawl: discovered " + std::to_string(seen.size()) + " URLs");
+    }
+
+    // Соединения переиспользуются, а закрытые сервером — заменяются новыми без ошибок загрузки
+    auto stats = engine.stats();
+    check(stats.reused > 0, "keep-alive: no pooled connection was reused");
+    check(site.connections() < stats.requests, "keep-alive: a connection per request");
+
+    // Перенаправление: итоговый URL и тело целевой страницы
+    auto redirected = fetchOne(engine, base + "/redirect/5");
+    check(redirected.error.empty() && redirected.status == 200, "redirect: " + redirected.error);
+    check(redirected.url == base + "/page/5", "redirect: final URL " + redirected.url);
+    check(redirected.body.find("page 5") != std::string::npos, "redirect: body of the target page");
+
+    // 404 — ошибка с кодом ответа
+    auto missing = fetchOne(engine, base + "/missing");
+    check(missing.status == 404 && !missing.error.empty(), "404: status " + std::to_string(missing.status));
+
+    // Условный запрос: ETag прошлого ответа — 304 без тела и без ошибки
+    auto first = fetchOne(engine, base + "/page/1");
+    check(!first.validators.etag.empty(), "conditional: no ETag in the response");
+    auto again = fetchOne(engine, base + "/page/1", first.validators);
+    check(again.status == 304 && again.error.empty() && again.body.empty(),
+        "conditional: status " + std::to_string(again.status));
+
+    // Сервер не слушает порт: ошибка подключения, а не зависание
+    auto refused = fetchOne(engine, "http://127.0.0.1:1/page/0");
+    check(!refused.error.empty(), "connection refused: no error reported");
+
+    // Сервер не отвечает: загрузка завершается ошибкой по таймауту, не дожидаясь ответа
+    auto started = std::chrono::steady_clock::now();
+    auto slow = fetchOne(engine, base + "/slow");
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    check(!slow.error.empty() && slow.status == 0, "timeout: no error reported");
+    check(elapsed >= std::chrono::milliseconds(kTimeoutMs) && elapsed < kSlowResponse,
+        "timeout: finished after " +
+        std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()) + " ms");
+
+    // После таймаута движок продолжает загружать страницы
+    auto after = fetchOne(engine, base + "/page/2");
+    check(after.error.empty() && after.status == 200, "after timeout: " + after.error);
+
+    engine.stop();
+    std::filesystem::remove(configPath);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "fetch_engine_test: " << pages << " pages, " << stats.requests << " requests, "
+        << site.connections() << " connections\n";
+    return 0;
+}
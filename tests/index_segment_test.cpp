@@ -0,0 +1,88 @@
+// Проверка открытия сегмента индекса: повреждённые списки словопозиций отвергаются при открытии
+//
+// Сегмент из одного слова, встречающегося во всех документах (три блока), портится по одному полю: количество
+// блоков, lastDoc и смещение блока в таблице заголовков, docFreq списка. Каждый такой сегмент должен
+// отвергаться IndexSegment::fromBuffer, а не приводить к чтению за границами при поиске.
+//
+// Использование: index_segment_test
+
+#include "index_segment.hpp"
+#include "posting_codec.hpp"
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (condition) return;
+        ++failures;
+        std::cerr << "FAILED: " << what << "\n";
+    }
+
+    constexpr uint32_t kDocuments = 300;
+    constexpr size_t kPostingsOffsetField = 72; // Смещение поля postingsOffset в заголовке файла сегмента
+
+    std::vector<uint8_t> buildSegment() {
+        SegmentBuilder builder;
+        uint32_t term = builder.termId("слово");
+        for (uint32_t doc = 0; doc < kDocuments; ++doc) {
+            builder.addDocument("https://example.com/" + std::to_string(doc), 1);
+            builder.addPosting(term, doc, 1);
+        }
+        return builder.build(SegmentBuilder::newGeneration());
+    }
+
+    // Записывает число по смещению от начала единственного списка словопозиций
+    void patchList(std::vector<uint8_t>& bytes, size_t at, uint32_t value) {
+        uint64_t postings = 0;
+        std::memcpy(&postings, bytes.data() + kPostingsOffsetField, sizeof(postings));
+        std::memcpy(bytes.data() + postings + at, &value, sizeof(value));
+    }
+
+    // Смещения в списке: [docFreq][blockCount], затем заголовки блоков [lastDoc][offset][maxFreq][minLength]
+    size_t blockField(size_t block, size_t field) {
+        return 2 * sizeof(uint32_t) + block * sizeof(PostingCodec::BlockHeader) + field * sizeof(uint32_t);
+    }
+
+    void expectCorrupt(const std::string& what, const std::function<void(std::vector<uint8_t>&)>& damage) {
+        auto bytes = buildSegment();
+        damage(bytes);
+        bool rejected = false;
+        try {
+            IndexSegment::fromBuffer(std::move(bytes));
+        }
+        catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        check(rejected, "corrupt segment accepted: " + what);
+    }
+
+} // namespace
+
+int main() {
+    auto segment = IndexSegment::fromBuffer(buildSegment());
+    IndexSegment::Term term;
+    check(segment->find("слово", term), "term found");
+    uint32_t count = 0;
+    for (PostingCodec::Cursor cursor(term.postings); cursor.valid(); cursor.next()) ++count;
+    check(count == kDocuments, "all postings decoded");
+    check(segment->url(kDocuments).empty() && segment->documentLength(kDocuments) == 0,
+        "document outside the table has no URL and length");
+
+    expectCorrupt("block count", [](auto& bytes) { patchList(bytes, sizeof(uint32_t), 1000); });
+    expectCorrupt("docFreq", [](auto& bytes) { patchList(bytes, 0, kDocuments - 1); });
+    expectCorrupt("lastDoc beyond documents", [](auto& bytes) { patchList(bytes, blockField(0, 0), kDocuments); });
+    expectCorrupt("lastDoc not increasing", [](auto& bytes) { patchList(bytes, blockField(2, 0), 10); });
+    expectCorrupt("block offset beyond postings", [](auto& bytes) { patchList(bytes, blockField(2, 1), 1u << 30); });
+    expectCorrupt("overlapping blocks", [](auto& bytes) { patchList(bytes, blockField(1, 1), 0); });
+
+    if (failures == 0) std::cout << "index_segment_test: OK\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Случайная проверка QueryParser на строках с некорректными %-последовательностями
+//
+// Строки собираются из алфавита, в котором часто встречаются "%", шестнадцатеричные и нешестнадцатеричные цифры,
+// "&", "=", "+" и байты UTF-8, поэтому усечённые ("%", "%4") и ошибочные ("%G1", "%%") последовательности
+// попадают в начало, середину и конец имени и значения. Результат сравнивается с простым эталонным разбором.
+//
+// Использование: query_parser_fuzz [итераций=300000] [seed=1]
+
+#include "query_parser.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const char* what, const std::string& input) {
+        if (condition) return;
+        if (++failures <= 10) std::cerr << "FAILED: " << what << " on input [" << input << "]\n";
+    }
+
+    int hexValue(char ch) {
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+    // Эталонное декодирование: по символу за раз
+    std::optional<std::string> referenceDecode(std::string_view text) {
+        std::string out;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '+') {
+                out += ' ';
+            }
+            else if (text[i] == '%') {
+                if (i + 2 >= text.size() || hexValue(text[i + 1]) < 0 || hexValue(text[i + 2]) < 0) return std::nullopt;
+                out += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                i += 2;
+            }
+            else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+
+    // Эталонный разбор: непустые части между "&", имя до первого "=", значение после него
+    std::optional<std::vector<std::pair<std::string, std::string>>> referenceParse(std::string_view text) {
+        std::vector<std::pair<std::string, std::string>> params;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t amp = text.find('&', start);
+            if (amp == std::string_view::npos) amp = text.size();
+            std::string_view pair = text.substr(start, amp - start);
+            start = amp + 1;
+            if (pair.empty()) continue;
+            size_t eq = pair.find('=');
+            auto key = referenceDecode(pair.substr(0, eq));
+            auto value = eq == std::string_view::npos ? std::optional<std::string>("") : referenceDecode(pair.substr(eq + 1));
+            if (!key || !value) return std::nullopt;
+            params.emplace_back(std::move(*key), std::move(*value));
+        }
+        return params;
+    }
+
+    std::string randomInput(std::mt19937& rng) {
+        static const std::string_view alphabet[] = {
+            "%", "%", "%", "4", "1", "f", "F", "G", "z", "a", "=", "&", "+", " ", "\t", "\xd0\xbf", "\xff", "%2", "%%",
+        };
+        std::uniform_int_distribution<size_t> length(0, 24);
+        std::uniform_int_distribution<size_t> pick(0, std::size(alphabet) - 1);
+        std::string input;
+        for (size_t n = length(rng); n > 0; --n) input += alphabet[pick(rng)];
+        return input;
+    }
+
+    void checkInput(QueryParser& parser, const std::string& input) {
+        auto expected = referenceParse(input);
+        bool parsed = parser.parse(input);
+        check(parsed == expected.has_value(), "parse result differs from reference", input);
+        if (!parsed) {
+            check(parser.size() == 0, "parameters left after failed parse", input);
+            return;
+        }
+        if (!expected) return;
+        check(parser.size() == expected->size(), "parameter count differs from reference", input);
+        for (const auto& param : *expected) {
+            // get возвращает значение первого параметра с таким именем
+            auto first = std::find_if(expected->begin(), expected->end(),
+                [&param](const auto& other) { return other.first == param.first; });
+            auto found = parser.get(param.first);
+            check(found && *found == first->second, "get returns wrong value", input);
+        }
+
+        std::string decoded;
+        auto reference = referenceDecode(input);
+        check(QueryParser::decode(input, decoded) == reference.has_value(), "decode result differs from reference", input);
+        if (reference) check(decoded == *reference, "decoded text differs from reference", input);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 300000;
+    std::mt19937 rng(argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 1u);
+
+    // Граничные случаи, которые должны проверяться при любом seed
+    QueryParser parser;
+    for (std::string input : { "%", "%4", "q=%", "q=%4", "q=%G1", "q=%%41", "%41=", "=%", "q=a&%", "q=%4&r=1", "q=%41" }) {
+        checkInput(parser, input);
+    }
+
+    // Один парсер на все итерации: буфер переиспользуется, как в обработчике запросов
+    for (size_t i = 0; i < iterations; ++i) {
+        checkInput(parser, randomInput(rng));
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "query_parser_fuzz: " << iterations << " random inputs passed\n";
+    return 0;
+}